@@ -0,0 +1,167 @@
+#pragma once
+#include "event_loop.hpp"
+#include "latency_histogram.hpp"
+#include "pipeline_client.hpp"
+#include "socket_option.hpp"
+#include "ip/endpoint.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace network {
+
+/// @class balancing_client
+/**
+ * Spreads requests over a set of backends, one pipeline_client connection per backend
+ * @param Threadsafe - no threadsafe, must be used from the loop thread
+ * Backend is picked by power of two choices: two random backends are compared by
+ * peak EWMA latency weighted by requests in flight, so slow or overloaded backends get
+ * less traffic without herding on one "best" backend. Being confined to the loop,
+ * picking takes no locks and doesn't allocate.
+ * Backend failing consecutive requests (transport errors, timeouts) or connects is
+ * ejected for a backoff period, then reconnected and re-probed by a single request.
+ * Optional hedging resends request to another backend once it outlived a latency
+ * percentile, the first response wins. Handlers are invoked from the loop, the client
+ * must not be destroyed from them.
+ */
+template<class _Codec>
+class balancing_client
+{
+public:
+    typedef pipeline_client<_Codec> client_t;
+    typedef typename client_t::request_type request_type;
+    typedef typename client_t::response_type response_type;
+    typedef typename client_t::handler_t handler_t;
+
+    static const std::size_t npos = SIZE_MAX;
+    /// Samples hedge delay percentile is computed from.
+    static const std::size_t hedge_samples = 256;
+
+    /// @see Constructors
+    balancing_client(network::event_loop& _loop, const std::vector<network::ip::endpoint>& _eps,
+                     std::size_t _window = client_t::default_window, _Codec _codec = _Codec());
+    balancing_client(const balancing_client& _other) = delete;
+    balancing_client& operator=(const balancing_client& _other) = delete;
+    ~balancing_client() noexcept;
+
+    /// @see Properties
+    std::size_t backends() const noexcept;
+    std::size_t available() const noexcept;
+    const network::ip::endpoint& endpoint(std::size_t _index) const noexcept;
+    std::size_t in_flight(std::size_t _index) const noexcept;
+    std::chrono::nanoseconds latency(std::size_t _index) const noexcept;
+    bool ejected(std::size_t _index) const noexcept;
+    std::uint64_t requests(std::size_t _index) const noexcept;
+    std::uint64_t failures(std::size_t _index) const noexcept;
+    std::uint64_t hedged() const noexcept;
+    std::chrono::nanoseconds hedge_delay() const noexcept;
+    const latency_histogram& latencies() const noexcept;
+
+    /// @see Tuning
+    void ejection(unsigned _failures, std::chrono::milliseconds _base, std::chrono::milliseconds _max,
+                  unsigned _max_percent = 50) noexcept;
+    void hedge(double _percentile, double _budget = 0.1) noexcept;
+    void request_timeout(std::chrono::milliseconds _timeout) noexcept;
+    void connect_timeout(std::chrono::milliseconds _timeout) noexcept;
+    void decay(std::chrono::milliseconds _decay) noexcept;
+
+    /// @see Requests
+    bool request(const request_type& _request, handler_t _handler);
+    void close();
+
+private:
+    typedef network::event_loop::clock_t clock_t;
+
+    enum class state_t
+    {
+        connecting,
+        up,
+        /// Reconnected after ejection, serves one request at a time until it succeeds.
+        probing,
+        ejected
+    };
+
+    struct backend
+    {
+        network::ip::endpoint ep;
+        std::unique_ptr<client_t> client;
+        /// Socket while non-blocking connect is in progress.
+        base_socket connecting;
+        state_t state { state_t::connecting };
+        std::size_t in_flight { };
+        /// Peak EWMA of response latency, nanoseconds.
+        double ewma { };
+        clock_t::time_point sampled;
+        unsigned consecutive { };
+        unsigned ejections { };
+        network::event_loop::timer_t timer { };
+        std::uint64_t requests { };
+        std::uint64_t failures { };
+    };
+
+    struct call
+    {
+        request_type request;
+        handler_t handler;
+        /// Backends of the original attempt and of the hedge.
+        std::size_t backend[2] { npos, npos };
+        bool pending[2] { false, false };
+        network::event_loop::timer_t hedge_timer { };
+        network::event_loop::timer_t timeout_timer { };
+        bool timed_out { false };
+        bool done { false };
+    };
+
+    bool usable(const backend& _b) const noexcept;
+    double cost(const backend& _b, clock_t::time_point _now) const noexcept;
+    std::uint64_t random() noexcept;
+    std::size_t pick(std::size_t _exclude);
+    bool send(std::size_t _index, const std::shared_ptr<call>& _call, unsigned _attempt, const request_type& _request);
+    void complete(std::size_t _index, const client_t* _client, const std::shared_ptr<call>& _call, unsigned _attempt,
+                  clock_t::time_point _start, response_type&& _response, network::error _error);
+    void finish(call& _call, response_type&& _response, network::error _error);
+    void sample(backend& _b, clock_t::time_point _now, std::chrono::nanoseconds _latency) noexcept;
+    void record(std::chrono::nanoseconds _latency) noexcept;
+    void on_hedge(const std::shared_ptr<call>& _call);
+    void on_timeout(const std::shared_ptr<call>& _call);
+
+    void connect(std::size_t _index);
+    void on_connect(std::size_t _index);
+    void established(std::size_t _index, base_socket&& _s);
+    void failure(std::size_t _index);
+    void reconnect(std::size_t _index);
+    void eject(std::size_t _index);
+    void retire(backend& _b, int _error);
+    std::size_t ejected_count() const noexcept;
+
+    network::event_loop& loop_;
+    std::vector<backend> backends_;
+    std::size_t window_;
+    _Codec codec_;
+    std::uint64_t rng_;
+    unsigned eject_failures_ { 5 };
+    std::chrono::milliseconds eject_base_ { 1000 };
+    std::chrono::milliseconds eject_max_ { 30000 };
+    unsigned eject_max_percent_ { 50 };
+    std::chrono::milliseconds request_timeout_ { 0 };
+    std::chrono::milliseconds connect_timeout_ { 1000 };
+    double decay_ns_ { 1e9 };
+    double hedge_percentile_ { 0 };
+    double hedge_budget_ { 0.1 };
+    std::chrono::nanoseconds hedge_delay_ { 0 };
+    latency_histogram latencies_;
+    latency_histogram window_latencies_;
+    std::uint64_t calls_ { };
+    std::uint64_t hedged_ { };
+    /// Closed clients wait here until their callbacks unwound.
+    std::vector<std::unique_ptr<client_t>> retired_;
+    std::shared_ptr<char> alive_;
+    bool closed_ { false };
+};
+
+#include "impl/balancing_client.hpp"
+
+} // namespace network
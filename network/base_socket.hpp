@@ -6,6 +6,7 @@ namespace network {
 
 class executor
 {
+#ifdef _WIN32
 public:
     executor() noexcept
     {
@@ -19,6 +20,7 @@ public:
 
 private:
     WSAData data_ { };
+#endif
 };
 
 #define BASE_SOCKET_METHODS_MACRO(Name)                                 \
@@ -45,7 +47,8 @@ public:
     {
     }
 
-    base_socket(const base_socket& _other) noexcept = default;
+    /// Owns descriptor, copies would close it twice.
+    base_socket(const base_socket& _other) = delete;
 
     ~base_socket() noexcept
     {
@@ -59,10 +62,13 @@ public:
     }
     base_socket& operator=(base_socket&& _other) noexcept
     {
-        s_ = _other.exchange();
+        if( this != &_other ) {
+            close();
+            s_ = _other.exchange();
+        }
         return *this;
     }
-    base_socket& operator=(const base_socket& _other) noexcept = default;
+    base_socket& operator=(const base_socket& _other) = delete;
 
 
     network::detail::socket_t socket() const noexcept
@@ -87,6 +93,9 @@ public:
     BASE_SOCKET_METHODS_MACRO(bind)
     BASE_SOCKET_METHODS_MACRO(listen)
     BASE_SOCKET_METHODS_MACRO(connect)
+    BASE_SOCKET_METHODS_MACRO(non_blocking)
+    BASE_SOCKET_METHODS_MACRO(set_option)
+    BASE_SOCKET_METHODS_MACRO(get_option)
 
     template<class... _Args>
     bool accept(base_socket& _s, _Args&&... _args) const noexcept
@@ -0,0 +1,107 @@
+#pragma once
+#include "base_socket.hpp"
+#include "connection_table.hpp"
+#include "event_loop.hpp"
+#include "mpsc_queue.hpp"
+#include "send_queue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace network {
+
+/// @class broadcaster
+/**
+ * Fan-out of messages to many subscriber sockets on event loop
+ * @param Threadsafe - no threadsafe except submit, must be used from the loop thread
+ * A message is one shared_buffer referenced by every subscriber queue, so its memory
+ * and copying don't grow with subscribers; it is freed once the slowest one sent it.
+ * Messages published during one loop iteration are sent to each subscriber with one
+ * gather write. Subscriber whose queue reached its limit either misses messages until
+ * it drains to half of it or is disconnected, as chosen per subscriber.
+ * Data received from subscribers is discarded, EOF unsubscribes.
+ */
+class broadcaster
+{
+public:
+    /// Slow subscriber policy.
+    enum class overflow
+    {
+        drop,
+        disconnect
+    };
+
+    /// Invoked after subscriber was closed by error (0 if it closed connection) or by policy (ENOBUFS).
+    typedef std::function<void(connection_handle _subscriber, int _error)> close_handler_t;
+
+    static const std::size_t default_max_queued = 1 << 20;
+
+    /// @see Constructors
+    explicit broadcaster(network::event_loop& _loop);
+    broadcaster(const broadcaster& _other) = delete;
+    broadcaster& operator=(const broadcaster& _other) = delete;
+    ~broadcaster() noexcept;
+
+    /// @see Properties
+    std::size_t subscribers() const noexcept;
+    std::size_t queued(connection_handle _subscriber) const noexcept;
+    std::uint64_t dropped(connection_handle _subscriber) const noexcept;
+    std::uint64_t dropped() const noexcept;
+    std::uint64_t disconnected() const noexcept;
+    void on_close(close_handler_t _handler);
+
+    /// @see Subscribers
+    connection_handle subscribe(base_socket&& _s, overflow _policy = overflow::drop,
+                                std::size_t _max_queued = default_max_queued);
+    bool unsubscribe(connection_handle _subscriber);
+
+    /// @see Publishing
+    std::size_t publish(const shared_buffer& _message);
+    bool send(connection_handle _subscriber, const shared_buffer& _message);
+    void submit(shared_buffer _message);
+
+private:
+    struct subscriber
+    {
+        subscriber(std::size_t _max_queued, overflow _policy) noexcept
+            : queue(_max_queued, _max_queued / 2)
+            , policy(_policy)
+        {
+        }
+
+        send_queue queue;
+        overflow policy;
+        unsigned events { event_loop::read };
+        std::uint64_t dropped { };
+        /// Waits in dirty list for flush at the end of loop iteration.
+        bool dirty { false };
+    };
+
+    bool enqueue(connection_handle _handle, subscriber& _s, const shared_buffer& _message);
+    void schedule_flush();
+    void flush_dirty();
+    void flush(connection_handle _handle, subscriber& _s);
+    void on_events(connection_handle _handle, unsigned _events);
+    void drain_submitted();
+    void close(connection_handle _handle, int _error);
+
+    network::event_loop& loop_;
+    connection_table<subscriber> subscribers_;
+    std::vector<connection_handle> dirty_;
+    std::vector<connection_handle> flushing_;
+    std::vector<connection_handle> overflowed_;
+    mpsc_queue<shared_buffer> submitted_;
+    std::atomic<bool> submit_scheduled_ { false };
+    close_handler_t on_close_;
+    std::uint64_t dropped_ { };
+    std::uint64_t disconnected_ { };
+    std::shared_ptr<char> alive_;
+    bool flush_scheduled_ { false };
+};
+
+#include "impl/broadcaster.hpp"
+
+} // namespace network
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace network {
+
+/// @class buffer_pool
+/**
+ * Cache of equally sized buffers lent to connections only while they have data in flight
+ * @param Threadsafe - no threadsafe, one pool per loop
+ * Idle connections give their buffers back, so memory follows active connections rather
+ * than open ones. Buffers keep their size while cached, reuse doesn't zero them again.
+ */
+class buffer_pool
+{
+public:
+    static const std::size_t default_buffer_size = 16 << 10;
+    static const std::size_t default_max_cached = 256;
+
+    /// @see Constructors
+    explicit buffer_pool(std::size_t _buffer_size = default_buffer_size,
+                         std::size_t _max_cached = default_max_cached);
+    buffer_pool(const buffer_pool& _other) = delete;
+    buffer_pool& operator=(const buffer_pool& _other) = delete;
+
+    /// @see Properties
+    std::size_t buffer_size() const noexcept;
+    std::size_t cached() const noexcept;
+    std::size_t lent() const noexcept;
+    std::size_t memory() const noexcept;
+
+    /// @see Lending
+    std::vector<char> acquire();
+    void release(std::vector<char>& _buffer) noexcept;
+    void trim() noexcept;
+
+private:
+    std::vector<std::vector<char>> free_;
+    std::size_t buffer_size_;
+    std::size_t max_cached_;
+    std::size_t lent_ { };
+};
+
+#include "impl/buffer_pool.hpp"
+
+} // namespace network
@@ -0,0 +1,67 @@
+#pragma once
+#include "detail/socket.hpp"
+#include "socket_option.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace network {
+
+/// Time accounting of busy_poller reads.
+struct busy_poll_stats
+{
+    std::uint64_t reads { };
+    /// Reads satisfied while spinning.
+    std::uint64_t spin_hits { };
+    /// Reads which gave up spinning and blocked in poll.
+    std::uint64_t blocks { };
+    std::chrono::nanoseconds spin_time { };
+    std::chrono::nanoseconds block_time { };
+};
+
+/// @class busy_poller
+/**
+ * Spin-then-block reads for latency-critical sockets
+ * @param Threadsafe - no threadsafe, one poller per socket and thread
+ * Read spins on non-blocking recv with exponential pause backoff for up to spin budget,
+ * then blocks in poll. Budget adapts: it grows while data arrives during spins and halves
+ * each time spinning was wasted, staying within [min_spin, max_spin].
+ * Spinning burns the core, it pays off only on dedicated cores; pair it with kernel busy
+ * polling (socket_impl::busy_poll) to skip interrupt and softirq latency as well.
+ */
+class busy_poller
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    /// @see Constructors
+    explicit busy_poller(std::chrono::nanoseconds _max_spin = std::chrono::microseconds(50),
+                         std::chrono::nanoseconds _min_spin = std::chrono::microseconds(2)) noexcept;
+
+    /// @see Properties
+    std::chrono::nanoseconds spin() const noexcept;
+    std::chrono::nanoseconds max_spin() const noexcept;
+    std::chrono::nanoseconds min_spin() const noexcept;
+    void spin(std::chrono::nanoseconds _max_spin, std::chrono::nanoseconds _min_spin) noexcept;
+    const busy_poll_stats& stats() const noexcept;
+    void reset_stats() noexcept;
+
+    /// @see Reading
+    long long read_some(network::detail::socket_t _s, char* _buff, std::size_t _length,
+                        int _flags = 0, std::chrono::milliseconds _timeout = std::chrono::milliseconds(-1));
+
+    /// @see Static
+    static bool enable_kernel(network::detail::socket_t _s, std::chrono::microseconds _usec, bool _prefer = true) noexcept;
+
+private:
+    static const unsigned max_backoff = 64;
+
+    std::chrono::nanoseconds max_spin_;
+    std::chrono::nanoseconds min_spin_;
+    std::chrono::nanoseconds spin_;
+    busy_poll_stats stats_;
+};
+
+#include "impl/busy_poll.hpp"
+
+} // namespace network
@@ -0,0 +1,110 @@
+#pragma once
+#include "base_socket.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace network {
+
+/// Connection of connection_table, generation tells apart connections reusing one slot.
+struct connection_handle
+{
+    std::uint32_t index { };
+    /// Odd while connection lives, 0 never refers to one.
+    std::uint32_t generation { };
+
+    explicit operator bool() const noexcept
+    {
+        return generation != 0;
+    }
+};
+
+inline bool operator==(connection_handle _lhs, connection_handle _rhs) noexcept
+{
+    return _lhs.index == _rhs.index && _lhs.generation == _rhs.generation;
+}
+
+inline bool operator!=(connection_handle _lhs, connection_handle _rhs) noexcept
+{
+    return !(_lhs == _rhs);
+}
+
+/// @class connection_table
+/**
+ * Owner of connected sockets and their state addressed by generation-tagged handles
+ * @param Threadsafe - no threadsafe
+ * State lives in slabs of slab_size slots which never move, so it stays contiguous and
+ * pointers to it are stable until erase. Freed slots are reused most recently freed first
+ * (still in cache); their generation changes, so stale handle lookup is one compare and
+ * erasing through it can't close descriptor reused by another connection.
+ */
+template<class _State>
+class connection_table
+{
+public:
+    static const std::size_t slab_size = 1024;
+
+    /// @see Constructors
+    connection_table() = default;
+    connection_table(const connection_table& _other) = delete;
+    connection_table& operator=(const connection_table& _other) = delete;
+    ~connection_table() noexcept;
+
+    /// @see Properties
+    std::size_t size() const noexcept;
+    std::size_t capacity() const noexcept;
+    bool empty() const noexcept;
+    std::size_t memory() const noexcept;
+    void reserve(std::size_t _capacity);
+
+    /// @see Lookup
+    bool contains(connection_handle _handle) const noexcept;
+    _State* find(connection_handle _handle) noexcept;
+    const _State* find(connection_handle _handle) const noexcept;
+    const base_socket* socket(connection_handle _handle) const noexcept;
+    template<class _Func>
+    void for_each(_Func&& _func);
+    template<class _Func>
+    void for_each(_Func&& _func) const;
+
+    /// @see Modifiers
+    template<class... _Args>
+    connection_handle insert(base_socket&& _s, _Args&&... _args);
+    bool erase(connection_handle _handle) noexcept;
+    base_socket release(connection_handle _handle) noexcept;
+    void clear() noexcept;
+
+private:
+    static const std::uint32_t no_slot = UINT32_MAX;
+
+    struct slot
+    {
+        std::uint32_t generation { };
+        std::uint32_t next_free { no_slot };
+        base_socket s;
+        typename std::aligned_storage<sizeof(_State), alignof(_State)>::type state;
+
+        _State& value() noexcept
+        {
+            return *reinterpret_cast<_State*>(&state);
+        }
+    };
+
+    slot* at(connection_handle _handle) const noexcept;
+    slot& at(std::uint32_t _index) const noexcept;
+    void add_slab();
+    void destroy(std::uint32_t _index) noexcept;
+
+    std::vector<std::unique_ptr<slot[]>> slabs_;
+    std::uint32_t free_ { no_slot };
+    std::uint32_t used_ { };
+    std::size_t size_ { };
+};
+
+#include "impl/connection_table.hpp"
+
+} // namespace network
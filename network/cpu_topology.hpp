@@ -0,0 +1,122 @@
+#pragma once
+#include "detail/common.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace network {
+
+/// Placement of one logical CPU.
+struct cpu_info
+{
+    unsigned cpu;
+    /// Physical core, SMT siblings share it.
+    unsigned core;
+    unsigned package;
+    unsigned node;
+};
+
+/// @class cpu_topology
+/**
+ * Online CPUs with their cores, packages and NUMA nodes read from sysfs
+ * @param Threadsafe - threadsafe after construction
+ * Machines without NUMA (or without node directories in sysfs) report a single node 0.
+ */
+class cpu_topology
+{
+public:
+    /// @see Constructors
+    explicit cpu_topology(const std::string& _sysfs = "/sys/devices/system");
+
+    /// @see Properties
+    const std::vector<cpu_info>& cpus() const noexcept;
+    std::size_t nodes() const noexcept;
+    const cpu_info* find(unsigned _cpu) const noexcept;
+    std::vector<unsigned> node_cpus(unsigned _node) const;
+    std::vector<unsigned> allowed_cpus() const;
+
+private:
+    std::vector<cpu_info> cpus_;
+    std::size_t nodes_ { 1 };
+};
+
+/// @class node_allocator
+/**
+ * Allocator placing memory on NUMA node (mbind MPOL_PREFERRED), e.g. for per-loop buffers
+ * Pages come from mmap, so it suits large long-living buffers rather than small objects.
+ * Without NUMA support memory is allocated normally.
+ */
+template<class _T>
+class node_allocator
+{
+public:
+    typedef _T value_type;
+
+    /// @see Constructors
+    explicit node_allocator(unsigned _node = 0) noexcept
+        : node_(_node)
+    {
+    }
+
+    template<class _U>
+    node_allocator(const node_allocator<_U>& _other) noexcept
+        : node_(_other.node())
+    {
+    }
+
+    /// @see Properties
+    unsigned node() const noexcept
+    {
+        return node_;
+    }
+
+    /// @see Allocation
+    _T* allocate(std::size_t _n);
+    void deallocate(_T* _p, std::size_t _n) noexcept;
+
+    template<class _U>
+    struct rebind
+    {
+        typedef node_allocator<_U> other;
+    };
+
+private:
+    unsigned node_;
+};
+
+template<class _T, class _U>
+bool operator==(const node_allocator<_T>& _a, const node_allocator<_U>& _b) noexcept
+{
+    return _a.node() == _b.node();
+}
+
+template<class _T, class _U>
+bool operator!=(const node_allocator<_T>& _a, const node_allocator<_U>& _b) noexcept
+{
+    return !(_a == _b);
+}
+
+namespace detail {
+
+std::vector<unsigned> parse_cpu_list(const std::string& _list);
+void* node_alloc(std::size_t _size, unsigned _node) noexcept;
+void node_free(void* _p, std::size_t _size) noexcept;
+
+} // namespace detail
+
+bool pin_thread(unsigned _cpu) noexcept;
+int current_cpu() noexcept;
+
+#include "impl/cpu_topology.hpp"
+
+} // namespace network
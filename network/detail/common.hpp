@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #if defined(_WIN32)
 
 #ifdef _WIN32_WINNT
@@ -13,14 +14,36 @@
 #else
 
 #include <arpa/inet.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
 
 #endif
 
 namespace network {
 namespace detail {
 
+#ifdef _WIN32
 typedef SOCKET socket_t;
 const socket_t invalid_socket = INVALID_SOCKET;
+const int nosignal = 0;
+const int dont_wait = 0;
+const int timed_out = WSAETIMEDOUT;
+#else
+typedef int socket_t;
+const socket_t invalid_socket = -1;
+const int nosignal = MSG_NOSIGNAL;
+const int dont_wait = MSG_DONTWAIT;
+const int timed_out = ETIMEDOUT;
+#endif
 
 typedef unsigned long uint32_t;
 typedef unsigned short family_t;
@@ -45,6 +68,51 @@ const unsigned in6_addr_str_len = 256;   // TODO
 typedef sockaddr sockaddr_t;
 typedef sockaddr_in sockaddr_in4_t;
 typedef sockaddr_in6 sockaddr_in6_t;
+typedef pollfd pollfd_t;
+
+/// Byte order conversion usable in constant expressions, unlike htons.
+constexpr std::uint16_t host_to_network16(std::uint16_t _value) noexcept
+{
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    return (std::uint16_t)((_value >> 8) | (_value << 8));
+#else
+    return _value;
+#endif
+}
+
+/// Byte order conversion usable in constant expressions, unlike htonl.
+constexpr std::uint32_t host_to_network32(std::uint32_t _value) noexcept
+{
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    return (_value >> 24) | ((_value >> 8) & 0xff00) | ((_value << 8) & 0xff0000) | (_value << 24);
+#else
+    return _value;
+#endif
+}
+
+/// strlen usable in constant expressions.
+constexpr std::size_t length(const char* _str) noexcept
+{
+    std::size_t size = 0;
+    while( _str[size] )
+        ++size;
+    return size;
+}
+
+/// Native ipv4 address from uint in a host byte order.
+constexpr in4_addr_t make_in4_addr(std::uint32_t _host) noexcept
+{
+    in4_addr_t addr { };
+#ifdef _WIN32
+    addr.S_un.S_un_b.s_b1 = (unsigned char)(_host >> 24);
+    addr.S_un.S_un_b.s_b2 = (unsigned char)(_host >> 16);
+    addr.S_un.S_un_b.s_b3 = (unsigned char)(_host >> 8);
+    addr.S_un.S_un_b.s_b4 = (unsigned char)_host;
+#else
+    addr.s_addr = host_to_network32(_host);
+#endif
+    return addr;
+}
 
 int last_error() noexcept
 {
@@ -55,6 +123,38 @@ int last_error() noexcept
 #endif
 }
 
+/// Hints CPU that caller is spinning.
+inline void cpu_relax() noexcept
+{
+#if defined(_WIN32)
+    YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/// If error means that non-blocking operation should be retried later.
+inline bool would_block(int _err) noexcept
+{
+#ifdef _WIN32
+    return _err == WSAEWOULDBLOCK;
+#else
+    return _err == EAGAIN || _err == EWOULDBLOCK;
+#endif
+}
+
+/// If error means that non-blocking connect is still in progress.
+inline bool in_progress(int _err) noexcept
+{
+#ifdef _WIN32
+    return _err == WSAEWOULDBLOCK || _err == WSAEINPROGRESS;
+#else
+    return _err == EINPROGRESS;
+#endif
+}
+
 
 
 } // namespace detail
@@ -89,13 +189,15 @@ struct error
 enum class AddressFamily : int
 {
     Ipv4 = AF_INET,
-    Ipv6 = AF_INET6
+    Ipv6 = AF_INET6,
+    Local = AF_UNIX
 };
 
 enum class SocketType : int
 {
     Tcp = SOCK_STREAM,
-    Udp = SOCK_DGRAM
+    Udp = SOCK_DGRAM,
+    SeqPacket = SOCK_SEQPACKET
 };
 
 enum class SocketProtocol : int
@@ -1,3 +1,4 @@
+#pragma once
 #include "common.hpp"
 
 namespace network {
@@ -15,10 +16,46 @@ bool set_error(bool _f, network::error& _error) noexcept
     return false;
 }
 
+/// Error endpoint was built with (e.g. too long unix path), 0 for endpoints that can't be invalid.
+template<class _Endpoint>
+auto endpoint_error(const _Endpoint& _ep, int) noexcept -> decltype((int)_ep.error())
+{
+    return _ep.error();
+}
+
+template<class _Endpoint>
+int endpoint_error(const _Endpoint&, long) noexcept
+{
+    return 0;
+}
+
+/// Fails with endpoint error before it reaches the system call.
+template<class _Endpoint>
+bool check_endpoint(const _Endpoint& _ep) noexcept
+{
+    const int error = endpoint_error(_ep, 0);
+    if( error == 0 )
+        return true;
+    errno = error;
+    return false;
+}
+
+/// Stores address length returned by the system in endpoints of variable size (unix domain).
+template<class _Endpoint>
+auto endpoint_resize(_Endpoint& _ep, socklen_t _size, int) noexcept -> decltype(_ep.size((std::size_t)_size), void())
+{
+    _ep.size((std::size_t)_size);
+}
+
+template<class _Endpoint>
+void endpoint_resize(_Endpoint&, socklen_t, long) noexcept
+{
+}
+
 template<class _Endpoint>
 bool bind(socket_t _s, const _Endpoint& _ep) noexcept
 {
-    return ::bind(_s, _ep, _ep.size()) == GOOD;
+    return check_endpoint(_ep) && ::bind(_s, _ep, _ep.size()) == GOOD;
 }
 
 template<class _Endpoint>
@@ -64,10 +101,11 @@ template<class _Endpoint>
 bool accept(socket_t _s, socket_t& _accepted, _Endpoint& _ep) noexcept
 {
     _Endpoint tmp_ep;
-    int size = sizeof(sockaddr_in6);
+    socklen_t size = (socklen_t)tmp_ep.capacity();
     socket_t s = ::accept(_s, tmp_ep, &size);
     if( s != invalid_socket ) {
         _accepted = s;
+        endpoint_resize(tmp_ep, size, 0);
         _ep = std::move(tmp_ep);
         return true;
     }
@@ -77,13 +115,13 @@ bool accept(socket_t _s, socket_t& _accepted, _Endpoint& _ep) noexcept
 template<class _Endpoint>
 bool accept(socket_t _s, socket_t& _accepted, _Endpoint& _ep, network::error& _error) noexcept
 {
-    return set_error(accept(_s, _accepted), _error);
+    return set_error(accept(_s, _accepted, _ep), _error);
 }
 
 template<class _Endpoint>
 bool connect(socket_t _s, const _Endpoint& _ep) noexcept
 {
-    return ::connect(_s, _ep, _ep.size()) == GOOD;
+    return check_endpoint(_ep) && ::connect(_s, _ep, _ep.size()) == GOOD;
 }
 
 template<class _Endpoint>
@@ -92,6 +130,136 @@ bool connect(socket_t _s, const _Endpoint& _ep, network::error& _error) noexcept
     return set_error(connect(_s, _ep), _error);
 }
 
+inline bool non_blocking(socket_t _s, bool _on = true) noexcept
+{
+#ifdef _WIN32
+    u_long mode = _on ? 1 : 0;
+    return ::ioctlsocket(_s, FIONBIO, &mode) == GOOD;
+#else
+    int flags = ::fcntl(_s, F_GETFL, 0);
+    if( flags == -1 )
+        return false;
+    flags = _on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return ::fcntl(_s, F_SETFL, flags) == GOOD;
+#endif
+}
+
+inline bool non_blocking(socket_t _s, bool _on, network::error& _error) noexcept
+{
+    return set_error(non_blocking(_s, _on), _error);
+}
+
+/// Bytes ready to be received (FIONREAD), 0 if unknown.
+inline std::size_t available(socket_t _s) noexcept
+{
+#ifdef _WIN32
+    u_long size = 0;
+    if( ::ioctlsocket(_s, FIONREAD, &size) != GOOD )
+        return 0;
+#else
+    int size = 0;
+    if( ::ioctl(_s, FIONREAD, &size) != GOOD || size < 0 )
+        return 0;
+#endif
+    return (std::size_t)size;
+}
+
+/**
+ * Sends as much of data as socket accepts without blocking
+ * @return sent bytes count, 0 if socket would block, -1 on error
+ */
+inline long long send_some(socket_t _s, const char* _data, std::size_t _length, int _flags = 0) noexcept
+{
+    long long size = ::send(_s, _data, _length, _flags | nosignal);
+    if( size == -1 && would_block(last_error()) )
+        return 0;
+    return size;
+}
+
+#ifndef _WIN32
+/**
+ * Sends as much of scattered data as socket accepts without blocking, in one syscall
+ * @param _iov - buffers, at most IOV_MAX of them
+ * @return sent bytes count, 0 if socket would block, -1 on error
+ */
+inline long long send_gather(socket_t _s, const iovec* _iov, std::size_t _count, int _flags = 0) noexcept
+{
+    msghdr msg { };
+    msg.msg_iov = const_cast<iovec*>(_iov);
+    msg.msg_iovlen = _count;
+    long long size = ::sendmsg(_s, &msg, _flags | nosignal);
+    if( size == -1 && would_block(last_error()) )
+        return 0;
+    return size;
+}
+#endif
+
+template<class _Option>
+bool set_option(socket_t _s, const _Option& _option) noexcept
+{
+    return ::setsockopt(_s, _option.level(), _option.name(), (const char*)_option.data(), _option.size()) == GOOD;
+}
+
+template<class _Option>
+bool set_option(socket_t _s, const _Option& _option, network::error& _error) noexcept
+{
+    return set_error(set_option(_s, _option), _error);
+}
+
+template<class _Option>
+bool get_option(socket_t _s, _Option& _option) noexcept
+{
+    socklen_t size = _option.size();
+    return ::getsockopt(_s, _option.level(), _option.name(), (char*)_option.data(), &size) == GOOD;
+}
+
+template<class _Option>
+bool get_option(socket_t _s, _Option& _option, network::error& _error) noexcept
+{
+    return set_error(get_option(_s, _option), _error);
+}
+
+/// Pending socket error (SO_ERROR), i.e. result of non-blocking connect.
+inline int socket_error(socket_t _s) noexcept
+{
+    int err = 0;
+    socklen_t size = sizeof(err);
+    if( ::getsockopt(_s, SOL_SOCKET, SO_ERROR, (char*)&err, &size) != GOOD )
+        return last_error();
+    return err;
+}
+
+/// Address family socket was created with, false if it can't be queried.
+inline bool socket_family(socket_t _s, AddressFamily& _family) noexcept
+{
+    sockaddr_storage address { };
+    socklen_t size = sizeof(address);
+    if( ::getsockname(_s, reinterpret_cast<sockaddr_t*>(&address), &size) != GOOD )
+        return false;
+    _family = (AddressFamily)address.ss_family;
+    return true;
+}
+
+/// Socket type (SO_TYPE), false if it can't be queried.
+inline bool socket_type(socket_t _s, SocketType& _type) noexcept
+{
+    int type = 0;
+    socklen_t size = sizeof(type);
+    if( ::getsockopt(_s, SOL_SOCKET, SO_TYPE, (char*)&type, &size) != GOOD )
+        return false;
+    _type = (SocketType)type;
+    return true;
+}
+
+inline int poll(pollfd_t* _fds, std::size_t _n, int _timeout_ms) noexcept
+{
+#ifdef _WIN32
+    return ::WSAPoll(_fds, (ULONG)_n, _timeout_ms);
+#else
+    return ::poll(_fds, (nfds_t)_n, _timeout_ms);
+#endif
+}
+
 bool close(socket_t _s) noexcept
 {
 #ifdef __WIN32
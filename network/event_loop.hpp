@@ -0,0 +1,107 @@
+#pragma once
+#include "detail/socket.hpp"
+#include "mpsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace network {
+
+/// @class event_loop
+/**
+ * Single-threaded reactor dispatching socket readiness, timers and posted tasks
+ * @param Threadsafe - no threadsafe, all methods must be called from the loop thread
+ * Uses epoll on linux and poll elsewhere, readiness is level-triggered.
+ * submit is the only threadsafe method: other threads hand tasks over through lock-free
+ * queue and wake the loop with eventfd (pipe off linux) only if it is blocked in wait.
+ */
+class event_loop
+{
+public:
+    typedef std::function<void(unsigned _events)> handler_t;
+    typedef std::function<void()> task_t;
+    typedef std::chrono::steady_clock clock_t;
+    typedef std::pair<clock_t::time_point, std::uint64_t> timer_t;
+
+    /// Readiness events.
+    static const unsigned none = 0;
+    static const unsigned read = 1;
+    static const unsigned write = 2;
+    static const unsigned error = 4;
+
+    /// @see Constructors
+    event_loop() noexcept;
+    event_loop(const event_loop& _other) = delete;
+    event_loop& operator=(const event_loop& _other) = delete;
+    ~event_loop() noexcept;
+
+    /// @see Sockets
+    bool add(network::detail::socket_t _s, unsigned _events, handler_t _handler);
+    bool modify(network::detail::socket_t _s, unsigned _events);
+    bool remove(network::detail::socket_t _s);
+    bool contains(network::detail::socket_t _s) const noexcept;
+    std::size_t size() const noexcept;
+
+    /// @see Timers
+    timer_t add_timer(std::chrono::milliseconds _delay, task_t _task);
+    bool cancel_timer(const timer_t& _timer);
+
+    /// @see Tasks
+    void post(task_t _task);
+    void submit(task_t _task);
+
+    /// @see Running
+    std::size_t run_once(std::chrono::milliseconds _timeout = std::chrono::milliseconds(-1));
+    void run();
+    void stop() noexcept;
+    bool stopped() const noexcept;
+
+private:
+    struct entry
+    {
+        unsigned events;
+        std::shared_ptr<handler_t> handler;
+    };
+
+    int wait(int _timeout_ms);
+    int next_timeout(std::chrono::milliseconds _timeout) const;
+    std::size_t dispatch_timers();
+    std::size_t dispatch_tasks();
+    std::size_t dispatch_submissions();
+    void wake() noexcept;
+    void clear_wake() noexcept;
+
+    std::unordered_map<network::detail::socket_t, entry> handlers_;
+    std::vector<std::pair<network::detail::socket_t, unsigned>> ready_;
+    std::map<timer_t, task_t> timers_;
+    std::vector<task_t> tasks_;
+    std::uint64_t next_timer_id_ { };
+    bool stopped_ { false };
+    mpsc_queue<task_t> submissions_;
+    /// Loop is (about to be) blocked in wait, submitters must wake it.
+    std::atomic<bool> polling_ { false };
+    /// Wakeup was signalled and not consumed yet, further submitters skip the syscall.
+    std::atomic<bool> wake_pending_ { false };
+    int wake_[2] { -1, -1 };
+#if defined(__linux__)
+    int epoll_ { -1 };
+    std::vector<epoll_event> epoll_events_;
+#else
+    std::vector<network::detail::pollfd_t> fds_;
+#endif
+};
+
+#include "impl/event_loop.hpp"
+
+} // namespace network
@@ -0,0 +1,61 @@
+#pragma once
+#include "detail/socket.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include <sys/types.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+namespace network {
+
+/// @class file_transfer
+/**
+ * Resumable transmission of header, file range and trailer over non-blocking socket
+ * @param Threadsafe - no threadsafe
+ * On linux file data goes from page cache to socket with sendfile, never entering user
+ * space; header is sent with MSG_MORE so it shares segments with the file start.
+ * Elsewhere file is read in 64 KB blocks. File descriptor stays owned by caller.
+ */
+class file_transfer
+{
+public:
+    /// @see Constructors
+    file_transfer(int _fd, std::uint64_t _offset, std::uint64_t _length,
+                  std::string _header = std::string(), std::string _trailer = std::string());
+
+    /// @see Properties
+    int fd() const noexcept;
+    std::uint64_t offset() const noexcept;
+    std::uint64_t remaining() const noexcept;
+    std::uint64_t sent() const noexcept;
+    bool done() const noexcept;
+
+    /// @see Sending
+    long long send(network::detail::socket_t _s);
+
+private:
+    long long send_buffer(network::detail::socket_t _s, const std::string& _data, std::size_t& _sent, int _flags);
+
+    std::string header_;
+    std::string trailer_;
+    std::size_t header_sent_ { };
+    std::size_t trailer_sent_ { };
+    int fd_;
+    std::uint64_t offset_;
+    std::uint64_t remaining_;
+    std::uint64_t sent_ { };
+};
+
+namespace detail {
+
+long long send_file(socket_t _s, int _fd, std::uint64_t& _offset, std::size_t _length) noexcept;
+
+} // namespace detail
+
+#include "impl/file_transfer.hpp"
+
+} // namespace network
@@ -0,0 +1,181 @@
+#pragma once
+#include "socket_impl.hpp"
+#include "ip/internet_protocol.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace network {
+
+/// Delay between connection attempts recommended by RFC 8305.
+const std::chrono::milliseconds connection_attempt_delay { 250 };
+
+namespace detail {
+
+/**
+ * Orders endpoints alternating address families (RFC 8305, section 4)
+ * @param _eps - endpoints in preference order, first endpoint family is preferred
+ * @param _families - families mask (option::v4, option::v6), endpoints of other families are dropped
+ * @return pointers to _eps elements
+ */
+inline std::vector<const network::ip::endpoint*> interleave_families(const std::vector<network::ip::endpoint>& _eps,
+                                                                     unsigned _families = network::option::inet)
+{
+    std::vector<const network::ip::endpoint*> preferred;
+    std::vector<const network::ip::endpoint*> other;
+    for( const auto& ep : _eps ) {
+        if( !(_families & (ep.is_v4() ? network::option::v4 : network::option::v6)) )
+            continue;
+        (preferred.empty() || ep.is_v4() == preferred.front()->is_v4() ? preferred : other).push_back(&ep);
+    }
+
+    std::vector<const network::ip::endpoint*> order;
+    order.reserve(_eps.size());
+    for( std::size_t i = 0; i < preferred.size() || i < other.size(); ++i ) {
+        if( i < preferred.size() )
+            order.push_back(preferred[i]);
+        if( i < other.size() )
+            order.push_back(other[i]);
+    }
+    return order;
+}
+
+/// Adds _duration to _time, clamping at time_point::max() instead of overflowing.
+template<class _Clock>
+typename _Clock::time_point saturated_add(typename _Clock::time_point _time, std::chrono::milliseconds _duration) noexcept
+{
+    const auto room = std::chrono::duration_cast<std::chrono::milliseconds>(_Clock::time_point::max() - _time);
+    return _duration >= room ? _Clock::time_point::max() : _time + _duration;
+}
+
+/**
+ * Races non-blocking connects to endpoints starting a new attempt each _delay or
+ * as soon as previous one fails, first established connection wins, others are closed
+ * @param _s - slot for connected socket, it is left untouched on failure
+ * @param _eps - endpoints in preference order (may mix ipv4 and ipv6), only ones of
+ *               _s protocol family are tried unless it is basic_internet_protocol
+ * @param _timeout - overall deadline
+ * @param _delay - connection attempt delay
+ * @param _error - slot for error handling(by default nullptr), last attempt error or timeout
+ * @return if connection was established
+ */
+template<class _InternetProtocol, class _ReceivePolicy>
+bool connect_any(socket_impl<_InternetProtocol, _ReceivePolicy>& _s, const std::vector<network::ip::endpoint>& _eps,
+                 std::chrono::milliseconds _timeout, std::chrono::milliseconds _delay, network::error* _error)
+{
+    typedef std::chrono::steady_clock clock;
+
+    const auto order = interleave_families(_eps, network::option::detail::protocol_families<_InternetProtocol>::value);
+    if( order.empty() ) {
+        errno = _eps.empty() ? EINVAL : EAFNOSUPPORT;
+        if( _error )
+            _error->value = errno;
+        return false;
+    }
+    const auto start = clock::now();
+    const auto deadline = saturated_add<clock>(start, _timeout);
+
+    std::vector<base_socket> pending;
+    std::vector<pollfd_t> fds;
+    std::size_t next = 0;
+    auto next_attempt = start;
+    int last = NO_ERROR;
+
+    while( next < order.size() || !pending.empty() ) {
+        const auto now = clock::now();
+        if( now >= deadline ) {
+            last = timed_out;
+            break;
+        }
+
+        if( next < order.size() && now >= next_attempt ) {
+            const auto& ep = *order[next++];
+            base_socket s(ep.is_v4() ? AF_INET : AF_INET6, (int)SocketType::Tcp);
+            if( s.socket() == invalid_socket || !s.non_blocking(true) ) {
+                last = last_error();
+                continue;
+            }
+            if( s.connect(ep) && s.non_blocking(false) ) {
+                _s = socket_impl<_InternetProtocol, _ReceivePolicy>(std::move(s));
+                return true;
+            }
+            const int err = last_error();
+            if( !in_progress(err) ) {
+                last = err;
+                continue;
+            }
+            pending.push_back(std::move(s));
+            next_attempt = saturated_add<clock>(now, _delay);
+            continue;
+        }
+
+        auto until = deadline;
+        if( next < order.size() && next_attempt < until )
+            until = next_attempt;
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count();
+
+        fds.clear();
+        for( const auto& s : pending )
+            fds.push_back({ s.socket(), POLLOUT, 0 });
+        if( network::detail::poll(fds.data(), fds.size(), wait >= INT_MAX ? INT_MAX : (int)wait + 1) == -1 ) {
+            // Interrupted wait is resumed with the time left.
+            if( last_error() == EINTR )
+                continue;
+            last = last_error();
+            break;
+        }
+
+        for( std::size_t i = fds.size(); i-- > 0; ) {
+            if( !fds[i].revents )
+                continue;
+            const int err = socket_error(pending[i]);
+            if( err == NO_ERROR && pending[i].non_blocking(false) ) {
+                _s = socket_impl<_InternetProtocol, _ReceivePolicy>(std::move(pending[i]));
+                return true;
+            }
+            last = err == NO_ERROR ? last_error() : err;
+            pending.erase(pending.begin() + i);
+            next_attempt = now;
+        }
+    }
+    if( _error )
+        _error->value = last;
+    return false;
+}
+
+} // namespace detail
+
+/**
+ * Connects to the first reachable endpoint using Happy Eyeballs (RFC 8305) without error handling
+ * @param _s - slot for connected socket
+ * @param _eps - endpoints in preference order (may mix ipv4 and ipv6 for basic_internet_protocol sockets)
+ * @param _timeout - overall deadline
+ * @param _delay - connection attempt delay
+ * @return if connection was established
+ */
+template<class _InternetProtocol, class _ReceivePolicy>
+bool connect_any(socket_impl<_InternetProtocol, _ReceivePolicy>& _s, const std::vector<network::ip::endpoint>& _eps,
+                 std::chrono::milliseconds _timeout = std::chrono::milliseconds::max(),
+                 std::chrono::milliseconds _delay = connection_attempt_delay)
+{
+    return network::detail::connect_any(_s, _eps, _timeout, _delay, nullptr);
+}
+
+/**
+ * Connects to the first reachable endpoint using Happy Eyeballs (RFC 8305) with error handling
+ * @param _s - slot for connected socket
+ * @param _eps - endpoints in preference order (may mix ipv4 and ipv6 for basic_internet_protocol sockets)
+ * @param _error - slot for error handling
+ * @param _timeout - overall deadline
+ * @param _delay - connection attempt delay
+ * @return if connection was established
+ */
+template<class _InternetProtocol, class _ReceivePolicy>
+bool connect_any(socket_impl<_InternetProtocol, _ReceivePolicy>& _s, const std::vector<network::ip::endpoint>& _eps, network::error& _error,
+                 std::chrono::milliseconds _timeout = std::chrono::milliseconds::max(),
+                 std::chrono::milliseconds _delay = connection_attempt_delay)
+{
+    return network::detail::connect_any(_s, _eps, _timeout, _delay, &_error);
+}
+
+} // namespace network
@@ -0,0 +1,511 @@
+#pragma once
+
+
+namespace detail {
+
+/// RFC 7230 tchar.
+inline bool is_token(unsigned char _c) noexcept
+{
+    static const bool table[256] = {
+        0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+        0,1,0,1,1,1,1,1, 0,0,1,1,0,1,1,0, 1,1,1,1,1,1,1,1, 1,1,0,0,0,0,0,0,
+        0,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,0,0,0,1,1,
+        1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,1,1,1,1,1, 1,1,1,0,1,0,1,0
+    };
+    return table[_c];
+}
+
+inline char to_lower(char _c) noexcept
+{
+    return (_c >= 'A' && _c <= 'Z') ? (char)(_c + ('a' - 'A')) : _c;
+}
+
+/// First control character (< 0x20 or 0x7f) in [_p, _end), _end if none; 16 bytes per step with SSE2.
+inline const char* find_control(const char* _p, const char* _end) noexcept
+{
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i limit = _mm_set1_epi8(0x1f);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    while( _end - _p >= 16 ) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p));
+        const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit);
+        const int mask = _mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(v, del)));
+        if( mask ) {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanForward(&bit, (unsigned long)mask);
+            return _p + bit;
+#else
+            return _p + __builtin_ctz((unsigned)mask);
+#endif
+        }
+        _p += 16;
+    }
+#endif
+    for( ; _p < _end; ++_p ) {
+        const unsigned char c = (unsigned char)*_p;
+        if( c < 0x20 || c == 0x7f )
+            return _p;
+    }
+    return _end;
+}
+
+/// Line end of header value skipping tabs, _end if incomplete, nullptr on invalid character.
+inline const char* find_eol(const char* _p, const char* _end) noexcept
+{
+    for( ;; ) {
+        _p = find_control(_p, _end);
+        if( _p == _end || *_p == '\r' || *_p == '\n' )
+            return _p;
+        if( *_p != '\t' )
+            return nullptr;
+        ++_p;
+    }
+}
+
+/// parse_request and parse_response results besides header block length.
+const long long incomplete = 0;
+const long long malformed = -1;
+
+/// Consumes "\r\n" or "\n" at _p, returns 1 on success, 0 if incomplete, -1 on error.
+inline int skip_eol(const char*& _p, const char* _end) noexcept
+{
+    if( _p == _end )
+        return 0;
+    if( *_p == '\n' ) {
+        ++_p;
+        return 1;
+    }
+    if( *_p != '\r' )
+        return -1;
+    if( _p + 1 == _end )
+        return 0;
+    if( _p[1] != '\n' )
+        return -1;
+    _p += 2;
+    return 1;
+}
+
+/// Parses "HTTP/1.x", returns 1 on success, 0 if incomplete, -1 on error.
+inline int parse_version(const char*& _p, const char* _end, int& _minor) noexcept
+{
+    static const char prefix[] = "HTTP/1.";
+    for( int i = 0; i < 7; ++i ) {
+        if( _p + i == _end )
+            return 0;
+        if( _p[i] != prefix[i] )
+            return -1;
+    }
+    if( _p + 7 == _end )
+        return 0;
+    if( _p[7] < '0' || _p[7] > '9' )
+        return -1;
+    _minor = _p[7] - '0';
+    _p += 8;
+    return 1;
+}
+
+/// Parses header block up to and including the empty line, returns 1, 0 if incomplete or -1.
+inline int parse_headers(const char*& _p, const char* _end, message_headers& _message) noexcept
+{
+    _message.header_count = 0;
+    for( ;; ) {
+        if( _p == _end )
+            return 0;
+        if( *_p == '\r' || *_p == '\n' )
+            return skip_eol(_p, _end);
+        if( _message.header_count == message_headers::max_headers )
+            return -1;
+
+        const char* name = _p;
+        while( _p != _end && is_token((unsigned char)*_p) )
+            ++_p;
+        if( _p == _end )
+            return 0;
+        if( *_p != ':' || _p == name )
+            return -1;
+        header& h = _message.headers[_message.header_count++];
+        h.name = string_ref(name, (std::size_t)(_p - name));
+        ++_p;
+        while( _p != _end && (*_p == ' ' || *_p == '\t') )
+            ++_p;
+
+        const char* value = _p;
+        const char* eol = find_eol(_p, _end);
+        if( !eol )
+            return -1;
+        if( eol == _end )
+            return 0;
+        const char* value_end = eol;
+        while( value_end != value && (value_end[-1] == ' ' || value_end[-1] == '\t') )
+            --value_end;
+        h.value = string_ref(value, (std::size_t)(value_end - value));
+        _p = eol;
+        const int eol_result = skip_eol(_p, _end);
+        if( eol_result != 1 )
+            return eol_result;
+    }
+}
+
+/// Last element of comma separated list without surrounding whitespace.
+inline string_ref last_token(string_ref _list) noexcept
+{
+    const char* begin = _list.data();
+    const char* end = _list.data() + _list.size();
+    while( end != begin && (end[-1] == ' ' || end[-1] == '\t') )
+        --end;
+    const char* token = end;
+    while( token != begin && token[-1] != ',' )
+        --token;
+    while( token != end && (*token == ' ' || *token == '\t') )
+        ++token;
+    return string_ref(token, (std::size_t)(end - token));
+}
+
+/// Derives body framing and persistence from headers, false if they are contradictory.
+inline bool interpret(message_headers& _message) noexcept
+{
+    _message.content_length = -1;
+    _message.chunked = false;
+    _message.keep_alive = _message.minor_version >= 1;
+    for( std::size_t i = 0; i < _message.header_count; ++i ) {
+        const header& h = _message.headers[i];
+        if( h.name.iequals("content-length") ) {
+            long long length = 0;
+            if( h.value.empty() )
+                return false;
+            for( std::size_t j = 0; j < h.value.size(); ++j ) {
+                const char c = h.value.data()[j];
+                if( c < '0' || c > '9' || length > (LLONG_MAX - 9) / 10 )
+                    return false;
+                length = length * 10 + (c - '0');
+            }
+            if( _message.content_length != -1 && _message.content_length != length )
+                return false;
+            _message.content_length = length;
+        }
+        else if( h.name.iequals("transfer-encoding") ) {
+            // Final coding must be chunked exactly, "xchunked" is another coding.
+            _message.chunked = last_token(h.value).iequals("chunked");
+            if( !_message.chunked )
+                return false;
+        }
+        else if( h.name.iequals("connection") ) {
+            if( h.value.icontains_token("close") )
+                _message.keep_alive = false;
+            else if( h.value.icontains_token("keep-alive") )
+                _message.keep_alive = true;
+        }
+    }
+    // Both framings at once is the request smuggling vector, reject instead of guessing.
+    return !(_message.chunked && _message.content_length != -1);
+}
+
+inline long long finish(int _result, const char* _p, const char* _data, message_headers& _message) noexcept
+{
+    if( _result != 1 )
+        return _result == 0 ? incomplete : malformed;
+    return interpret(_message) ? (long long)(_p - _data) : malformed;
+}
+
+} // namespace detail
+
+
+///                              string_ref
+
+string_ref::string_ref(const char* _str) noexcept
+    : data_(_str)
+    , size_(strlen(_str))
+{
+}
+
+string_ref::string_ref(const std::string& _str) noexcept
+    : data_(_str.data())
+    , size_(_str.size())
+{
+}
+
+std::string string_ref::to_string() const
+{
+    return std::string(data_, size_);
+}
+
+/// ASCII case-insensitive comparison, e.g. for header names.
+bool string_ref::iequals(string_ref _other) const noexcept
+{
+    if( size_ != _other.size_ )
+        return false;
+    for( std::size_t i = 0; i < size_; ++i ) {
+        if( detail::to_lower(data_[i]) != detail::to_lower(_other.data_[i]) )
+            return false;
+    }
+    return true;
+}
+
+/// If comma-separated list (e.g. Connection value) contains _token, case-insensitive.
+bool string_ref::icontains_token(string_ref _token) const noexcept
+{
+    std::size_t i = 0;
+    while( i < size_ ) {
+        while( i < size_ && (data_[i] == ' ' || data_[i] == '\t' || data_[i] == ',') )
+            ++i;
+        std::size_t begin = i;
+        while( i < size_ && data_[i] != ',' )
+            ++i;
+        std::size_t end = i;
+        while( end > begin && (data_[end - 1] == ' ' || data_[end - 1] == '\t') )
+            --end;
+        if( string_ref(data_ + begin, end - begin).iequals(_token) )
+            return true;
+    }
+    return false;
+}
+
+bool operator==(string_ref _a, string_ref _b) noexcept
+{
+    return _a.size_ == _b.size_ && (_a.size_ == 0 || memcmp(_a.data_, _b.data_, _a.size_) == 0);
+}
+
+bool operator!=(string_ref _a, string_ref _b) noexcept
+{
+    return !(_a == _b);
+}
+
+///                              string_ref
+
+
+/// Value of the first header named _name (case-insensitive), empty if there is none.
+string_ref message_headers::find(string_ref _name) const noexcept
+{
+    for( std::size_t i = 0; i < header_count; ++i ) {
+        if( headers[i].name.iequals(_name) )
+            return headers[i].value;
+    }
+    return string_ref();
+}
+
+
+///                             Parsing
+
+/**
+ * Parses request line and headers, views point into _data
+ * @param _data - received bytes, may hold several pipelined requests
+ * @param _length - bytes count
+ * @param _request - parsed request
+ * @return header block length (body starts there), 0 if incomplete, -1 if malformed
+ */
+long long parse_request(const char* _data, std::size_t _length, request& _request) noexcept
+{
+    const char* p = _data;
+    const char* end = _data + _length;
+
+    // Empty lines before request line are allowed (RFC 7230 3.5).
+    while( p != end && (*p == '\r' || *p == '\n') )
+        ++p;
+
+    const char* method = p;
+    while( p != end && detail::is_token((unsigned char)*p) )
+        ++p;
+    if( p == end )
+        return detail::incomplete;
+    if( *p != ' ' || p == method )
+        return detail::malformed;
+    _request.method = string_ref(method, (std::size_t)(p - method));
+    ++p;
+
+    const char* target = p;
+    while( p != end && (unsigned char)*p > 0x20 && *p != 0x7f )
+        ++p;
+    if( p == end )
+        return detail::incomplete;
+    if( *p != ' ' || p == target )
+        return detail::malformed;
+    _request.target = string_ref(target, (std::size_t)(p - target));
+    ++p;
+
+    int result = detail::parse_version(p, end, _request.minor_version);
+    if( result == 1 )
+        result = detail::skip_eol(p, end);
+    if( result == 1 )
+        result = detail::parse_headers(p, end, _request);
+    return detail::finish(result, p, _data, _request);
+}
+
+/**
+ * Parses status line and headers, views point into _data
+ * @return header block length, 0 if incomplete, -1 if malformed
+ * Body framing of responses to HEAD and of 1xx, 204 and 304 responses is up to the caller.
+ */
+long long parse_response(const char* _data, std::size_t _length, response& _response) noexcept
+{
+    const char* p = _data;
+    const char* end = _data + _length;
+
+    int result = detail::parse_version(p, end, _response.minor_version);
+    if( result != 1 )
+        return result == 0 ? detail::incomplete : detail::malformed;
+    if( end - p < 5 )
+        return detail::incomplete;
+    if( p[0] != ' ' || p[1] < '0' || p[1] > '9' || p[2] < '0' || p[2] > '9' || p[3] < '0' || p[3] > '9' )
+        return detail::malformed;
+    _response.status = (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+    p += 4;
+
+    const char* reason = p;
+    if( *p == ' ' )
+        reason = ++p;
+    const char* eol = detail::find_eol(p, end);
+    if( !eol )
+        return detail::malformed;
+    if( eol == end )
+        return detail::incomplete;
+    _response.reason = string_ref(reason, (std::size_t)(eol - reason));
+    p = eol;
+
+    result = detail::skip_eol(p, end);
+    if( result == 1 )
+        result = detail::parse_headers(p, end, _response);
+    return detail::finish(result, p, _data, _response);
+}
+
+///                             Parsing
+
+
+///                              chunked_decoder
+
+/// @param _max_body - decoded body limit, decode fails above it
+chunked_decoder::chunked_decoder(std::size_t _max_body) noexcept
+    : max_body_(_max_body)
+{
+}
+
+/**
+ * Decodes next part of chunked body
+ * @param _data - encoded bytes, may be followed by the next pipelined message
+ * @param _length - bytes count
+ * @param _body - decoded data is appended to it
+ * @return consumed bytes count (stops right after the body when it's done), malformed or too_large
+ */
+long long chunked_decoder::decode(const char* _data, std::size_t _length, std::vector<char>& _body)
+{
+    const char* p = _data;
+    const char* end = _data + _length;
+    while( p != end && state_ != State::Done ) {
+        const char c = *p;
+        switch( state_ ) {
+        case State::Size: {
+            int digit = (c >= '0' && c <= '9') ? c - '0'
+                      : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                      : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if( digit >= 0 ) {
+                if( ++digits_ > 15 )
+                    return malformed;
+                remaining_ = remaining_ * 16 + (unsigned)digit;
+                ++p;
+                break;
+            }
+            // Lenient size line (e.g. "1g") is a request smuggling vector, only BWS, ';' or line end may follow.
+            if( !digits_ || !(c == ';' || c == ' ' || c == '\t' || c == '\r' || c == '\n') )
+                return malformed;
+            if( remaining_ > max_body_ - _body.size() )
+                return too_large;
+            state_ = (c == '\r' || c == '\n') ? State::SizeLf : c == ';' ? State::Extension : State::SizeBws;
+            if( c != '\n' )
+                ++p;
+            break;
+        }
+        case State::SizeBws:
+            if( c == '\n' ) {
+                state_ = State::SizeLf;
+                continue;
+            }
+            if( c == '\r' )
+                state_ = State::SizeLf;
+            else if( c == ';' )
+                state_ = State::Extension;
+            else if( c != ' ' && c != '\t' )
+                return malformed;
+            ++p;
+            break;
+        case State::Extension:
+            if( c == '\n' ) {
+                state_ = State::SizeLf;
+                continue;
+            }
+            if( c == '\r' )
+                state_ = State::SizeLf;
+            ++p;
+            break;
+        case State::SizeLf:
+            if( c != '\n' )
+                return malformed;
+            ++p;
+            state_ = remaining_ ? State::Data : State::Trailer;
+            break;
+        case State::Data: {
+            std::size_t size = (std::size_t)(end - p) < remaining_ ? (std::size_t)(end - p) : (std::size_t)remaining_;
+            _body.insert(_body.end(), p, p + size);
+            p += size;
+            remaining_ -= size;
+            if( !remaining_ )
+                state_ = State::DataCr;
+            break;
+        }
+        case State::DataCr:
+            if( c == '\r' )
+                ++p;
+            else if( c != '\n' )
+                return malformed;
+            state_ = State::DataLf;
+            break;
+        case State::DataLf:
+            if( c != '\n' )
+                return malformed;
+            ++p;
+            digits_ = 0;
+            state_ = State::Size;
+            break;
+        case State::Trailer:
+            if( c == '\r' ) {
+                state_ = State::LastLf;
+                ++p;
+            }
+            else if( c == '\n' ) {
+                state_ = State::Done;
+                ++p;
+            }
+            else
+                state_ = State::TrailerLine;
+            break;
+        case State::TrailerLine:
+            if( c == '\n' )
+                state_ = State::Trailer;
+            ++p;
+            break;
+        case State::LastLf:
+            if( c != '\n' )
+                return malformed;
+            ++p;
+            state_ = State::Done;
+            break;
+        case State::Done:
+            break;
+        }
+    }
+    return (long long)(p - _data);
+}
+
+/// If the last chunk and trailers were decoded.
+bool chunked_decoder::done() const noexcept
+{
+    return state_ == State::Done;
+}
+
+void chunked_decoder::reset() noexcept
+{
+    remaining_ = 0;
+    digits_ = 0;
+    state_ = State::Size;
+}
+
+///                              chunked_decoder
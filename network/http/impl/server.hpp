@@ -0,0 +1,391 @@
+#pragma once
+
+
+namespace detail {
+
+/// Buffers per gather write, below IOV_MAX everywhere.
+const std::size_t max_gather = 512;
+const std::size_t min_receive = 16 << 10;
+const int max_accepts = 64;
+
+} // namespace detail
+
+
+///                              Constructors
+
+server::server(event_loop& _loop, server::handler_t _handler)
+    : loop_(_loop)
+    , handler_(std::move(_handler))
+{
+}
+
+server::~server() noexcept
+{
+    close_all();
+    if( listener_.socket() != network::detail::invalid_socket )
+        loop_.remove(listener_.socket());
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+std::size_t server::connections() const noexcept
+{
+    return connections_.size();
+}
+
+/// Handled requests count, rejected ones included.
+std::uint64_t server::requests() const noexcept
+{
+    return requests_;
+}
+
+std::size_t server::max_header_size() const noexcept
+{
+    return max_header_size_;
+}
+
+/// Longer request heads are rejected with 431.
+void server::max_header_size(std::size_t _size) noexcept
+{
+    max_header_size_ = _size;
+}
+
+std::size_t server::max_body_size() const noexcept
+{
+    return max_body_size_;
+}
+
+/// Larger request bodies are rejected with 413.
+void server::max_body_size(std::size_t _size) noexcept
+{
+    max_body_size_ = _size;
+}
+
+bool server::reclaim_idle() const noexcept
+{
+    return reclaim_idle_;
+}
+
+/// Idle connections give buffers back, set it before connections are adopted.
+void server::reclaim_idle(bool _on) noexcept
+{
+    reclaim_idle_ = _on;
+}
+
+/// Bytes held for connections: table slabs, connection buffers and pool cache.
+std::size_t server::memory() const noexcept
+{
+    std::size_t bytes = connections_.memory() + buffers_.memory();
+    connections_.for_each([&bytes](connection_handle, const connection& _c) { bytes += memory(_c); });
+    return bytes;
+}
+
+/// Pool lending receive buffers in reclaim_idle mode.
+const buffer_pool& server::buffers() const noexcept
+{
+    return buffers_;
+}
+
+///                             Properties
+
+
+///                             Connections
+
+/**
+ * Accepts connections of listening socket on the loop
+ * @param _listener - bound and listening socket, server owns it
+ * @return false if socket can't be made non-blocking or added to the loop
+ */
+bool server::listen(base_socket&& _listener)
+{
+    if( !_listener.non_blocking() )
+        return false;
+    const network::detail::socket_t s = _listener.socket();
+    if( !loop_.add(s, event_loop::read, [this](unsigned) { on_accept(); }) )
+        return false;
+    listener_ = std::move(_listener);
+    return true;
+}
+
+/// Serves already accepted connection, e.g. handed over by loop_group::dispatch.
+bool server::adopt(base_socket&& _s)
+{
+    if( !_s.non_blocking() )
+        return false;
+    _s.set_option(option::no_delay(true));
+
+    const network::detail::socket_t s = _s.socket();
+    const connection_handle handle = connections_.insert(std::move(_s));
+    connection& c = *connections_.find(handle);
+    c.handle = handle;
+    c.s = connections_.socket(handle);
+    c.decoder = chunked_decoder(max_body_size_);
+    const bool added = loop_.add(s, event_loop::read, [this, handle](unsigned _events) {
+        if( connection* c = connections_.find(handle) )
+            on_events(*c, _events);
+    });
+    if( !added )
+        connections_.erase(handle);
+    return added;
+}
+
+/// Drops all connections without flushing their responses.
+void server::close_all() noexcept
+{
+    connections_.for_each([this](connection_handle, connection& _c) { loop_.remove(_c.s->socket()); });
+    connections_.clear();
+}
+
+void server::on_accept()
+{
+    for( int i = 0; i < detail::max_accepts; ++i ) {
+        network::detail::socket_t s;
+        if( !network::detail::accept(listener_.socket(), s) )
+            return;
+        adopt(base_socket(s));
+    }
+}
+
+void server::close(connection& _c)
+{
+    loop_.remove(_c.s->socket());
+    if( reclaim_idle_ )
+        buffers_.release(_c.rx);
+    connections_.erase(_c.handle);
+}
+
+/// Frees buffers of connection without buffered data, receive buffer goes back to pool.
+void server::reclaim(connection& _c) noexcept
+{
+    buffers_.release(_c.rx);
+    std::vector<char>().swap(_c.body);
+    std::vector<iovec>().swap(_c.iov);
+    std::vector<response_writer>().swap(_c.pending);
+}
+
+/// Heap bytes of connection buffers.
+std::size_t server::memory(const connection& _c) noexcept
+{
+    return _c.rx.capacity() + _c.body.capacity() + _c.iov.capacity() * sizeof(iovec)
+         + _c.pending.capacity() * sizeof(response_writer) + _c.queue.size();
+}
+
+///                             Connections
+
+
+///                             Processing
+
+void server::on_events(connection& _c, unsigned _events)
+{
+    if( (_events & event_loop::read) && !_c.closing ) {
+        if( !receive(_c) ) {
+            close(_c);
+            return;
+        }
+        process(_c);
+        // Peer finished sending, complete requests are answered before closing.
+        if( _c.peer_closed )
+            _c.closing = true;
+    }
+    else if( _events & event_loop::error ) {
+        close(_c);
+        return;
+    }
+    if( !flush(_c) )
+        close(_c);
+}
+
+/// Reads once per readiness event, false if connection failed.
+bool server::receive(connection& _c)
+{
+    if( _c.rx.empty() && reclaim_idle_ )
+        _c.rx = buffers_.acquire();
+    if( _c.rx.size() - _c.rx_size < detail::min_receive / 4 )
+        _c.rx.resize(_c.rx.size() < detail::min_receive ? detail::min_receive : _c.rx.size() * 2);
+    const long long size = ::recv(_c.s->socket(), _c.rx.data() + _c.rx_size, _c.rx.size() - _c.rx_size, 0);
+    if( size > 0 ) {
+        _c.rx_size += (std::size_t)size;
+        return true;
+    }
+    if( size == 0 ) {
+        _c.peer_closed = true;
+        return true;
+    }
+    return network::detail::would_block(network::detail::last_error());
+}
+
+/// Handles all complete requests in receive buffer while send queue accepts responses.
+void server::process(connection& _c)
+{
+    while( !_c.closing && _c.queue.writable() && _c.begin < _c.rx_size ) {
+        const char* data = _c.rx.data() + _c.begin;
+        const std::size_t available = _c.rx_size - _c.begin;
+        request& r = current_;
+        const long long head = parse_request(data, available, r);
+        if( head == 0 ) {
+            if( available > max_header_size_ )
+                reject(_c, 431);
+            break;
+        }
+        if( head < 0 ) {
+            reject(_c, 400);
+            break;
+        }
+        if( (std::size_t)head > max_header_size_ ) {
+            reject(_c, 431);
+            break;
+        }
+
+        std::size_t length;
+        if( r.chunked ) {
+            const std::size_t offset = (std::size_t)head + _c.decoded;
+            const long long used = _c.decoder.decode(data + offset, available - offset, _c.body);
+            if( used < 0 ) {
+                reject(_c, used == chunked_decoder::too_large ? 413 : 400);
+                break;
+            }
+            _c.decoded += (std::size_t)used;
+            if( _c.decoded > max_body_size_ + max_header_size_ ) {
+                reject(_c, 413);
+                break;
+            }
+            if( !_c.decoder.done() ) {
+                if( !_c.continue_sent && r.find("expect").iequals("100-continue") ) {
+                    respond(_c, response_writer(r.minor_version)).status(100);
+                    _c.continue_sent = true;
+                }
+                break;
+            }
+            dispatch(_c, r, string_ref(_c.body.data(), _c.body.size()));
+            length = _c.decoded;
+            _c.decoder.reset();
+            _c.body.clear();
+            _c.decoded = 0;
+        }
+        else {
+            const std::size_t content_length = r.content_length > 0 ? (std::size_t)r.content_length : 0;
+            if( content_length > max_body_size_ ) {
+                reject(_c, 413);
+                break;
+            }
+            if( available - (std::size_t)head < content_length ) {
+                if( !_c.continue_sent && r.find("expect").iequals("100-continue") ) {
+                    respond(_c, response_writer(r.minor_version)).status(100);
+                    _c.continue_sent = true;
+                }
+                break;
+            }
+            // Body is a view into receive buffer, no copy.
+            dispatch(_c, r, string_ref(data + head, content_length));
+            length = content_length;
+        }
+        _c.begin += (std::size_t)head + length;
+        _c.continue_sent = false;
+        if( !r.keep_alive )
+            _c.closing = true;
+    }
+}
+
+void server::dispatch(connection& _c, const request& _request, string_ref _body)
+{
+    ++requests_;
+    response_writer& response = respond(_c, response_writer(_request.minor_version, _request.keep_alive));
+    response.omit_body(_request.method == "HEAD");
+    handler_(_request, _body, response);
+    if( !response.keep_alive() )
+        _c.closing = true;
+}
+
+/// Answers malformed or oversized request and closes connection, its data can't be framed anymore.
+void server::reject(connection& _c, int _status)
+{
+    ++requests_;
+    response_writer& response = respond(_c, response_writer(1, false));
+    response.status(_status);
+    response.body_ref(response_writer::reason(_status));
+    _c.closing = true;
+}
+
+/// Queues response to be serialized by the next flush.
+response_writer& server::respond(connection& _c, response_writer&& _response)
+{
+    _c.pending.push_back(std::move(_response));
+    return _c.pending.back();
+}
+
+/**
+ * Sends pending responses with one gather write and the send queue
+ * Unsent part of responses is copied to the queue, so they don't reference
+ * receive buffer or handler data anymore when loop regains control.
+ * @return false if connection failed or is done and should be closed
+ */
+bool server::flush(connection& _c)
+{
+    if( !_c.pending.empty() ) {
+        std::size_t total = 0;
+        _c.iov.clear();
+        for( auto& response : _c.pending )
+            total += response.serialize(_c.iov);
+
+        std::size_t sent = 0;
+        if( _c.queue.empty() ) {
+            const std::size_t count = _c.iov.size() < detail::max_gather ? _c.iov.size() : detail::max_gather;
+            const long long size = network::detail::send_gather(_c.s->socket(), _c.iov.data(), count);
+            if( size == -1 )
+                return false;
+            sent = (std::size_t)size;
+        }
+        if( sent < total ) {
+            std::vector<char> rest;
+            rest.reserve(total - sent);
+            for( const auto& buffer : _c.iov ) {
+                if( sent >= buffer.iov_len ) {
+                    sent -= buffer.iov_len;
+                    continue;
+                }
+                const char* data = static_cast<const char*>(buffer.iov_base);
+                rest.insert(rest.end(), data + sent, data + buffer.iov_len);
+                sent = 0;
+            }
+            // One push keeps the batch whole even if it crosses high watermark.
+            if( !_c.queue.push(std::move(rest)) )
+                return false;
+        }
+        _c.pending.clear();
+        _c.iov.clear();
+    }
+
+    // Compact receive buffer only now, responses could reference it until here.
+    if( _c.begin ) {
+        memmove(_c.rx.data(), _c.rx.data() + _c.begin, _c.rx_size - _c.begin);
+        _c.rx_size -= _c.begin;
+        _c.begin = 0;
+    }
+
+    if( !_c.queue.empty() && !_c.queue.flush(*_c.s) )
+        return false;
+    if( _c.closing && _c.queue.empty() )
+        return false;
+
+    // Read while queue accepts responses, resume processing of buffered requests once it drains.
+    const bool was_blocked = !(_c.events & event_loop::read);
+    unsigned events = _c.queue.empty() ? event_loop::none : event_loop::write;
+    if( !_c.closing && _c.queue.writable() )
+        events |= event_loop::read;
+    if( events != _c.events ) {
+        _c.events = events;
+        loop_.modify(_c.s->socket(), events);
+    }
+    if( was_blocked && (events & event_loop::read) && _c.begin < _c.rx_size ) {
+        process(_c);
+        return flush(_c);
+    }
+    if( reclaim_idle_ && !_c.rx_size && !_c.decoded && _c.queue.empty() )
+        reclaim(_c);
+    return true;
+}
+
+///                             Processing
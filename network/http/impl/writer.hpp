@@ -0,0 +1,247 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * @param _minor_version - request version, HTTP/1.0 peers get Content-Length framing only
+ * @param _keep_alive - request persistence, see request::keep_alive
+ */
+response_writer::response_writer(int _minor_version, bool _keep_alive)
+    : minor_version_(_minor_version)
+    , keep_alive_(_keep_alive)
+{
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+int response_writer::status() const noexcept
+{
+    return status_;
+}
+
+/// Sets status code, reason defaults to the standard one; custom reason must outlive serialization.
+void response_writer::status(int _status, string_ref _reason)
+{
+    status_ = _status;
+    reason_ = _reason;
+}
+
+bool response_writer::keep_alive() const noexcept
+{
+    return keep_alive_;
+}
+
+/// Connection may be closed by response, it can't be kept alive if request didn't allow it.
+void response_writer::keep_alive(bool _on) noexcept
+{
+    keep_alive_ = keep_alive_ && _on;
+}
+
+bool response_writer::chunked() const noexcept
+{
+    return chunked_ && minor_version_ >= 1;
+}
+
+/// Sends body pieces as chunks instead of Content-Length, ignored for HTTP/1.0.
+void response_writer::chunked(bool _on) noexcept
+{
+    chunked_ = _on;
+}
+
+/// Serializes headers only, e.g. response to HEAD, Content-Length still describes the body.
+void response_writer::omit_body(bool _on) noexcept
+{
+    omit_body_ = _on;
+}
+
+std::size_t response_writer::body_size() const noexcept
+{
+    return body_size_;
+}
+
+///                             Properties
+
+
+///                             Modifiers
+
+/// Adds header, name and value are copied.
+void response_writer::header(string_ref _name, string_ref _value)
+{
+    fields_.append(_name.data(), _name.size());
+    fields_.append(": ", 2);
+    fields_.append(_value.data(), _value.size());
+    fields_.append("\r\n", 2);
+}
+
+/// Appends copy of data to body.
+void response_writer::body(string_ref _data)
+{
+    append_stored(_data.data(), _data.size());
+}
+
+void response_writer::body(const char* _data)
+{
+    body(string_ref(_data));
+}
+
+void response_writer::body(std::string&& _data)
+{
+    if( storage_.empty() ) {
+        const std::size_t size = _data.size();
+        storage_ = std::move(_data);
+        append(nullptr, 0, size);
+    }
+    else
+        append_stored(_data.data(), _data.size());
+}
+
+/**
+ * Appends data to body without copying
+ * Data must stay valid until the response is sent or copied to send queue,
+ * http::server does it before returning to event loop.
+ */
+void response_writer::body_ref(string_ref _data)
+{
+    append(_data.data(), 0, _data.size());
+}
+
+void response_writer::append(const char* _data, std::size_t _offset, std::size_t _size)
+{
+    if( !_size )
+        return;
+    pieces_.push_back(piece { _data, _offset, _size });
+    body_size_ += _size;
+}
+
+void response_writer::append_stored(const char* _data, std::size_t _size)
+{
+    const std::size_t offset = storage_.size();
+    storage_.append(_data, _size);
+    append(nullptr, offset, _size);
+}
+
+///                             Modifiers
+
+
+///                             Serialization
+
+/**
+ * Builds head and appends gather list of the whole response
+ * @param _iov - buffers are appended to it, they point into writer and referenced body data
+ * @return serialized bytes count
+ * Writer must not be modified until buffers are sent.
+ */
+std::size_t response_writer::serialize(std::vector<iovec>& _iov)
+{
+    // 1xx, 204 and 304 never have body (RFC 7230 3.3.3).
+    const bool bodiless = status_ < 200 || status_ == 204 || status_ == 304;
+    const bool chunked = !bodiless && this->chunked();
+    const string_ref reason = reason_.empty() ? response_writer::reason(status_) : reason_;
+
+    char status_line[32];
+    const int status_size = snprintf(status_line, sizeof(status_line), "HTTP/1.%d %03d ",
+                                     minor_version_ >= 1 ? 1 : 0, status_);
+    head_.clear();
+    head_.reserve((std::size_t)status_size + reason.size() + fields_.size() + 64);
+    head_.append(status_line, (std::size_t)status_size);
+    head_.append(reason.data(), reason.size());
+    head_.append("\r\n", 2);
+    head_.append(fields_);
+    if( chunked )
+        head_.append("Transfer-Encoding: chunked\r\n");
+    else if( !bodiless ) {
+        head_.append("Content-Length: ");
+        head_.append(std::to_string(body_size_));
+        head_.append("\r\n", 2);
+    }
+    if( status_ >= 200 ) {
+        if( !keep_alive_ )
+            head_.append("Connection: close\r\n");
+        else if( minor_version_ == 0 )
+            head_.append("Connection: keep-alive\r\n");
+    }
+    head_.append("\r\n", 2);
+
+    _iov.push_back(iovec { const_cast<char*>(head_.data()), head_.size() });
+    std::size_t size = head_.size();
+    if( bodiless || omit_body_ )
+        return size;
+
+    // Chunk framing goes to storage first, pointers into it are taken once it stops growing.
+    // Each frame closes the previous chunk with CRLF and opens the next one.
+    std::vector<std::pair<std::size_t, std::size_t>> frames;
+    if( chunked ) {
+        frames.reserve(pieces_.size() + 1);
+        for( std::size_t i = 0; i <= pieces_.size(); ++i ) {
+            char frame[32];
+            const int frame_size = i < pieces_.size()
+                ? snprintf(frame, sizeof(frame), "%s%zx\r\n", i ? "\r\n" : "", pieces_[i].size)
+                : snprintf(frame, sizeof(frame), "%s0\r\n\r\n", i ? "\r\n" : "");
+            frames.emplace_back(storage_.size(), (std::size_t)frame_size);
+            storage_.append(frame, (std::size_t)frame_size);
+        }
+    }
+
+    for( std::size_t i = 0; i < pieces_.size(); ++i ) {
+        if( chunked ) {
+            _iov.push_back(iovec { const_cast<char*>(storage_.data() + frames[i].first), frames[i].second });
+            size += frames[i].second;
+        }
+        const piece& p = pieces_[i];
+        const char* data = p.data ? p.data : storage_.data() + p.offset;
+        _iov.push_back(iovec { const_cast<char*>(data), p.size });
+        size += p.size;
+    }
+    if( chunked ) {
+        _iov.push_back(iovec { const_cast<char*>(storage_.data() + frames.back().first), frames.back().second });
+        size += frames.back().second;
+    }
+    return size;
+}
+
+///                             Serialization
+
+
+///                             Static
+
+/// Standard reason phrase of status code.
+string_ref response_writer::reason(int _status) noexcept
+{
+    switch( _status ) {
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 414: return "URI Too Long";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
+}
+
+///                             Static
@@ -0,0 +1,152 @@
+#pragma once
+#include "../detail/common.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace network {
+namespace http {
+
+/// @class string_ref
+/**
+ * Non-owning view of characters, e.g. a header inside receive buffer
+ * Views are valid while the buffer they point to isn't modified.
+ */
+class string_ref
+{
+public:
+    /// @see Constructors
+    constexpr string_ref() noexcept = default;
+    constexpr string_ref(const char* _data, std::size_t _size) noexcept
+        : data_(_data)
+        , size_(_size)
+    {
+    }
+    string_ref(const char* _str) noexcept;
+    string_ref(const std::string& _str) noexcept;
+
+    /// @see Properties
+    constexpr const char* data() const noexcept
+    {
+        return data_;
+    }
+
+    constexpr std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /// @see Conversions
+    std::string to_string() const;
+
+    /// @see Comparison
+    bool iequals(string_ref _other) const noexcept;
+    bool icontains_token(string_ref _token) const noexcept;
+
+    friend bool operator==(string_ref _a, string_ref _b) noexcept;
+    friend bool operator!=(string_ref _a, string_ref _b) noexcept;
+
+private:
+    const char* data_ { nullptr };
+    std::size_t size_ { };
+};
+
+struct header
+{
+    string_ref name;
+    string_ref value;
+};
+
+/// Headers of parsed message, at most max_headers of them are accepted.
+struct message_headers
+{
+    static const std::size_t max_headers = 64;
+
+    int minor_version { 1 };
+    std::array<header, max_headers> headers;
+    std::size_t header_count { };
+
+    /// Content-Length, -1 if absent.
+    long long content_length { -1 };
+    /// The last Transfer-Encoding coding is chunked.
+    bool chunked { false };
+    /// Connection stays open after message (HTTP/1.1 default unless "Connection: close").
+    bool keep_alive { true };
+
+    string_ref find(string_ref _name) const noexcept;
+};
+
+struct request : message_headers
+{
+    string_ref method;
+    string_ref target;
+};
+
+struct response : message_headers
+{
+    int status { };
+    string_ref reason;
+};
+
+long long parse_request(const char* _data, std::size_t _length, request& _request) noexcept;
+long long parse_response(const char* _data, std::size_t _length, response& _response) noexcept;
+
+/// @class chunked_decoder
+/**
+ * Incremental decoder of chunked transfer coding
+ * @param Threadsafe - no threadsafe
+ * Chunk extensions and trailers are skipped.
+ */
+class chunked_decoder
+{
+public:
+    /// Results of decode besides consumed bytes count.
+    static const long long malformed = -1;
+    static const long long too_large = -2;
+
+    /// @see Constructors
+    explicit chunked_decoder(std::size_t _max_body = SIZE_MAX) noexcept;
+
+    /// @see Decoding
+    long long decode(const char* _data, std::size_t _length, std::vector<char>& _body);
+    bool done() const noexcept;
+    void reset() noexcept;
+
+private:
+    enum class State : unsigned char
+    {
+        Size,
+        /// Whitespace between size and extension or line end.
+        SizeBws,
+        Extension,
+        SizeLf,
+        Data,
+        DataCr,
+        DataLf,
+        Trailer,
+        TrailerLine,
+        LastLf,
+        Done
+    };
+
+    std::size_t max_body_;
+    std::uint64_t remaining_ { };
+    unsigned digits_ { };
+    State state_ { State::Size };
+};
+
+#include "impl/parser.hpp"
+
+} // namespace http
+} // namespace network
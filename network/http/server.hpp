@@ -0,0 +1,114 @@
+#pragma once
+#include "parser.hpp"
+#include "writer.hpp"
+#include "../base_socket.hpp"
+#include "../buffer_pool.hpp"
+#include "../connection_table.hpp"
+#include "../event_loop.hpp"
+#include "../send_queue.hpp"
+#include "../socket_option.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace network {
+namespace http {
+
+/// @class server
+/**
+ * HTTP/1.1 front end on event loop with keep-alive and pipelining
+ * @param Threadsafe - no threadsafe, runs on the loop thread
+ * Requests are parsed in place in connection receive buffer and handled in order,
+ * responses of one read are sent by a single gather write, the rest goes to send queue.
+ * With reclaim_idle connections without buffered data hold no buffers, receive buffer
+ * is lent by pool when readiness fires, so mostly idle connections cost only their slot.
+ */
+class server
+{
+public:
+    /**
+     * Request handler, views and body are valid during the call only
+     * Response is sent after the handler returns, it must be filled synchronously.
+     */
+    typedef std::function<void(const request& _request, string_ref _body, response_writer& _response)> handler_t;
+
+    static const std::size_t default_max_header_size = 64 << 10;
+    static const std::size_t default_max_body_size = 8 << 20;
+
+    /// @see Constructors
+    server(event_loop& _loop, handler_t _handler);
+    server(const server& _other) = delete;
+    server& operator=(const server& _other) = delete;
+    ~server() noexcept;
+
+    /// @see Properties
+    std::size_t connections() const noexcept;
+    std::uint64_t requests() const noexcept;
+    std::size_t max_header_size() const noexcept;
+    void max_header_size(std::size_t _size) noexcept;
+    std::size_t max_body_size() const noexcept;
+    void max_body_size(std::size_t _size) noexcept;
+    bool reclaim_idle() const noexcept;
+    void reclaim_idle(bool _on) noexcept;
+    std::size_t memory() const noexcept;
+    const buffer_pool& buffers() const noexcept;
+
+    /// @see Connections
+    bool listen(base_socket&& _listener);
+    bool adopt(base_socket&& _s);
+    void close_all() noexcept;
+
+private:
+    struct connection
+    {
+        connection_handle handle;
+        /// Owned by connections_ table.
+        const base_socket* s { };
+        std::vector<char> rx;
+        std::size_t rx_size { };
+        /// Start of the first unhandled request in rx.
+        std::size_t begin { };
+        /// Encoded bytes of chunked body already decoded to body.
+        std::size_t decoded { };
+        chunked_decoder decoder;
+        std::vector<char> body;
+        std::vector<response_writer> pending;
+        std::vector<iovec> iov;
+        send_queue queue;
+        unsigned events { event_loop::read };
+        bool continue_sent { false };
+        bool peer_closed { false };
+        /// No more requests are read, connection closes once send queue drains.
+        bool closing { false };
+    };
+
+    void on_accept();
+    void on_events(connection& _c, unsigned _events);
+    bool receive(connection& _c);
+    void process(connection& _c);
+    void dispatch(connection& _c, const request& _request, string_ref _body);
+    void reject(connection& _c, int _status);
+    response_writer& respond(connection& _c, response_writer&& _response);
+    bool flush(connection& _c);
+    void close(connection& _c);
+    void reclaim(connection& _c) noexcept;
+    static std::size_t memory(const connection& _c) noexcept;
+
+    event_loop& loop_;
+    handler_t handler_;
+    base_socket listener_;
+    connection_table<connection> connections_;
+    /// Parsed head of request being processed, heads are re-parsed from receive buffer each time.
+    request current_;
+    buffer_pool buffers_;
+    bool reclaim_idle_ { false };
+    std::uint64_t requests_ { };
+    std::size_t max_header_size_ { default_max_header_size };
+    std::size_t max_body_size_ { default_max_body_size };
+};
+
+#include "impl/server.hpp"
+
+} // namespace http
+} // namespace network
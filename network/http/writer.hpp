@@ -0,0 +1,76 @@
+#pragma once
+#include "parser.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace network {
+namespace http {
+
+/// @class response_writer
+/**
+ * Response serialized as gather list: head, then body pieces referenced without copying
+ * @param Threadsafe - no threadsafe
+ * Framing headers (Content-Length or Transfer-Encoding, Connection) are added by serialize.
+ */
+class response_writer
+{
+public:
+    /// @see Constructors
+    explicit response_writer(int _minor_version = 1, bool _keep_alive = true);
+    response_writer(response_writer&& _other) = default;
+    response_writer& operator=(response_writer&& _other) = default;
+
+    /// @see Properties
+    int status() const noexcept;
+    void status(int _status, string_ref _reason = string_ref());
+    bool keep_alive() const noexcept;
+    void keep_alive(bool _on) noexcept;
+    bool chunked() const noexcept;
+    void chunked(bool _on) noexcept;
+    void omit_body(bool _on) noexcept;
+    std::size_t body_size() const noexcept;
+
+    /// @see Modifiers
+    void header(string_ref _name, string_ref _value);
+    void body(string_ref _data);
+    void body(const char* _data);
+    void body(std::string&& _data);
+    void body_ref(string_ref _data);
+
+    /// @see Serialization
+    std::size_t serialize(std::vector<iovec>& _iov);
+
+    /// @see Static
+    static string_ref reason(int _status) noexcept;
+
+private:
+    /// Body piece, either referenced (data != nullptr) or stored at offset of storage_.
+    struct piece
+    {
+        const char* data;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    void append(const char* _data, std::size_t _offset, std::size_t _size);
+    void append_stored(const char* _data, std::size_t _size);
+
+    std::string head_;
+    std::string fields_;
+    std::string storage_;
+    std::vector<piece> pieces_;
+    std::size_t body_size_ { };
+    string_ref reason_;
+    int status_ { 200 };
+    int minor_version_;
+    bool keep_alive_;
+    bool chunked_ { false };
+    bool omit_body_ { false };
+};
+
+#include "impl/writer.hpp"
+
+} // namespace http
+} // namespace network
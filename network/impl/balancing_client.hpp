@@ -0,0 +1,579 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * Starts connecting to all backends
+ * @param _loop - loop driving connections
+ * @param _eps - backends, may mix ipv4 and ipv6
+ * @param _window - max requests in flight per backend
+ * @param _codec - requests/responses framing, copied to every connection
+ */
+template<class _Codec>
+balancing_client<_Codec>::balancing_client(network::event_loop& _loop, const std::vector<network::ip::endpoint>& _eps,
+                                           std::size_t _window, _Codec _codec)
+    : loop_(_loop)
+    , backends_(_eps.size())
+    , window_(_window)
+    , codec_(std::move(_codec))
+    , rng_((std::uint64_t)clock_t::now().time_since_epoch().count() | 1)
+    , alive_(std::make_shared<char>())
+{
+    for( std::size_t i = 0; i < _eps.size(); ++i )
+        backends_[i].ep = _eps[i];
+    for( std::size_t i = 0; i < backends_.size(); ++i )
+        connect(i);
+}
+
+/// Pending handlers are invoked with ECANCELED.
+template<class _Codec>
+balancing_client<_Codec>::~balancing_client() noexcept
+{
+    close();
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _Codec>
+std::size_t balancing_client<_Codec>::backends() const noexcept
+{
+    return backends_.size();
+}
+
+/// Backends a request may be sent to right now.
+template<class _Codec>
+std::size_t balancing_client<_Codec>::available() const noexcept
+{
+    std::size_t count = 0;
+    for( const auto& b : backends_ )
+        count += usable(b) ? 1 : 0;
+    return count;
+}
+
+template<class _Codec>
+const network::ip::endpoint& balancing_client<_Codec>::endpoint(std::size_t _index) const noexcept
+{
+    return backends_[_index].ep;
+}
+
+template<class _Codec>
+std::size_t balancing_client<_Codec>::in_flight(std::size_t _index) const noexcept
+{
+    return backends_[_index].in_flight;
+}
+
+/// Peak EWMA latency of backend, the value it is picked by.
+template<class _Codec>
+std::chrono::nanoseconds balancing_client<_Codec>::latency(std::size_t _index) const noexcept
+{
+    return std::chrono::nanoseconds((long long)backends_[_index].ewma);
+}
+
+template<class _Codec>
+bool balancing_client<_Codec>::ejected(std::size_t _index) const noexcept
+{
+    return backends_[_index].state == state_t::ejected;
+}
+
+/// Requests sent to backend, hedges included.
+template<class _Codec>
+std::uint64_t balancing_client<_Codec>::requests(std::size_t _index) const noexcept
+{
+    return backends_[_index].requests;
+}
+
+/// Failed requests and connects of backend.
+template<class _Codec>
+std::uint64_t balancing_client<_Codec>::failures(std::size_t _index) const noexcept
+{
+    return backends_[_index].failures;
+}
+
+/// Requests which were hedged.
+template<class _Codec>
+std::uint64_t balancing_client<_Codec>::hedged() const noexcept
+{
+    return hedged_;
+}
+
+/// Delay after which requests are hedged, 0 until enough responses were seen.
+template<class _Codec>
+std::chrono::nanoseconds balancing_client<_Codec>::hedge_delay() const noexcept
+{
+    return hedge_delay_;
+}
+
+/// Latency of successful responses of all backends.
+template<class _Codec>
+const latency_histogram& balancing_client<_Codec>::latencies() const noexcept
+{
+    return latencies_;
+}
+
+///                             Properties
+
+
+///                             Tuning
+
+/**
+ * Sets ejection of failing backends
+ * @param _failures - consecutive failures ejecting backend
+ * @param _base - first ejection time, it doubles with each ejection until backend recovers
+ * @param _max - ejection time limit
+ * @param _max_percent - backends with open connection which may be ejected at once
+ */
+template<class _Codec>
+void balancing_client<_Codec>::ejection(unsigned _failures, std::chrono::milliseconds _base, std::chrono::milliseconds _max,
+                                        unsigned _max_percent) noexcept
+{
+    eject_failures_ = _failures ? _failures : 1;
+    eject_base_ = _base.count() > 0 ? _base : std::chrono::milliseconds(1);
+    eject_max_ = _max > eject_base_ ? _max : eject_base_;
+    eject_max_percent_ = _max_percent;
+}
+
+/**
+ * Enables hedging, 0 percentile disables it
+ * @param _percentile - requests without response after this latency percentile are resent
+ *                      to another backend, delay is refreshed every hedge_samples responses
+ *                      and rounded up to milliseconds of loop timers
+ * @param _budget - max ratio of hedged requests, bounds extra load on slow backends
+ */
+template<class _Codec>
+void balancing_client<_Codec>::hedge(double _percentile, double _budget) noexcept
+{
+    hedge_percentile_ = _percentile;
+    hedge_budget_ = _budget;
+    hedge_delay_ = std::chrono::nanoseconds(0);
+    window_latencies_.reset();
+}
+
+/// Requests without response for _timeout fail with timed_out and count as backend failure, 0 disables it.
+template<class _Codec>
+void balancing_client<_Codec>::request_timeout(std::chrono::milliseconds _timeout) noexcept
+{
+    request_timeout_ = _timeout;
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::connect_timeout(std::chrono::milliseconds _timeout) noexcept
+{
+    connect_timeout_ = _timeout;
+}
+
+/// Time constant with which latency of backend decays after its peak.
+template<class _Codec>
+void balancing_client<_Codec>::decay(std::chrono::milliseconds _decay) noexcept
+{
+    decay_ns_ = _decay.count() > 0 ? (double)std::chrono::nanoseconds(_decay).count() : 1.0;
+}
+
+///                             Tuning
+
+
+///                             Requests
+
+/**
+ * Sends request to the cheaper of two random backends
+ * @param _request - request
+ * @param _handler - invoked once with the first response or error
+ * @return false if client is closed or no backend can take request
+ */
+template<class _Codec>
+bool balancing_client<_Codec>::request(const request_type& _request, handler_t _handler)
+{
+    if( closed_ )
+        return false;
+    const std::size_t index = pick(npos);
+    if( index == npos )
+        return false;
+    auto c = std::make_shared<call>();
+    c->handler = std::move(_handler);
+    if( !send(index, c, 0, _request) )
+        return false;
+    ++calls_;
+
+    if( hedge_percentile_ > 0 && hedge_delay_.count() > 0 && backends_.size() > 1 ) {
+        c->request = _request;
+        const std::chrono::milliseconds delay((hedge_delay_.count() + 999999) / 1000000);
+        c->hedge_timer = loop_.add_timer(delay, [this, c] { on_hedge(c); });
+    }
+    if( request_timeout_.count() > 0 )
+        c->timeout_timer = loop_.add_timer(request_timeout_, [this, c] { on_timeout(c); });
+    return true;
+}
+
+/// Closes all connections and fails pending requests with ECANCELED.
+template<class _Codec>
+void balancing_client<_Codec>::close()
+{
+    if( closed_ )
+        return;
+    closed_ = true;
+    for( auto& b : backends_ ) {
+        b.state = state_t::ejected;
+        loop_.cancel_timer(b.timer);
+        if( b.connecting.socket() != network::detail::invalid_socket ) {
+            loop_.remove(b.connecting.socket());
+            b.connecting = base_socket();
+        }
+        retire(b, ECANCELED);
+    }
+}
+
+/// If request may be sent to backend, probing backend takes one request at a time.
+template<class _Codec>
+bool balancing_client<_Codec>::usable(const backend& _b) const noexcept
+{
+    if( !_b.client || !_b.client->is_open() || _b.client->in_flight() >= _b.client->window() )
+        return false;
+    return _b.state == state_t::up || (_b.state == state_t::probing && !_b.in_flight);
+}
+
+/**
+ * Expected wait of one more request: latency weighted by requests queued before it
+ * Latency decays since the last response as well, so backend which was slow once gets retried.
+ */
+template<class _Codec>
+double balancing_client<_Codec>::cost(const backend& _b, clock_t::time_point _now) const noexcept
+{
+    const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _b.sampled).count();
+    double latency = _b.ewma * std::exp(-elapsed / decay_ns_);
+    // Backends without samples yet are compared by their load only.
+    if( latency < 1000.0 )
+        latency = 1000.0;
+    return latency * (double)(_b.in_flight + 1);
+}
+
+/// xorshift64*, cheap enough for every pick.
+template<class _Codec>
+std::uint64_t balancing_client<_Codec>::random() noexcept
+{
+    rng_ ^= rng_ >> 12;
+    rng_ ^= rng_ << 25;
+    rng_ ^= rng_ >> 27;
+    return (rng_ * 2685821657736338717ull) >> 32;
+}
+
+/**
+ * Power of two choices
+ * @param _exclude - backend which must not be picked, e.g. one a hedged request is on
+ * @return backend index, npos if none is usable
+ */
+template<class _Codec>
+std::size_t balancing_client<_Codec>::pick(std::size_t _exclude)
+{
+    const std::size_t n = backends_.size();
+    if( !n )
+        return npos;
+    const std::size_t first = (std::size_t)(random() % n);
+    const std::size_t second = n > 1 ? (first + 1 + (std::size_t)(random() % (n - 1))) % n : first;
+    const auto now = clock_t::now();
+    std::size_t best = npos;
+    double best_cost = 0;
+    for( std::size_t i : { first, second } ) {
+        backend& b = backends_[i];
+        // Connection closed by peer while idle, no request failed on it.
+        if( b.state == state_t::up && !b.client->is_open() )
+            reconnect(i);
+        if( i == _exclude || !usable(b) )
+            continue;
+        const double c = cost(b, now);
+        if( best == npos || c < best_cost ) {
+            best = i;
+            best_cost = c;
+        }
+    }
+    if( best != npos )
+        return best;
+
+    // Both choices are down or full, cheapest of the rest.
+    for( std::size_t i = 0; i < n; ++i ) {
+        backend& b = backends_[i];
+        if( b.state == state_t::up && !b.client->is_open() )
+            reconnect(i);
+        if( i == _exclude || !usable(b) )
+            continue;
+        const double c = cost(b, now);
+        if( best == npos || c < best_cost ) {
+            best = i;
+            best_cost = c;
+        }
+    }
+    return best;
+}
+
+template<class _Codec>
+bool balancing_client<_Codec>::send(std::size_t _index, const std::shared_ptr<call>& _call, unsigned _attempt,
+                                    const request_type& _request)
+{
+    backend& b = backends_[_index];
+    const client_t* client = b.client.get();
+    const auto start = clock_t::now();
+    const bool sent = b.client->request(_request, [this, _index, client, _call, _attempt, start](response_type&& _response, network::error _error) {
+        complete(_index, client, _call, _attempt, start, std::move(_response), _error);
+    });
+    if( !sent )
+        return false;
+    _call->backend[_attempt] = _index;
+    _call->pending[_attempt] = true;
+    ++b.in_flight;
+    ++b.requests;
+    return true;
+}
+
+/**
+ * Accounts response of one attempt and completes call with the first response
+ * Attempts of retired clients are failed by us, they don't count against backend.
+ */
+template<class _Codec>
+void balancing_client<_Codec>::complete(std::size_t _index, const client_t* _client, const std::shared_ptr<call>& _call,
+                                        unsigned _attempt, clock_t::time_point _start,
+                                        response_type&& _response, network::error _error)
+{
+    backend& b = backends_[_index];
+    --b.in_flight;
+    _call->pending[_attempt] = false;
+    if( _client == b.client.get() && !closed_ ) {
+        if( !_error ) {
+            const auto now = clock_t::now();
+            sample(b, now, now - _start);
+            record(now - _start);
+            // Late response of timed out call doesn't clear its failure.
+            if( !_call->timed_out ) {
+                b.consecutive = 0;
+                if( b.state == state_t::probing ) {
+                    b.state = state_t::up;
+                    b.ejections = 0;
+                }
+            }
+        }
+        else if( !_call->timed_out )
+            failure(_index);
+    }
+    if( _call->done )
+        return;
+    // The other attempt may still succeed.
+    if( _error && (_call->pending[0] || _call->pending[1]) )
+        return;
+    finish(*_call, std::move(_response), _error);
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::finish(call& _call, response_type&& _response, network::error _error)
+{
+    _call.done = true;
+    loop_.cancel_timer(_call.hedge_timer);
+    loop_.cancel_timer(_call.timeout_timer);
+    _call.request = request_type();
+    handler_t handler = std::move(_call.handler);
+    handler(std::move(_response), _error);
+}
+
+/// Peak EWMA: latency above estimate replaces it, lower one is blended in by time since previous sample.
+template<class _Codec>
+void balancing_client<_Codec>::sample(backend& _b, clock_t::time_point _now, std::chrono::nanoseconds _latency) noexcept
+{
+    const double value = (double)_latency.count();
+    if( value > _b.ewma )
+        _b.ewma = value;
+    else {
+        const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(_now - _b.sampled).count();
+        const double weight = std::exp(-elapsed / decay_ns_);
+        _b.ewma = _b.ewma * weight + value * (1.0 - weight);
+    }
+    _b.sampled = _now;
+}
+
+/// Records latency, percentile scan of hedge delay runs once per hedge_samples responses.
+template<class _Codec>
+void balancing_client<_Codec>::record(std::chrono::nanoseconds _latency) noexcept
+{
+    latencies_.record(_latency);
+    if( hedge_percentile_ <= 0 )
+        return;
+    window_latencies_.record(_latency);
+    if( window_latencies_.count() >= hedge_samples ) {
+        hedge_delay_ = window_latencies_.percentile(hedge_percentile_);
+        window_latencies_.reset();
+    }
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::on_hedge(const std::shared_ptr<call>& _call)
+{
+    if( _call->done || closed_ || _call->backend[1] != npos )
+        return;
+    if( (double)hedged_ >= hedge_budget_ * (double)calls_ )
+        return;
+    const std::size_t index = pick(_call->backend[0]);
+    if( index != npos && send(index, _call, 1, _call->request) )
+        ++hedged_;
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::on_timeout(const std::shared_ptr<call>& _call)
+{
+    if( _call->done )
+        return;
+    _call->timed_out = true;
+    std::size_t failed[2] = { npos, npos };
+    for( unsigned i = 0; i < 2; ++i ) {
+        if( _call->pending[i] )
+            failed[i] = _call->backend[i];
+    }
+    network::error error;
+    error = network::detail::timed_out;
+    finish(*_call, response_type(), error);
+    for( std::size_t index : failed ) {
+        if( index != npos && !closed_ && backends_[index].client )
+            failure(index);
+    }
+}
+
+///                             Requests
+
+
+///                             Backends
+
+template<class _Codec>
+void balancing_client<_Codec>::connect(std::size_t _index)
+{
+    backend& b = backends_[_index];
+    b.state = state_t::connecting;
+    base_socket s(b.ep.is_v4() ? AF_INET : AF_INET6, (int)SocketType::Tcp);
+    if( s.socket() == network::detail::invalid_socket || !s.non_blocking(true) ) {
+        failure(_index);
+        return;
+    }
+    if( s.connect(b.ep) ) {
+        established(_index, std::move(s));
+        return;
+    }
+    if( !network::detail::in_progress(network::detail::last_error())
+        || !loop_.add(s.socket(), network::event_loop::write, [this, _index](unsigned) { on_connect(_index); }) ) {
+        failure(_index);
+        return;
+    }
+    b.connecting = std::move(s);
+    b.timer = loop_.add_timer(connect_timeout_, [this, _index] {
+        loop_.remove(backends_[_index].connecting.socket());
+        backends_[_index].connecting = base_socket();
+        failure(_index);
+    });
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::on_connect(std::size_t _index)
+{
+    backend& b = backends_[_index];
+    loop_.cancel_timer(b.timer);
+    loop_.remove(b.connecting.socket());
+    base_socket s(std::move(b.connecting));
+    if( network::detail::socket_error(s.socket()) != NO_ERROR ) {
+        failure(_index);
+        return;
+    }
+    established(_index, std::move(s));
+}
+
+/// Backend back from ejection is probed before it gets full traffic.
+template<class _Codec>
+void balancing_client<_Codec>::established(std::size_t _index, base_socket&& _s)
+{
+    backend& b = backends_[_index];
+    // Small requests must not wait for acks of previous ones.
+    _s.set_option(network::option::no_delay(true));
+    b.client.reset(new client_t(loop_, std::move(_s), window_, codec_));
+    if( !b.client->is_open() ) {
+        failure(_index);
+        return;
+    }
+    b.state = b.ejections ? state_t::probing : state_t::up;
+    // Latency seen before ejection is stale, start from the average of all backends.
+    b.ewma = (double)latencies_.mean().count();
+    b.sampled = clock_t::now();
+}
+
+/// Counts failure, ejects backend after too many consecutive ones or if it can't connect.
+template<class _Codec>
+void balancing_client<_Codec>::failure(std::size_t _index)
+{
+    backend& b = backends_[_index];
+    ++b.failures;
+    ++b.consecutive;
+    const bool open = b.client && b.client->is_open();
+    if( b.state == state_t::up ) {
+        const bool limited = (ejected_count() + 1) * 100 > (std::size_t)eject_max_percent_ * backends_.size();
+        if( b.consecutive < eject_failures_ || (open && limited) ) {
+            if( !open )
+                reconnect(_index);
+            return;
+        }
+    }
+    eject(_index);
+}
+
+template<class _Codec>
+void balancing_client<_Codec>::reconnect(std::size_t _index)
+{
+    backend& b = backends_[_index];
+    b.state = state_t::connecting;
+    retire(b, ECONNRESET);
+    connect(_index);
+}
+
+/// Drops connection and schedules re-probe with exponential backoff.
+template<class _Codec>
+void balancing_client<_Codec>::eject(std::size_t _index)
+{
+    backend& b = backends_[_index];
+    b.state = state_t::ejected;
+    loop_.cancel_timer(b.timer);
+    if( b.connecting.socket() != network::detail::invalid_socket ) {
+        loop_.remove(b.connecting.socket());
+        b.connecting = base_socket();
+    }
+    retire(b, ECONNABORTED);
+
+    const unsigned shift = b.ejections < 16 ? b.ejections : 16;
+    ++b.ejections;
+    const auto delay = eject_base_ * (1 << shift);
+    b.timer = loop_.add_timer(delay < eject_max_ ? delay : eject_max_, [this, _index] { connect(_index); });
+}
+
+/**
+ * Closes client failing its requests with _error
+ * Client may be in its own callback, so it is destroyed from the loop later.
+ */
+template<class _Codec>
+void balancing_client<_Codec>::retire(backend& _b, int _error)
+{
+    if( !_b.client )
+        return;
+    std::unique_ptr<client_t> client = std::move(_b.client);
+    if( retired_.empty() ) {
+        std::weak_ptr<char> alive = alive_;
+        loop_.post([this, alive] {
+            if( !alive.expired() )
+                retired_.clear();
+        });
+    }
+    retired_.push_back(std::move(client));
+    retired_.back()->close(_error);
+}
+
+template<class _Codec>
+std::size_t balancing_client<_Codec>::ejected_count() const noexcept
+{
+    std::size_t count = 0;
+    for( const auto& b : backends_ )
+        count += b.state == state_t::ejected ? 1 : 0;
+    return count;
+}
+
+///                             Backends
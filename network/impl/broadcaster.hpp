@@ -0,0 +1,270 @@
+#pragma once
+
+
+///                              Constructors
+
+broadcaster::broadcaster(network::event_loop& _loop)
+    : loop_(_loop)
+    , alive_(std::make_shared<char>())
+{
+}
+
+/// Closes subscribers without invoking close handler, unsent messages are dropped.
+broadcaster::~broadcaster() noexcept
+{
+    subscribers_.for_each([this](connection_handle _handle, subscriber&) {
+        loop_.remove(subscribers_.socket(_handle)->socket());
+    });
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+std::size_t broadcaster::subscribers() const noexcept
+{
+    return subscribers_.size();
+}
+
+/// Bytes waiting in subscriber queue, 0 if handle is stale.
+std::size_t broadcaster::queued(connection_handle _subscriber) const noexcept
+{
+    const subscriber* s = subscribers_.find(_subscriber);
+    return s ? s->queue.size() : 0;
+}
+
+/// Messages subscriber missed by drop policy.
+std::uint64_t broadcaster::dropped(connection_handle _subscriber) const noexcept
+{
+    const subscriber* s = subscribers_.find(_subscriber);
+    return s ? s->dropped : 0;
+}
+
+/// Messages missed by all subscribers.
+std::uint64_t broadcaster::dropped() const noexcept
+{
+    return dropped_;
+}
+
+/// Subscribers disconnected by disconnect policy.
+std::uint64_t broadcaster::disconnected() const noexcept
+{
+    return disconnected_;
+}
+
+void broadcaster::on_close(broadcaster::close_handler_t _handler)
+{
+    on_close_ = std::move(_handler);
+}
+
+///                             Properties
+
+
+///                             Subscribers
+
+/**
+ * Takes connected socket over
+ * @param _s - connected stream socket, it's switched to non-blocking mode
+ * @param _policy - what happens to messages once queue is full
+ * @param _max_queued - queue limit in bytes
+ * @return subscriber handle, empty one if socket can't be watched by loop
+ */
+connection_handle broadcaster::subscribe(base_socket&& _s, broadcaster::overflow _policy, std::size_t _max_queued)
+{
+    if( _s.socket() == network::detail::invalid_socket || !_s.non_blocking(true) )
+        return connection_handle();
+    const connection_handle handle = subscribers_.insert(std::move(_s), _max_queued, _policy);
+    if( !loop_.add(subscribers_.socket(handle)->socket(), event_loop::read,
+                   [this, handle](unsigned _events) { on_events(handle, _events); }) ) {
+        subscribers_.erase(handle);
+        return connection_handle();
+    }
+    return handle;
+}
+
+/// Closes subscriber without invoking close handler, false if handle is stale.
+bool broadcaster::unsubscribe(connection_handle _subscriber)
+{
+    const base_socket* s = subscribers_.socket(_subscriber);
+    if( !s )
+        return false;
+    loop_.remove(s->socket());
+    return subscribers_.erase(_subscriber);
+}
+
+void broadcaster::close(connection_handle _handle, int _error)
+{
+    if( !unsubscribe(_handle) )
+        return;
+    if( on_close_ )
+        on_close_(_handle, _error);
+}
+
+///                             Subscribers
+
+
+///                             Publishing
+
+/**
+ * Queues message to all subscribers, it is sent at the end of loop iteration
+ * @param _message - message, must not change until it's released
+ * @return subscribers message was queued to
+ */
+std::size_t broadcaster::publish(const shared_buffer& _message)
+{
+    std::size_t count = 0;
+    subscribers_.for_each([&](connection_handle _handle, subscriber& _s) {
+        count += enqueue(_handle, _s, _message) ? 1 : 0;
+    });
+    if( overflowed_.empty() )
+        return count;
+    // Disconnecting erases, which for_each doesn't allow; close handler may publish again.
+    std::vector<connection_handle> overflowed;
+    overflowed.swap(overflowed_);
+    for( connection_handle handle : overflowed ) {
+        ++disconnected_;
+        close(handle, ENOBUFS);
+    }
+    return count;
+}
+
+/// Queues message to one subscriber, false if handle is stale or message was dropped by policy.
+bool broadcaster::send(connection_handle _subscriber, const shared_buffer& _message)
+{
+    subscriber* s = subscribers_.find(_subscriber);
+    if( !s )
+        return false;
+    const bool queued = enqueue(_subscriber, *s, _message);
+    if( !overflowed_.empty() ) {
+        overflowed_.clear();
+        ++disconnected_;
+        close(_subscriber, ENOBUFS);
+    }
+    return queued;
+}
+
+/**
+ * Publishes message from any thread
+ * Messages are handed to the loop through lock-free queue, one loop task publishes all
+ * messages submitted meanwhile and subscribers get them with one write.
+ */
+void broadcaster::submit(shared_buffer _message)
+{
+    submitted_.push(std::move(_message));
+    if( submit_scheduled_.exchange(true, std::memory_order_acq_rel) )
+        return;
+    std::weak_ptr<char> alive = alive_;
+    loop_.submit([this, alive] {
+        if( !alive.expired() )
+            drain_submitted();
+    });
+}
+
+void broadcaster::drain_submitted()
+{
+    // Cleared before popping: message pushed after it schedules another task.
+    submit_scheduled_.exchange(false, std::memory_order_acq_rel);
+    shared_buffer message;
+    while( submitted_.pop(message) )
+        publish(message);
+}
+
+/// Applies overflow policy if queue is full, disconnect is left to the caller.
+bool broadcaster::enqueue(connection_handle _handle, subscriber& _s, const shared_buffer& _message)
+{
+    if( _s.queue.push(_message) ) {
+        if( !_s.dirty ) {
+            _s.dirty = true;
+            dirty_.push_back(_handle);
+            schedule_flush();
+        }
+        return true;
+    }
+    if( _s.policy == overflow::disconnect )
+        overflowed_.push_back(_handle);
+    else {
+        ++_s.dropped;
+        ++dropped_;
+    }
+    return false;
+}
+
+void broadcaster::schedule_flush()
+{
+    if( flush_scheduled_ )
+        return;
+    flush_scheduled_ = true;
+    std::weak_ptr<char> alive = alive_;
+    loop_.post([this, alive] {
+        if( alive.expired() )
+            return;
+        flush_scheduled_ = false;
+        flush_dirty();
+    });
+}
+
+void broadcaster::flush_dirty()
+{
+    flushing_.swap(dirty_);
+    for( connection_handle handle : flushing_ ) {
+        subscriber* s = subscribers_.find(handle);
+        if( !s )
+            continue;
+        s->dirty = false;
+        flush(handle, *s);
+    }
+    flushing_.clear();
+}
+
+/// Sends queued messages, waits for write readiness if socket buffer is full.
+void broadcaster::flush(connection_handle _handle, subscriber& _s)
+{
+    if( !_s.queue.flush(*subscribers_.socket(_handle)) ) {
+        close(_handle, network::detail::last_error());
+        return;
+    }
+    const unsigned events = _s.queue.empty() ? event_loop::read : event_loop::read | event_loop::write;
+    if( events != _s.events ) {
+        loop_.modify(subscribers_.socket(_handle)->socket(), events);
+        _s.events = events;
+    }
+}
+
+void broadcaster::on_events(connection_handle _handle, unsigned _events)
+{
+    subscriber* s = subscribers_.find(_handle);
+    if( !s )
+        return;
+    const network::detail::socket_t socket = subscribers_.socket(_handle)->socket();
+    if( _events & event_loop::error ) {
+        const int err = network::detail::socket_error(socket);
+        if( err != NO_ERROR ) {
+            close(_handle, err);
+            return;
+        }
+    }
+    if( _events & event_loop::read ) {
+        char discard[4096];
+        for( ;; ) {
+            const long long size = ::recv(socket, discard, sizeof(discard), 0);
+            if( size > 0 )
+                continue;
+            if( size == 0 ) {
+                close(_handle, NO_ERROR);
+                return;
+            }
+            const int err = network::detail::last_error();
+            if( err == EINTR )
+                continue;
+            if( network::detail::would_block(err) )
+                break;
+            close(_handle, err);
+            return;
+        }
+    }
+    if( _events & event_loop::write )
+        flush(_handle, *s);
+}
+
+///                             Publishing
@@ -0,0 +1,81 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * @param _buffer_size - size of lent buffers
+ * @param _max_cached - returned buffers kept for reuse, the rest is freed
+ */
+buffer_pool::buffer_pool(std::size_t _buffer_size, std::size_t _max_cached)
+    : buffer_size_(_buffer_size)
+    , max_cached_(_max_cached)
+{
+    free_.reserve(_max_cached);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+std::size_t buffer_pool::buffer_size() const noexcept
+{
+    return buffer_size_;
+}
+
+/// Buffers waiting for reuse.
+std::size_t buffer_pool::cached() const noexcept
+{
+    return free_.size();
+}
+
+/// Buffers currently held by connections.
+std::size_t buffer_pool::lent() const noexcept
+{
+    return lent_;
+}
+
+/// Bytes of cached buffers.
+std::size_t buffer_pool::memory() const noexcept
+{
+    return free_.size() * buffer_size_ + free_.capacity() * sizeof(std::vector<char>);
+}
+
+///                             Properties
+
+
+///                             Lending
+
+/// Buffer of buffer_size() bytes, cached one if any.
+std::vector<char> buffer_pool::acquire()
+{
+    ++lent_;
+    if( free_.empty() )
+        return std::vector<char>(buffer_size_);
+    std::vector<char> buffer(std::move(free_.back()));
+    free_.pop_back();
+    return buffer;
+}
+
+/// Takes buffer back leaving it empty, buffers grown past buffer_size() are freed.
+void buffer_pool::release(std::vector<char>& _buffer) noexcept
+{
+    if( _buffer.capacity() == 0 )
+        return;
+    if( lent_ )
+        --lent_;
+    if( _buffer.capacity() == buffer_size_ && free_.size() < max_cached_ ) {
+        _buffer.resize(buffer_size_);
+        free_.push_back(std::move(_buffer));
+    }
+    std::vector<char>().swap(_buffer);
+}
+
+/// Frees cached buffers, e.g. after load spike.
+void buffer_pool::trim() noexcept
+{
+    free_.clear();
+}
+
+///                             Lending
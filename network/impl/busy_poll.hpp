@@ -0,0 +1,160 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * @param _max_spin - spin budget upper bound, 0 disables spinning
+ * @param _min_spin - spin budget lower bound, budget starts from _max_spin
+ */
+busy_poller::busy_poller(std::chrono::nanoseconds _max_spin, std::chrono::nanoseconds _min_spin) noexcept
+{
+    spin(_max_spin, _min_spin);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+/// Current spin budget.
+std::chrono::nanoseconds busy_poller::spin() const noexcept
+{
+    return spin_;
+}
+
+std::chrono::nanoseconds busy_poller::max_spin() const noexcept
+{
+    return max_spin_;
+}
+
+std::chrono::nanoseconds busy_poller::min_spin() const noexcept
+{
+    return min_spin_;
+}
+
+void busy_poller::spin(std::chrono::nanoseconds _max_spin, std::chrono::nanoseconds _min_spin) noexcept
+{
+    max_spin_ = _max_spin;
+    min_spin_ = _min_spin < _max_spin ? _min_spin : _max_spin;
+    spin_ = max_spin_;
+}
+
+const busy_poll_stats& busy_poller::stats() const noexcept
+{
+    return stats_;
+}
+
+void busy_poller::reset_stats() noexcept
+{
+    stats_ = busy_poll_stats();
+}
+
+///                             Properties
+
+
+///                             Reading
+
+/**
+ * Receives data spinning first, then blocking
+ * @param _s - socket, it may be blocking or non-blocking
+ * @param _buff - buffer
+ * @param _length - buffer length
+ * @param _flags - recv flags
+ * @param _timeout - blocking phase timeout, negative waits forever
+ * @return received bytes count, 0 on orderly shutdown, -1 on error or timeout (timed_out)
+ */
+long long busy_poller::read_some(network::detail::socket_t _s, char* _buff, std::size_t _length,
+                                 int _flags, std::chrono::milliseconds _timeout)
+{
+    using network::detail::last_error;
+    using network::detail::would_block;
+
+    ++stats_.reads;
+    if( spin_.count() > 0 ) {
+        const auto start = clock_t::now();
+        const auto deadline = start + spin_;
+        unsigned backoff = 1;
+        for( ;; ) {
+            long long size = ::recv(_s, _buff, _length, _flags | network::detail::dont_wait);
+            if( size != -1 || !would_block(last_error()) ) {
+                stats_.spin_time += clock_t::now() - start;
+                if( size != -1 ) {
+                    ++stats_.spin_hits;
+                    spin_ += spin_ / 4 + min_spin_;
+                    if( spin_ > max_spin_ )
+                        spin_ = max_spin_;
+                }
+                return size;
+            }
+            const auto now = clock_t::now();
+            if( now >= deadline ) {
+                stats_.spin_time += now - start;
+                break;
+            }
+            for( unsigned i = 0; i < backoff; ++i )
+                network::detail::cpu_relax();
+            if( backoff < max_backoff )
+                backoff <<= 1;
+        }
+        spin_ /= 2;
+        if( spin_ < min_spin_ )
+            spin_ = min_spin_;
+    }
+
+    ++stats_.blocks;
+    const auto start = clock_t::now();
+    network::detail::pollfd_t pfd { };
+    pfd.fd = _s;
+    pfd.events = POLLIN;
+    for( ;; ) {
+        // Signals and spurious wakeups resume waiting for the time left, not the whole timeout.
+        int wait = -1;
+        if( _timeout.count() >= 0 ) {
+            const auto left = _timeout.count() - std::chrono::duration_cast<std::chrono::milliseconds>(clock_t::now() - start).count();
+            wait = left <= 0 ? 0 : left >= INT_MAX ? INT_MAX : (int)left;
+        }
+        int count = network::detail::poll(&pfd, 1, wait);
+        if( count == 0 ) {
+            stats_.block_time += clock_t::now() - start;
+            errno = network::detail::timed_out;
+            return -1;
+        }
+        if( count == -1 && last_error() == EINTR )
+            continue;
+        long long size = count == -1 ? -1 : ::recv(_s, _buff, _length, _flags | network::detail::dont_wait);
+        if( size != -1 || !(would_block(last_error()) || last_error() == EINTR) ) {
+            stats_.block_time += clock_t::now() - start;
+            return size;
+        }
+    }
+}
+
+/**
+ * Enables kernel busy polling of device queue for socket
+ * @param _s - socket
+ * @param _usec - microseconds kernel busy polls on blocking reads and poll
+ * @param _prefer - busy polling suppresses interrupts (SO_PREFER_BUSY_POLL) where supported
+ * @return false if kernel doesn't support it or it is not permitted (raising needs CAP_NET_ADMIN)
+ */
+bool busy_poller::enable_kernel(network::detail::socket_t _s, std::chrono::microseconds _usec, bool _prefer) noexcept
+{
+#if defined(__linux__)
+    if( !network::detail::set_option(_s, option::busy_poll((int)_usec.count())) )
+        return false;
+#if defined(SO_PREFER_BUSY_POLL)
+    if( _prefer )
+        network::detail::set_option(_s, option::prefer_busy_poll(true));
+#else
+    (void)_prefer;
+#endif
+    return true;
+#else
+    (void)_s;
+    (void)_usec;
+    (void)_prefer;
+    return false;
+#endif
+}
+
+///                             Reading
@@ -0,0 +1,220 @@
+#pragma once
+
+
+///                              Constructors
+
+/// Closes remaining sockets.
+template<class _State>
+connection_table<_State>::~connection_table() noexcept
+{
+    clear();
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _State>
+std::size_t connection_table<_State>::size() const noexcept
+{
+    return size_;
+}
+
+/// Slots allocated so far, table grows by whole slabs.
+template<class _State>
+std::size_t connection_table<_State>::capacity() const noexcept
+{
+    return slabs_.size() * slab_size;
+}
+
+template<class _State>
+bool connection_table<_State>::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+/// Bytes of allocated slabs, heap memory owned by states excluded.
+template<class _State>
+std::size_t connection_table<_State>::memory() const noexcept
+{
+    return capacity() * sizeof(slot) + slabs_.capacity() * sizeof(std::unique_ptr<slot[]>);
+}
+
+/// Allocates slabs ahead, e.g. before accepting expected number of connections.
+template<class _State>
+void connection_table<_State>::reserve(std::size_t _capacity)
+{
+    while( capacity() < _capacity )
+        add_slab();
+}
+
+///                             Properties
+
+
+///                             Lookup
+
+template<class _State>
+bool connection_table<_State>::contains(connection_handle _handle) const noexcept
+{
+    return at(_handle) != nullptr;
+}
+
+/// State of connection, nullptr if handle is stale.
+template<class _State>
+_State* connection_table<_State>::find(connection_handle _handle) noexcept
+{
+    slot* s = at(_handle);
+    return s ? &s->value() : nullptr;
+}
+
+template<class _State>
+const _State* connection_table<_State>::find(connection_handle _handle) const noexcept
+{
+    slot* s = at(_handle);
+    return s ? &s->value() : nullptr;
+}
+
+/// Socket of connection, nullptr if handle is stale, stays valid like state until erase.
+template<class _State>
+const base_socket* connection_table<_State>::socket(connection_handle _handle) const noexcept
+{
+    slot* s = at(_handle);
+    return s ? &s->s : nullptr;
+}
+
+/**
+ * Visits live connections in slot order
+ * @param _func - void(connection_handle, _State&), it must not insert or erase
+ */
+template<class _State>
+template<class _Func>
+void connection_table<_State>::for_each(_Func&& _func)
+{
+    for( std::uint32_t i = 0; i < used_; ++i ) {
+        slot& s = at(i);
+        if( s.generation & 1 )
+            _func(connection_handle { i, s.generation }, s.value());
+    }
+}
+
+template<class _State>
+template<class _Func>
+void connection_table<_State>::for_each(_Func&& _func) const
+{
+    for( std::uint32_t i = 0; i < used_; ++i ) {
+        slot& s = at(i);
+        if( s.generation & 1 )
+            _func(connection_handle { i, s.generation }, static_cast<const _State&>(s.value()));
+    }
+}
+
+template<class _State>
+typename connection_table<_State>::slot* connection_table<_State>::at(connection_handle _handle) const noexcept
+{
+    if( _handle.index >= used_ )
+        return nullptr;
+    slot& s = at(_handle.index);
+    // Free slots have even generation, handles are never issued for them.
+    return s.generation == _handle.generation && (_handle.generation & 1) ? &s : nullptr;
+}
+
+template<class _State>
+typename connection_table<_State>::slot& connection_table<_State>::at(std::uint32_t _index) const noexcept
+{
+    return slabs_[_index / slab_size][_index % slab_size];
+}
+
+///                             Lookup
+
+
+///                             Modifiers
+
+/**
+ * Takes socket over and constructs its state in place
+ * @param _s - connected socket, closed on erase
+ * @param _args - state constructor arguments
+ */
+template<class _State>
+template<class... _Args>
+connection_handle connection_table<_State>::insert(base_socket&& _s, _Args&&... _args)
+{
+    std::uint32_t index = free_;
+    if( index == no_slot ) {
+        if( used_ == capacity() )
+            add_slab();
+        index = used_;
+    }
+    slot& s = at(index);
+    ::new(static_cast<void*>(&s.state)) _State(std::forward<_Args>(_args)...);
+    if( index == free_ )
+        free_ = s.next_free;
+    else
+        ++used_;
+    s.s = std::move(_s);
+    ++s.generation;
+    ++size_;
+    return connection_handle { index, s.generation };
+}
+
+/// Destroys state and closes socket, false if handle is stale.
+template<class _State>
+bool connection_table<_State>::erase(connection_handle _handle) noexcept
+{
+    slot* s = at(_handle);
+    if( !s )
+        return false;
+    s->s = base_socket();
+    destroy(_handle.index);
+    return true;
+}
+
+/// Destroys state and gives socket up without closing it, invalid socket if handle is stale.
+template<class _State>
+base_socket connection_table<_State>::release(connection_handle _handle) noexcept
+{
+    slot* s = at(_handle);
+    if( !s )
+        return base_socket();
+    base_socket released(std::move(s->s));
+    destroy(_handle.index);
+    return released;
+}
+
+/// Erases all connections, slabs are kept for reuse.
+template<class _State>
+void connection_table<_State>::clear() noexcept
+{
+    for( std::uint32_t i = 0; i < used_; ++i ) {
+        slot& s = at(i);
+        if( s.generation & 1 ) {
+            s.s = base_socket();
+            s.value().~_State();
+            ++s.generation;
+        }
+        s.next_free = i + 1 < used_ ? i + 1 : no_slot;
+    }
+    free_ = used_ ? 0 : no_slot;
+    size_ = 0;
+}
+
+template<class _State>
+void connection_table<_State>::add_slab()
+{
+    if( capacity() + slab_size > no_slot )
+        throw std::bad_alloc();
+    slabs_.emplace_back(new slot[slab_size]);
+}
+
+template<class _State>
+void connection_table<_State>::destroy(std::uint32_t _index) noexcept
+{
+    slot& s = at(_index);
+    s.value().~_State();
+    ++s.generation;
+    s.next_free = free_;
+    free_ = _index;
+    --size_;
+}
+
+///                             Modifiers
@@ -0,0 +1,211 @@
+#pragma once
+
+
+namespace detail {
+
+const int mpol_preferred = 1;
+
+inline bool read_file(const std::string& _path, std::string& _data)
+{
+    FILE* f = ::fopen(_path.c_str(), "r");
+    if( !f )
+        return false;
+    char buff[4096];
+    std::size_t size = ::fread(buff, 1, sizeof(buff), f);
+    ::fclose(f);
+    _data.assign(buff, size);
+    while( !_data.empty() && (_data.back() == '\n' || _data.back() == ' ') )
+        _data.pop_back();
+    return true;
+}
+
+inline unsigned read_unsigned(const std::string& _path, unsigned _default) noexcept
+{
+    std::string data;
+    if( !read_file(_path, data) || data.empty() )
+        return _default;
+    return (unsigned)std::strtoul(data.c_str(), nullptr, 10);
+}
+
+/// Parses sysfs cpu list, e.g. "0-3,8,10-11".
+std::vector<unsigned> parse_cpu_list(const std::string& _list)
+{
+    std::vector<unsigned> cpus;
+    const char* p = _list.c_str();
+    while( *p ) {
+        char* end;
+        unsigned first = (unsigned)std::strtoul(p, &end, 10);
+        if( end == p )
+            break;
+        unsigned last = first;
+        p = end;
+        if( *p == '-' ) {
+            last = (unsigned)std::strtoul(p + 1, &end, 10);
+            p = end;
+        }
+        for( unsigned cpu = first; cpu <= last; ++cpu )
+            cpus.push_back(cpu);
+        if( *p == ',' )
+            ++p;
+    }
+    return cpus;
+}
+
+/// Allocates pages preferring _node, returns nullptr on failure.
+void* node_alloc(std::size_t _size, unsigned _node) noexcept
+{
+    void* p = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if( p == MAP_FAILED )
+        return nullptr;
+    const unsigned long bits = sizeof(unsigned long) * CHAR_BIT;
+    if( _node < bits ) {
+        unsigned long mask = 1ul << _node;
+        // Fails without NUMA support, memory then just follows default policy.
+        ::syscall(SYS_mbind, p, _size, mpol_preferred, &mask, bits, 0);
+    }
+    return p;
+}
+
+void node_free(void* _p, std::size_t _size) noexcept
+{
+    if( _p )
+        ::munmap(_p, _size);
+}
+
+} // namespace detail
+
+
+///                              cpu_topology
+
+/// Reads topology, unreadable attributes default to 0 (e.g. in containers hiding sysfs).
+cpu_topology::cpu_topology(const std::string& _sysfs)
+{
+    std::string list;
+    std::vector<unsigned> online;
+    if( network::detail::read_file(_sysfs + "/cpu/online", list) )
+        online = network::detail::parse_cpu_list(list);
+    if( online.empty() )
+        online.push_back(0);
+
+    for( unsigned cpu : online ) {
+        const std::string dir = _sysfs + "/cpu/cpu" + std::to_string(cpu) + "/topology/";
+        cpus_.push_back({ cpu, network::detail::read_unsigned(dir + "core_id", cpu),
+                          network::detail::read_unsigned(dir + "physical_package_id", 0), 0 });
+    }
+
+    std::vector<unsigned> nodes;
+    if( network::detail::read_file(_sysfs + "/node/online", list) )
+        nodes = network::detail::parse_cpu_list(list);
+    for( unsigned node : nodes ) {
+        if( !network::detail::read_file(_sysfs + "/node/node" + std::to_string(node) + "/cpulist", list) )
+            continue;
+        for( unsigned cpu : network::detail::parse_cpu_list(list) ) {
+            for( auto& info : cpus_ ) {
+                if( info.cpu == cpu )
+                    info.node = node;
+            }
+        }
+        if( node + 1 > nodes_ )
+            nodes_ = node + 1;
+    }
+}
+
+const std::vector<cpu_info>& cpu_topology::cpus() const noexcept
+{
+    return cpus_;
+}
+
+/// Nodes count, i.e. the highest online node + 1.
+std::size_t cpu_topology::nodes() const noexcept
+{
+    return nodes_;
+}
+
+/// Online CPU info, nullptr if CPU is offline or unknown.
+const cpu_info* cpu_topology::find(unsigned _cpu) const noexcept
+{
+    for( const auto& info : cpus_ ) {
+        if( info.cpu == _cpu )
+            return &info;
+    }
+    return nullptr;
+}
+
+std::vector<unsigned> cpu_topology::node_cpus(unsigned _node) const
+{
+    std::vector<unsigned> cpus;
+    for( const auto& info : cpus_ ) {
+        if( info.node == _node )
+            cpus.push_back(info.cpu);
+    }
+    return cpus;
+}
+
+/// Online CPUs calling thread may run on (sched_getaffinity), all online CPUs if affinity is unknown.
+std::vector<unsigned> cpu_topology::allowed_cpus() const
+{
+    std::vector<unsigned> cpus;
+    unsigned max_cpu = 0;
+    for( const auto& info : cpus_ )
+        max_cpu = info.cpu > max_cpu ? info.cpu : max_cpu;
+    // Dynamic set, affinity of machines with more than CPU_SETSIZE CPUs doesn't fit cpu_set_t.
+    cpu_set_t* set = CPU_ALLOC(max_cpu + 1);
+    const std::size_t size = CPU_ALLOC_SIZE(max_cpu + 1);
+    const bool known = set && ::sched_getaffinity(0, size, set) == 0;
+    for( const auto& info : cpus_ ) {
+        if( !known || CPU_ISSET_S(info.cpu, size, set) )
+            cpus.push_back(info.cpu);
+    }
+    if( set )
+        CPU_FREE(set);
+    return cpus;
+}
+
+///                              cpu_topology
+
+
+///                              node_allocator
+
+template<class _T>
+_T* node_allocator<_T>::allocate(std::size_t _n)
+{
+    if( _n > std::numeric_limits<std::size_t>::max() / sizeof(_T) )
+        throw std::bad_alloc();
+    void* p = network::detail::node_alloc(_n * sizeof(_T), node_);
+    if( !p )
+        throw std::bad_alloc();
+    return static_cast<_T*>(p);
+}
+
+template<class _T>
+void node_allocator<_T>::deallocate(_T* _p, std::size_t _n) noexcept
+{
+    network::detail::node_free(_p, _n * sizeof(_T));
+}
+
+///                              node_allocator
+
+
+/// Binds calling thread to _cpu, errno is set on failure (e.g. EINVAL if _cpu is outside cgroup cpuset).
+bool pin_thread(unsigned _cpu) noexcept
+{
+    cpu_set_t* set = CPU_ALLOC(_cpu + 1);
+    if( !set ) {
+        errno = ENOMEM;
+        return false;
+    }
+    const std::size_t size = CPU_ALLOC_SIZE(_cpu + 1);
+    CPU_ZERO_S(size, set);
+    CPU_SET_S(_cpu, size, set);
+    const int error = ::pthread_setaffinity_np(::pthread_self(), size, set);
+    CPU_FREE(set);
+    if( error != 0 )
+        errno = error;
+    return error == 0;
+}
+
+/// CPU calling thread runs on, -1 if unknown.
+int current_cpu() noexcept
+{
+    return ::sched_getcpu();
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+
+namespace detail {
+
+#if defined(__linux__)
+
+inline std::uint32_t to_epoll_events(unsigned _events) noexcept
+{
+    return (_events & event_loop::read ? EPOLLIN : 0u) | (_events & event_loop::write ? EPOLLOUT : 0u);
+}
+
+inline unsigned from_epoll_events(std::uint32_t _events) noexcept
+{
+    return (_events & EPOLLIN ? event_loop::read : 0u)
+         | (_events & EPOLLOUT ? event_loop::write : 0u)
+         | (_events & (EPOLLERR | EPOLLHUP) ? event_loop::error : 0u);
+}
+
+#else
+
+inline short to_poll_events(unsigned _events) noexcept
+{
+    return (short)((_events & event_loop::read ? POLLIN : 0) | (_events & event_loop::write ? POLLOUT : 0));
+}
+
+inline unsigned from_poll_events(short _events) noexcept
+{
+    return (_events & POLLIN ? event_loop::read : 0u)
+         | (_events & POLLOUT ? event_loop::write : 0u)
+         | (_events & (POLLERR | POLLHUP | POLLNVAL) ? event_loop::error : 0u);
+}
+
+#endif
+
+} // namespace detail
+
+
+///                              Constructors
+
+event_loop::event_loop() noexcept
+{
+#if defined(__linux__)
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_[0] = wake_[1] = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev { };
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_[0];
+    if( wake_[0] != -1 )
+        ::epoll_ctl(epoll_, EPOLL_CTL_ADD, wake_[0], &ev);
+#elif !defined(_WIN32)
+    if( ::pipe(wake_) == GOOD ) {
+        network::detail::non_blocking(wake_[0]);
+        network::detail::non_blocking(wake_[1]);
+    }
+#endif
+}
+
+event_loop::~event_loop() noexcept
+{
+#if defined(__linux__)
+    if( epoll_ != -1 )
+        ::close(epoll_);
+    if( wake_[0] != -1 )
+        ::close(wake_[0]);
+#elif !defined(_WIN32)
+    if( wake_[0] != -1 ) {
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+    }
+#endif
+}
+
+///                              Constructors
+
+
+///                             Sockets
+
+/**
+ * Starts watching socket readiness
+ * @param _s - socket, it must stay open until remove
+ * @param _events - combination of read and write
+ * @param _handler - called with ready events (may include error)
+ * @return false if socket is already watched or backend failed
+ */
+bool event_loop::add(network::detail::socket_t _s, unsigned _events, event_loop::handler_t _handler)
+{
+    if( handlers_.count(_s) )
+        return false;
+#if defined(__linux__)
+    epoll_event ev { };
+    ev.events = network::detail::to_epoll_events(_events);
+    ev.data.fd = _s;
+    if( ::epoll_ctl(epoll_, EPOLL_CTL_ADD, _s, &ev) != GOOD )
+        return false;
+#endif
+    handlers_[_s] = entry { _events, std::make_shared<handler_t>(std::move(_handler)) };
+    return true;
+}
+
+/// Changes watched events of already added socket.
+bool event_loop::modify(network::detail::socket_t _s, unsigned _events)
+{
+    auto it = handlers_.find(_s);
+    if( it == handlers_.end() )
+        return false;
+    if( it->second.events == _events )
+        return true;
+#if defined(__linux__)
+    epoll_event ev { };
+    ev.events = network::detail::to_epoll_events(_events);
+    ev.data.fd = _s;
+    if( ::epoll_ctl(epoll_, EPOLL_CTL_MOD, _s, &ev) != GOOD )
+        return false;
+#endif
+    it->second.events = _events;
+    return true;
+}
+
+/// Stops watching socket, safe to call from the socket handler.
+bool event_loop::remove(network::detail::socket_t _s)
+{
+    auto it = handlers_.find(_s);
+    if( it == handlers_.end() )
+        return false;
+#if defined(__linux__)
+    ::epoll_ctl(epoll_, EPOLL_CTL_DEL, _s, nullptr);
+#endif
+    handlers_.erase(it);
+    return true;
+}
+
+bool event_loop::contains(network::detail::socket_t _s) const noexcept
+{
+    return handlers_.count(_s) != 0;
+}
+
+/// Watched sockets count.
+std::size_t event_loop::size() const noexcept
+{
+    return handlers_.size();
+}
+
+///                             Sockets
+
+
+///                             Timers
+
+/// Schedules one-shot task, returned timer may be used to cancel it.
+event_loop::timer_t event_loop::add_timer(std::chrono::milliseconds _delay, event_loop::task_t _task)
+{
+    timer_t timer { clock_t::now() + _delay, next_timer_id_++ };
+    timers_.emplace(timer, std::move(_task));
+    return timer;
+}
+
+/// Cancels pending timer, false if it already fired or was cancelled.
+bool event_loop::cancel_timer(const event_loop::timer_t& _timer)
+{
+    return timers_.erase(_timer) != 0;
+}
+
+///                             Timers
+
+
+///                             Tasks
+
+/// Defers task to the end of current (or next) loop iteration.
+void event_loop::post(event_loop::task_t _task)
+{
+    tasks_.push_back(std::move(_task));
+}
+
+/**
+ * Hands task over to the loop thread, callable from any thread without locks
+ * Tasks of one submitter run in submission order. Loop blocked in wait is woken up,
+ * running loop is not, it picks the task up at the end of current iteration.
+ */
+void event_loop::submit(event_loop::task_t _task)
+{
+    submissions_.push(std::move(_task));
+    // Pairs with the fence in run_once: either loop sees the task before waiting or we see it polling.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( polling_.load(std::memory_order_relaxed) && !wake_pending_.exchange(true, std::memory_order_acq_rel) )
+        wake();
+}
+
+void event_loop::wake() noexcept
+{
+#if defined(__linux__)
+    const std::uint64_t one = 1;
+    while( ::write(wake_[1], &one, sizeof(one)) == -1 && errno == EINTR );
+#elif !defined(_WIN32)
+    const char one = 1;
+    while( ::write(wake_[1], &one, sizeof(one)) == -1 && errno == EINTR );
+#endif
+}
+
+void event_loop::clear_wake() noexcept
+{
+#if !defined(_WIN32)
+    char buff[64];
+    while( ::read(wake_[0], buff, sizeof(buff)) > 0 );
+#endif
+    wake_pending_.store(false, std::memory_order_release);
+}
+
+///                             Tasks
+
+
+///                             Running
+
+/**
+ * Waits for readiness at most _timeout (or until the nearest timer) and dispatches
+ * @param _timeout - negative means infinite wait
+ * @return dispatched handlers, timers and tasks count
+ */
+std::size_t event_loop::run_once(std::chrono::milliseconds _timeout)
+{
+    std::size_t handled = 0;
+    polling_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int timeout = submissions_.empty() ? next_timeout(_timeout) : 0;
+    const int count = wait(timeout);
+    polling_.store(false, std::memory_order_relaxed);
+    if( count > 0 ) {
+        for( const auto& ready : ready_ ) {
+            auto it = handlers_.find(ready.first);
+            if( it == handlers_.end() )
+                continue;
+            auto handler = it->second.handler;
+            (*handler)(ready.second);
+            ++handled;
+        }
+    }
+    handled += dispatch_timers();
+    handled += dispatch_tasks();
+    handled += dispatch_submissions();
+    return handled;
+}
+
+/// Runs until stop is called.
+void event_loop::run()
+{
+    stopped_ = false;
+    while( !stopped_ )
+        run_once();
+}
+
+void event_loop::stop() noexcept
+{
+    stopped_ = true;
+}
+
+bool event_loop::stopped() const noexcept
+{
+    return stopped_;
+}
+
+int event_loop::next_timeout(std::chrono::milliseconds _timeout) const
+{
+    if( !tasks_.empty() || stopped_ )
+        return 0;
+    long long timeout = _timeout.count();
+    if( !timers_.empty() ) {
+        auto until = timers_.begin()->first.first - clock_t::now();
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(until).count() + 1;
+        if( ms < 0 )
+            ms = 0;
+        if( timeout < 0 || ms < timeout )
+            timeout = ms;
+    }
+    return timeout > INT_MAX ? INT_MAX : (int)timeout;
+}
+
+int event_loop::wait(int _timeout_ms)
+{
+    ready_.clear();
+#if defined(__linux__)
+    epoll_events_.resize(handlers_.size() + 1);
+    int n = ::epoll_wait(epoll_, epoll_events_.data(), (int)epoll_events_.size(), _timeout_ms);
+    for( int i = 0; i < n; ++i ) {
+        const network::detail::socket_t s = epoll_events_[i].data.fd;
+        if( s == wake_[0] )
+            clear_wake();
+        else
+            ready_.emplace_back(s, network::detail::from_epoll_events(epoll_events_[i].events));
+    }
+#else
+    fds_.clear();
+    if( wake_[0] != -1 )
+        fds_.push_back({ (network::detail::socket_t)wake_[0], POLLIN, 0 });
+    for( const auto& h : handlers_ )
+        fds_.push_back({ h.first, network::detail::to_poll_events(h.second.events), 0 });
+    int n = network::detail::poll(fds_.data(), fds_.size(), _timeout_ms);
+    for( const auto& fd : fds_ ) {
+        if( !fd.revents )
+            continue;
+        if( fd.fd == (network::detail::socket_t)wake_[0] )
+            clear_wake();
+        else
+            ready_.emplace_back(fd.fd, network::detail::from_poll_events(fd.revents));
+    }
+#endif
+    return n;
+}
+
+std::size_t event_loop::dispatch_timers()
+{
+    std::size_t handled = 0;
+    const auto now = clock_t::now();
+    while( !timers_.empty() && timers_.begin()->first.first <= now ) {
+        auto task = std::move(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+        task();
+        ++handled;
+    }
+    return handled;
+}
+
+std::size_t event_loop::dispatch_tasks()
+{
+    std::vector<task_t> tasks;
+    tasks.swap(tasks_);
+    for( auto& task : tasks )
+        task();
+    return tasks.size();
+}
+
+/// Runs submitted tasks, bounded per iteration so busy submitters can't starve sockets.
+std::size_t event_loop::dispatch_submissions()
+{
+    const std::size_t max_batch = 1024;
+    std::size_t handled = 0;
+    task_t task;
+    while( handled < max_batch && submissions_.pop(task) ) {
+        task();
+        ++handled;
+    }
+    return handled;
+}
+
+///                             Running
@@ -0,0 +1,167 @@
+#pragma once
+
+
+namespace detail {
+
+/// Linux sendfile transfers at most this many bytes per call.
+const std::size_t max_sendfile = 0x7ffff000;
+const std::size_t file_block_size = 64 << 10;
+
+#if defined(MSG_MORE)
+const int more_data = MSG_MORE;
+#else
+const int more_data = 0;
+#endif
+
+/**
+ * Sends file range without copying it to user space (linux), offset advances by sent bytes
+ * @param _s - socket
+ * @param _fd - file, its own offset isn't changed
+ * @param _offset - file position
+ * @param _length - bytes to send
+ * @return sent bytes count, 0 if socket would block, -1 on error or if file ends before
+ *         range (ENODATA, bytes sent before it are reported first)
+ */
+long long send_file(socket_t _s, int _fd, std::uint64_t& _offset, std::size_t _length) noexcept
+{
+    std::size_t total = 0;
+    while( total < _length ) {
+        const std::size_t length = std::min(_length - total, max_sendfile);
+#if defined(__linux__)
+        off_t offset = (off_t)_offset;
+        const ssize_t size = ::sendfile(_s, _fd, &offset, length);
+#else
+        char block[file_block_size];
+        ssize_t size = ::pread(_fd, block, std::min(length, sizeof(block)), (off_t)_offset);
+        if( size > 0 ) {
+            // Block is re-read on resume, only what socket took counts.
+            size = ::send(_s, block, (std::size_t)size, nosignal);
+        }
+#endif
+        if( size == -1 ) {
+            if( errno == EINTR )
+                continue;
+            if( would_block(last_error()) )
+                break;
+            return total ? (long long)total : -1;
+        }
+        if( size == 0 ) {
+            if( total )
+                break;
+            errno = ENODATA;
+            return -1;
+        }
+        _offset += (std::uint64_t)size;
+        total += (std::size_t)size;
+    }
+    return (long long)total;
+}
+
+} // namespace detail
+
+
+///                              Constructors
+
+/**
+ * @param _fd - open file, caller keeps it open until transfer is done
+ * @param _offset - first byte of range
+ * @param _length - range length
+ * @param _header - sent before file data, e.g. HTTP response head
+ * @param _trailer - sent after file data, e.g. chunk terminator
+ */
+file_transfer::file_transfer(int _fd, std::uint64_t _offset, std::uint64_t _length,
+                             std::string _header, std::string _trailer)
+    : header_(std::move(_header))
+    , trailer_(std::move(_trailer))
+    , fd_(_fd)
+    , offset_(_offset)
+    , remaining_(_length)
+{
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+int file_transfer::fd() const noexcept
+{
+    return fd_;
+}
+
+/// Next file byte to send.
+std::uint64_t file_transfer::offset() const noexcept
+{
+    return offset_;
+}
+
+/// File bytes left, header and trailer excluded.
+std::uint64_t file_transfer::remaining() const noexcept
+{
+    return remaining_;
+}
+
+/// All bytes sent so far, header and trailer included.
+std::uint64_t file_transfer::sent() const noexcept
+{
+    return sent_;
+}
+
+bool file_transfer::done() const noexcept
+{
+    return header_sent_ == header_.size() && remaining_ == 0 && trailer_sent_ == trailer_.size();
+}
+
+///                             Properties
+
+
+///                             Sending
+
+/**
+ * Sends until done or socket would block, call again on writability
+ * @param _s - socket
+ * @return sent bytes count of this call, -1 on error (ENODATA if file ended before range did)
+ */
+long long file_transfer::send(network::detail::socket_t _s)
+{
+    long long total = 0;
+    if( header_sent_ < header_.size() ) {
+        const long long size = send_buffer(_s, header_, header_sent_, remaining_ || !trailer_.empty() ? network::detail::more_data : 0);
+        if( size == -1 )
+            return -1;
+        total += size;
+        if( header_sent_ < header_.size() )
+            return total;
+    }
+    while( remaining_ ) {
+        const std::size_t length = (std::size_t)std::min<std::uint64_t>(remaining_, network::detail::max_sendfile);
+        const std::uint64_t before = offset_;
+        const long long size = network::detail::send_file(_s, fd_, offset_, length);
+        if( size == -1 )
+            return -1;
+        remaining_ -= offset_ - before;
+        sent_ += offset_ - before;
+        total += size;
+        if( (std::size_t)size < length )
+            return total;
+    }
+    if( trailer_sent_ < trailer_.size() ) {
+        const long long size = send_buffer(_s, trailer_, trailer_sent_, 0);
+        if( size == -1 )
+            return -1;
+        total += size;
+    }
+    return total;
+}
+
+long long file_transfer::send_buffer(network::detail::socket_t _s, const std::string& _data, std::size_t& _sent, int _flags)
+{
+    const long long size = network::detail::send_some(_s, _data.data() + _sent, _data.size() - _sent, _flags);
+    if( size > 0 ) {
+        _sent += (std::size_t)size;
+        sent_ += (std::uint64_t)size;
+    }
+    return size;
+}
+
+///                             Sending
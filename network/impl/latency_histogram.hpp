@@ -0,0 +1,106 @@
+#pragma once
+
+
+///                             Recording
+
+/// Records _value, negative values (e.g. clock steps) are counted as 0.
+void latency_histogram::record(latency_histogram::duration_t _value, std::uint64_t _count) noexcept
+{
+    const std::uint64_t value = _value.count() > 0 ? (std::uint64_t)_value.count() : 0;
+    counts_[index(value)] += _count;
+    count_ += _count;
+    sum_ += (double)value * (double)_count;
+    if( value < min_ )
+        min_ = value;
+    if( value > max_ )
+        max_ = value;
+}
+
+void latency_histogram::merge(const latency_histogram& _other) noexcept
+{
+    for( std::size_t i = 0; i < buckets; ++i )
+        counts_[i] += _other.counts_[i];
+    count_ += _other.count_;
+    sum_ += _other.sum_;
+    if( _other.min_ < min_ )
+        min_ = _other.min_;
+    if( _other.max_ > max_ )
+        max_ = _other.max_;
+}
+
+void latency_histogram::reset() noexcept
+{
+    *this = latency_histogram();
+}
+
+///                             Recording
+
+
+///                             Statistics
+
+std::uint64_t latency_histogram::count() const noexcept
+{
+    return count_;
+}
+
+latency_histogram::duration_t latency_histogram::min() const noexcept
+{
+    return duration_t(count_ ? (long long)min_ : 0);
+}
+
+latency_histogram::duration_t latency_histogram::max() const noexcept
+{
+    return duration_t((long long)max_);
+}
+
+latency_histogram::duration_t latency_histogram::mean() const noexcept
+{
+    return duration_t(count_ ? (long long)(sum_ / (double)count_) : 0);
+}
+
+/// Value below which _p percent (0..100) of records fall, rounded up to bucket bound.
+latency_histogram::duration_t latency_histogram::percentile(double _p) const noexcept
+{
+    if( !count_ )
+        return duration_t(0);
+    std::uint64_t rank = (std::uint64_t)((_p / 100.0) * (double)count_ + 0.5);
+    if( rank == 0 )
+        rank = 1;
+    if( rank > count_ )
+        rank = count_;
+    std::uint64_t seen = 0;
+    for( std::size_t i = 0; i < buckets; ++i ) {
+        seen += counts_[i];
+        if( seen >= rank ) {
+            const std::uint64_t bound = upper_bound(i);
+            return duration_t((long long)(bound < max_ ? bound : max_));
+        }
+    }
+    return max();
+}
+
+std::size_t latency_histogram::index(std::uint64_t _value) noexcept
+{
+    if( _value < linear )
+        return (std::size_t)_value;
+#if defined(_MSC_VER)
+    unsigned msb = 0;
+    while( _value >> (msb + 1) )
+        ++msb;
+#else
+    const unsigned msb = 63 - (unsigned)__builtin_clzll(_value);
+#endif
+    const unsigned shift = msb - sub_bits;
+    return ((std::size_t)shift << sub_bits) + (std::size_t)(_value >> shift);
+}
+
+std::uint64_t latency_histogram::upper_bound(std::size_t _index) noexcept
+{
+    if( _index < linear )
+        return _index;
+    const unsigned shift = (unsigned)(_index >> sub_bits) - 1;
+    const std::uint64_t mantissa = (_index & ((1u << sub_bits) - 1)) + (1u << sub_bits);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+///                             Statistics
@@ -0,0 +1,188 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * Starts loops and waits until all of them are running
+ * @param _topology - machine topology
+ * @param _cpus - CPUs to run loops on, if empty online CPUs the process may run on
+ *                (affinity set by taskset or cgroup cpuset)
+ */
+loop_group::loop_group(const cpu_topology& _topology, std::vector<unsigned> _cpus)
+    : topology_(_topology)
+{
+    if( _cpus.empty() )
+        _cpus = _topology.allowed_cpus();
+    if( _cpus.empty() ) {
+        for( const auto& info : _topology.cpus() )
+            _cpus.push_back(info.cpu);
+    }
+    for( unsigned cpu : _cpus ) {
+        const cpu_info* info = _topology.find(cpu);
+        std::unique_ptr<slot> s(new slot());
+        s->cpu = cpu;
+        s->node = info ? info->node : 0;
+        s->core = info ? info->core : cpu;
+        s->package = info ? info->package : 0;
+        slots_.push_back(std::move(s));
+    }
+    for( auto& s : slots_ ) {
+        slot* p = s.get();
+        p->thread = std::thread([this, p] { run(*p); });
+    }
+    std::unique_lock<std::mutex> lock(ready_mutex_);
+    ready_.wait(lock, [this] { return started_ == slots_.size(); });
+}
+
+loop_group::~loop_group() noexcept
+{
+    stop();
+    for( auto& s : slots_ ) {
+        if( s->thread.joinable() )
+            s->thread.join();
+    }
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+std::size_t loop_group::size() const noexcept
+{
+    return slots_.size();
+}
+
+/// Loop, it may be used only from its thread (e.g. in posted tasks).
+event_loop& loop_group::loop(std::size_t _index) noexcept
+{
+    return *slots_[_index]->loop;
+}
+
+unsigned loop_group::cpu(std::size_t _index) const noexcept
+{
+    return slots_[_index]->cpu;
+}
+
+unsigned loop_group::node(std::size_t _index) const noexcept
+{
+    return slots_[_index]->node;
+}
+
+/// If loop thread is bound to cpu(_index).
+bool loop_group::pinned(std::size_t _index) const noexcept
+{
+    return slots_[_index]->pin_error == 0;
+}
+
+/// Why loop thread couldn't be pinned, 0 if it is pinned.
+int loop_group::pin_error(std::size_t _index) const noexcept
+{
+    return slots_[_index]->pin_error;
+}
+
+/// Allocator of loop's NUMA node, e.g. for connection buffers.
+node_allocator<char> loop_group::allocator(std::size_t _index) const noexcept
+{
+    return node_allocator<char>(slots_[_index]->node);
+}
+
+/**
+ * Loop closest to _cpu: the one on it, then on its SMT sibling, then on its node
+ * @param _cpu - CPU, negative if unknown
+ * @return loop index, loops are chosen round-robin if _cpu is unknown or has no loop nearby
+ */
+std::size_t loop_group::index_for_cpu(int _cpu) const noexcept
+{
+    const cpu_info* info = _cpu >= 0 ? topology_.find((unsigned)_cpu) : nullptr;
+    if( info ) {
+        std::size_t same_core = slots_.size();
+        std::size_t same_node = slots_.size();
+        for( std::size_t i = 0; i < slots_.size(); ++i ) {
+            const slot& s = *slots_[i];
+            if( s.cpu == info->cpu )
+                return i;
+            if( same_core == slots_.size() && s.core == info->core && s.package == info->package )
+                same_core = i;
+            if( same_node == slots_.size() && s.node == info->node )
+                same_node = i;
+        }
+        if( same_core != slots_.size() )
+            return same_core;
+        if( same_node != slots_.size() )
+            return same_node;
+    }
+    return next_.fetch_add(1, std::memory_order_relaxed) % slots_.size();
+}
+
+///                             Properties
+
+
+///                             Tasks
+
+/// Runs task on loop _index thread, see event_loop::submit.
+void loop_group::post(std::size_t _index, task_t _task)
+{
+    slots_[_index]->loop->submit(std::move(_task));
+}
+
+/// Stops all loops, pending tasks are still executed.
+void loop_group::stop()
+{
+    if( stopped_ )
+        return;
+    stopped_ = true;
+    for( std::size_t i = 0; i < slots_.size(); ++i ) {
+        event_loop* loop = slots_[i]->loop.get();
+        post(i, [loop] { loop->stop(); });
+    }
+}
+
+void loop_group::run(slot& _slot)
+{
+    _slot.pin_error = pin_thread(_slot.cpu) ? 0 : errno;
+    _slot.loop.reset(new event_loop());
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ++started_;
+    }
+    ready_.notify_all();
+    _slot.loop->run();
+}
+
+///                             Tasks
+
+
+///                             Sockets
+
+/**
+ * Hands socket over to the loop on CPU which received its packets
+ * @param _s - connected socket
+ * @param _handler - invoked on chosen loop thread with the loop and the socket
+ * @return chosen loop index
+ */
+std::size_t loop_group::dispatch(base_socket&& _s, loop_group::accept_handler_t _handler)
+{
+    option::incoming_cpu cpu(-1);
+    if( !network::detail::get_option(_s.socket(), cpu) )
+        cpu.value(-1);
+    const std::size_t index = index_for_cpu(cpu.value());
+    auto s = std::make_shared<base_socket>(std::move(_s));
+    event_loop* loop = slots_[index]->loop.get();
+    post(index, [loop, s, _handler] { _handler(*loop, std::move(*s)); });
+    return index;
+}
+
+/// Accepts connection and dispatches it, false if accept failed.
+template<class _Socket>
+bool loop_group::accept(const _Socket& _listener, loop_group::accept_handler_t _handler)
+{
+    network::detail::socket_t s;
+    if( !network::detail::accept(_listener.socket(), s) )
+        return false;
+    dispatch(base_socket(s), std::move(_handler));
+    return true;
+}
+
+///                             Sockets
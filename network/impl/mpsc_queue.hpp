@@ -0,0 +1,63 @@
+#pragma once
+
+
+///                              Constructors
+
+template<class _T>
+mpsc_queue<_T>::mpsc_queue()
+    : head_(new node())
+{
+    tail_ = head_.load(std::memory_order_relaxed);
+}
+
+template<class _T>
+mpsc_queue<_T>::~mpsc_queue() noexcept
+{
+    node* n = tail_;
+    while( n ) {
+        node* next = n->next.load(std::memory_order_relaxed);
+        delete n;
+        n = next;
+    }
+}
+
+///                              Constructors
+
+
+///                              Producers
+
+/// Appends value, one exchange and one store regardless of contention.
+template<class _T>
+void mpsc_queue<_T>::push(_T&& _value)
+{
+    node* n = new node(std::move(_value));
+    node* prev = head_.exchange(n, std::memory_order_acq_rel);
+    // Between exchange and this store consumer sees queue ending at prev, value becomes visible here.
+    prev->next.store(n, std::memory_order_release);
+}
+
+///                              Producers
+
+
+///                              Consumer
+
+/// Takes the oldest value, false if queue is empty (or the oldest push isn't linked yet).
+template<class _T>
+bool mpsc_queue<_T>::pop(_T& _value)
+{
+    node* next = tail_->next.load(std::memory_order_acquire);
+    if( !next )
+        return false;
+    _value = std::move(next->value);
+    delete tail_;
+    tail_ = next;
+    return true;
+}
+
+template<class _T>
+bool mpsc_queue<_T>::empty() const noexcept
+{
+    return tail_->next.load(std::memory_order_acquire) == nullptr;
+}
+
+///                              Consumer
@@ -0,0 +1,312 @@
+#pragma once
+
+
+///                              token_bucket
+
+/**
+ * @param _rate - bytes per second, 0 means unlimited
+ * @param _burst - bucket depth in bytes, 0 means rate / 100 (10ms worth of data, at least 1500 bytes)
+ * @param _parent - group or global bucket
+ */
+token_bucket::token_bucket(std::uint64_t _rate, std::uint64_t _burst, token_bucket* _parent) noexcept
+    : rate_(0)
+    , burst_(0)
+    , tokens_(0)
+    , last_(clock_t::now())
+    , parent_(_parent)
+{
+    rate(_rate, _burst);
+}
+
+std::uint64_t token_bucket::rate() const noexcept
+{
+    return rate_;
+}
+
+std::uint64_t token_bucket::burst() const noexcept
+{
+    return burst_;
+}
+
+/// Changes rate, bucket starts full.
+void token_bucket::rate(std::uint64_t _rate, std::uint64_t _burst) noexcept
+{
+    rate_ = _rate;
+    burst_ = _burst ? _burst : (_rate / 100 > 1500 ? _rate / 100 : 1500);
+    tokens_ = (double)burst_;
+    last_ = clock_t::now();
+}
+
+token_bucket* token_bucket::parent() const noexcept
+{
+    return parent_;
+}
+
+void token_bucket::parent(token_bucket* _parent) noexcept
+{
+    parent_ = _parent;
+}
+
+/// If neither bucket nor its ancestors limit rate.
+bool token_bucket::unlimited() const noexcept
+{
+    return rate_ == 0 && (!parent_ || parent_->unlimited());
+}
+
+/// Smallest burst in the chain, i.e. most bytes which may ever be available at once.
+std::uint64_t token_bucket::depth() const noexcept
+{
+    std::uint64_t bytes = rate_ ? burst_ : UINT64_MAX;
+    if( parent_ ) {
+        const std::uint64_t parent = parent_->depth();
+        if( parent < bytes )
+            bytes = parent;
+    }
+    return bytes;
+}
+
+/// Bytes which may be sent now through the whole chain.
+std::uint64_t token_bucket::available(clock_t::time_point _now) noexcept
+{
+    std::uint64_t bytes = UINT64_MAX;
+    if( rate_ ) {
+        refill(_now);
+        bytes = (std::uint64_t)tokens_;
+    }
+    if( parent_ ) {
+        const std::uint64_t parent = parent_->available(_now);
+        if( parent < bytes )
+            bytes = parent;
+    }
+    return bytes;
+}
+
+void token_bucket::consume(std::uint64_t _bytes, clock_t::time_point _now) noexcept
+{
+    if( rate_ ) {
+        refill(_now);
+        tokens_ -= (double)_bytes;
+    }
+    if( parent_ )
+        parent_->consume(_bytes, _now);
+}
+
+/// Time until _bytes (capped by burst) become available through the whole chain.
+std::chrono::nanoseconds token_bucket::delay(std::uint64_t _bytes, clock_t::time_point _now) noexcept
+{
+    std::chrono::nanoseconds wait { 0 };
+    if( rate_ ) {
+        refill(_now);
+        const double need = (double)(_bytes < burst_ ? _bytes : burst_) - tokens_;
+        if( need > 0 )
+            wait = std::chrono::nanoseconds((long long)(need * 1e9 / (double)rate_) + 1);
+    }
+    if( parent_ ) {
+        const auto parent = parent_->delay(_bytes, _now);
+        if( parent > wait )
+            wait = parent;
+    }
+    return wait;
+}
+
+void token_bucket::refill(clock_t::time_point _now) noexcept
+{
+    if( _now <= last_ )
+        return;
+    const double elapsed = std::chrono::duration<double>(_now - last_).count();
+    tokens_ += elapsed * (double)rate_;
+    if( tokens_ > (double)burst_ )
+        tokens_ = (double)burst_;
+    last_ = _now;
+}
+
+///                              token_bucket
+
+
+///                              Constructors
+
+/**
+ * @param _loop - loop driving the socket
+ * @param _s - non-blocking connected socket, it is not owned
+ * @param _group - group/global bucket chain socket bucket is attached to
+ * @param _register - if sender registers socket in loop for write readiness itself
+ */
+paced_sender::paced_sender(network::event_loop& _loop, network::detail::socket_t _s, token_bucket* _group, bool _register)
+    : loop_(_loop)
+    , s_(_s)
+    , bucket_(0, 0, _group)
+{
+    if( _register )
+        registered_ = loop_.add(s_, network::event_loop::none, [this](unsigned _events) { on_events(_events); });
+}
+
+paced_sender::~paced_sender() noexcept
+{
+    if( timer_armed_ )
+        loop_.cancel_timer(timer_);
+    if( registered_ )
+        loop_.remove(s_);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+network::detail::socket_t paced_sender::socket() const noexcept
+{
+    return s_;
+}
+
+/**
+ * Sets socket level rate
+ * @param _rate - bytes per second, 0 removes limit
+ * @param _burst - user space bucket depth, see token_bucket
+ * @param _kernel - try SO_MAX_PACING_RATE first, it is used only for TCP sockets: kernel accepts
+ *                  it for any socket but paces others only under fq qdisc
+ * @return if kernel pacing is used, otherwise rate is enforced in user space
+ */
+bool paced_sender::rate(std::uint64_t _rate, std::uint64_t _burst, bool _kernel) noexcept
+{
+#if defined(__linux__)
+    SocketType type;
+    AddressFamily family;
+    const bool tcp = network::detail::socket_type(s_, type) && type == SocketType::Tcp
+                  && network::detail::socket_family(s_, family) && option::max_pacing_rate::applies_to(family);
+    if( _kernel && _rate && tcp && network::detail::set_option(s_, option::max_pacing_rate(_rate)) ) {
+        kernel_paced_ = true;
+        bucket_.rate(0);
+        return true;
+    }
+    if( kernel_paced_ )
+        network::detail::set_option(s_, option::max_pacing_rate());
+#else
+    (void)_kernel;
+#endif
+    kernel_paced_ = false;
+    bucket_.rate(_rate, _burst);
+    return false;
+}
+
+bool paced_sender::kernel_paced() const noexcept
+{
+    return kernel_paced_;
+}
+
+/// Socket level bucket, its parent is the group bucket.
+token_bucket& paced_sender::bucket() noexcept
+{
+    return bucket_;
+}
+
+/// Outbound queue, its watermarks provide backpressure for writers.
+send_queue& paced_sender::queue() noexcept
+{
+    return queue_;
+}
+
+/// Minimal bytes released at once, small quantum smooths egress at the cost of more syscalls.
+void paced_sender::quantum(std::size_t _bytes) noexcept
+{
+    quantum_ = _bytes ? _bytes : 1;
+}
+
+/// If socket write readiness is needed.
+bool paced_sender::wants_write() const noexcept
+{
+    return wants_write_;
+}
+
+/// Bytes handed to the kernel.
+std::uint64_t paced_sender::sent() const noexcept
+{
+    return sent_;
+}
+
+///                             Properties
+
+
+///                             Sending
+
+/// Queues data and sends what tokens allow, false if queue isn't writable.
+bool paced_sender::write(const char* _data, std::size_t _length)
+{
+    return write(std::vector<char>(_data, _data + _length));
+}
+
+bool paced_sender::write(std::vector<char>&& _data)
+{
+    if( !queue_.push(std::move(_data)) )
+        return false;
+    if( !timer_armed_ && !wants_write_ )
+        flush();
+    return true;
+}
+
+void paced_sender::on_events(unsigned _events)
+{
+    if( _events & (network::event_loop::write | network::event_loop::error) )
+        flush();
+}
+
+/// Sets callback invoked on socket error, queued data is dropped.
+void paced_sender::on_error(std::function<void(network::error)> _callback)
+{
+    on_error_ = std::move(_callback);
+}
+
+void paced_sender::flush()
+{
+    while( !queue_.empty() ) {
+        const auto now = token_bucket::clock_t::now();
+        std::uint64_t want = queue_.size() < quantum_ ? queue_.size() : quantum_;
+        if( want > bucket_.depth() )
+            want = bucket_.depth();
+        const std::uint64_t allowed = bucket_.available(now);
+        if( allowed < want && !bucket_.unlimited() ) {
+            wait_write(false);
+            schedule(bucket_.delay(want, now));
+            return;
+        }
+        const long long size = queue_.flush_some(*this, (std::size_t)(allowed < queue_.size() ? allowed : queue_.size()));
+        if( size == -1 ) {
+            network::error error;
+            error = network::detail::last_error();
+            queue_.clear();
+            wait_write(false);
+            if( on_error_ )
+                on_error_(error);
+            return;
+        }
+        bucket_.consume((std::uint64_t)size, now);
+        sent_ += (std::uint64_t)size;
+        if( size == 0 ) {
+            wait_write(true);
+            return;
+        }
+    }
+    wait_write(false);
+}
+
+void paced_sender::wait_write(bool _on)
+{
+    if( wants_write_ == _on )
+        return;
+    wants_write_ = _on;
+    if( registered_ )
+        loop_.modify(s_, _on ? network::event_loop::write : network::event_loop::none);
+}
+
+void paced_sender::schedule(std::chrono::nanoseconds _delay)
+{
+    if( timer_armed_ )
+        return;
+    timer_armed_ = true;
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(_delay + std::chrono::nanoseconds(999999));
+    timer_ = loop_.add_timer(delay, [this] {
+        timer_armed_ = false;
+        flush();
+    });
+}
+
+///                             Sending
@@ -0,0 +1,260 @@
+#pragma once
+
+
+namespace detail {
+
+const std::size_t pipeline_read_chunk = 64 * 1024;
+
+} // namespace detail
+
+
+///                              Constructors
+
+/**
+ * Takes over connected socket
+ * @param _loop - loop driving the connection
+ * @param _s - connected socket, it's switched to non-blocking mode
+ * @param _window - max requests in flight
+ * @param _codec - requests/responses framing
+ */
+template<class _Codec>
+pipeline_client<_Codec>::pipeline_client(network::event_loop& _loop, base_socket&& _s, std::size_t _window, _Codec _codec)
+    : loop_(_loop)
+    , s_(std::move(_s))
+    , window_(_window)
+    , codec_(std::move(_codec))
+    , queue_(SIZE_MAX, 0)
+    , alive_(std::make_shared<char>())
+{
+    open_ = s_.non_blocking(true) && loop_.add(s_.socket(), network::event_loop::read, [this](unsigned _events) { on_events(_events); });
+}
+
+/// Pending handlers are invoked with ECANCELED.
+template<class _Codec>
+pipeline_client<_Codec>::~pipeline_client() noexcept
+{
+    close(ECANCELED);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _Codec>
+bool pipeline_client<_Codec>::is_open() const noexcept
+{
+    return open_;
+}
+
+template<class _Codec>
+std::size_t pipeline_client<_Codec>::in_flight() const noexcept
+{
+    return fifo_.size() + by_id_.size();
+}
+
+template<class _Codec>
+std::size_t pipeline_client<_Codec>::window() const noexcept
+{
+    return window_;
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::window(std::size_t _window) noexcept
+{
+    window_ = _window;
+}
+
+/// Sets callback invoked when request was refused due to full window and window got room since.
+template<class _Codec>
+void pipeline_client<_Codec>::on_window_available(pipeline_client<_Codec>::callback_t _callback)
+{
+    on_window_available_ = std::move(_callback);
+}
+
+///                             Properties
+
+
+///                             Requests
+
+/**
+ * Queues request, it is sent at the end of current loop iteration with its neighbours
+ * @param _request - request
+ * @param _handler - invoked with response or error
+ * @return false if client is closed or window is full
+ */
+template<class _Codec>
+bool pipeline_client<_Codec>::request(const request_type& _request, handler_t _handler)
+{
+    if( !open_ )
+        return false;
+    if( in_flight() >= window_ ) {
+        window_full_ = true;
+        return false;
+    }
+    const std::uint64_t id = next_id_++;
+    codec_.encode(batch_, _request, id);
+    if( _Codec::correlated )
+        by_id_.emplace(id, std::move(_handler));
+    else
+        fifo_.push_back(std::move(_handler));
+    schedule_flush();
+    return true;
+}
+
+/// Closes connection and fails pending requests with _error.
+template<class _Codec>
+void pipeline_client<_Codec>::close(int _error)
+{
+    if( open_ ) {
+        loop_.remove(s_.socket());
+        s_.close();
+        s_.exchange();
+        open_ = false;
+    }
+    queue_.clear();
+    batch_.clear();
+
+    network::error error;
+    error = _error;
+    auto fifo = std::move(fifo_);
+    auto by_id = std::move(by_id_);
+    fifo_.clear();
+    by_id_.clear();
+    for( auto& handler : fifo )
+        handler(response_type(), error);
+    for( auto& handler : by_id )
+        handler.second(response_type(), error);
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::schedule_flush()
+{
+    if( flush_scheduled_ )
+        return;
+    flush_scheduled_ = true;
+    std::weak_ptr<char> alive = alive_;
+    loop_.post([this, alive] {
+        if( alive.expired() )
+            return;
+        flush_scheduled_ = false;
+        flush();
+    });
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::flush()
+{
+    if( !open_ )
+        return;
+    if( !batch_.empty() ) {
+        if( !queue_.push(std::move(batch_)) ) {
+            close(ENOBUFS);
+            return;
+        }
+        batch_.clear();
+    }
+    if( !queue_.flush(s_) ) {
+        close(network::detail::last_error());
+        return;
+    }
+    update_interest();
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::update_interest()
+{
+    loop_.modify(s_.socket(), queue_.empty() ? network::event_loop::read
+                                             : network::event_loop::read | network::event_loop::write);
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::on_events(unsigned _events)
+{
+    if( _events & network::event_loop::write )
+        flush();
+    if( open_ && (_events & (network::event_loop::read | network::event_loop::error)) )
+        on_read();
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::on_read()
+{
+    // Peer may answer and close right away, responses read before EOF are still delivered.
+    int eof = NO_ERROR;
+    for( ;; ) {
+        const std::size_t end = rx_.size();
+        rx_.resize(end + network::detail::pipeline_read_chunk);
+        long long size = ::recv(s_.socket(), rx_.data() + end, network::detail::pipeline_read_chunk, 0);
+        rx_.resize(end + (size > 0 ? (std::size_t)size : 0));
+        if( size == 0 ) {
+            eof = ECONNRESET;
+            break;
+        }
+        if( size == -1 ) {
+            const int err = network::detail::last_error();
+            if( err == EINTR )
+                continue;
+            if( network::detail::would_block(err) )
+                break;
+            eof = err;
+            break;
+        }
+    }
+
+    for( ;; ) {
+        response_type response;
+        std::uint64_t id = 0;
+        long long size = codec_.decode(rx_.data() + rx_begin_, rx_.size() - rx_begin_, response, id);
+        if( size == 0 )
+            break;
+        if( size < 0 || !complete(id, std::move(response)) ) {
+            close(EPROTO);
+            return;
+        }
+        rx_begin_ += (std::size_t)size;
+        if( !open_ )
+            return;
+    }
+    rx_.erase(rx_.begin(), rx_.begin() + rx_begin_);
+    rx_begin_ = 0;
+    if( eof != NO_ERROR ) {
+        close(eof);
+        return;
+    }
+    check_window();
+}
+
+/// Invokes handler of response, false if response doesn't match any request.
+template<class _Codec>
+bool pipeline_client<_Codec>::complete(std::uint64_t _id, response_type&& _response)
+{
+    handler_t handler;
+    if( _Codec::correlated ) {
+        auto it = by_id_.find(_id);
+        if( it == by_id_.end() )
+            return false;
+        handler = std::move(it->second);
+        by_id_.erase(it);
+    }
+    else {
+        if( fifo_.empty() )
+            return false;
+        handler = std::move(fifo_.front());
+        fifo_.pop_front();
+    }
+    handler(std::move(_response), network::error());
+    return true;
+}
+
+template<class _Codec>
+void pipeline_client<_Codec>::check_window()
+{
+    if( window_full_ && in_flight() < window_ ) {
+        window_full_ = false;
+        if( on_window_available_ )
+            on_window_available_();
+    }
+}
+
+///                             Requests
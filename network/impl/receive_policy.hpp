@@ -0,0 +1,72 @@
+#pragma once
+
+
+///                             fixed_receive
+
+template<std::size_t _Size>
+std::size_t fixed_receive<_Size>::size() const noexcept
+{
+    return _Size;
+}
+
+template<std::size_t _Size>
+std::size_t fixed_receive<_Size>::next(network::detail::socket_t) const noexcept
+{
+    return _Size;
+}
+
+template<std::size_t _Size>
+void fixed_receive<_Size>::record(std::size_t, std::size_t) noexcept
+{
+}
+
+///                             fixed_receive
+
+
+///                             adaptive_receive
+
+/// Current read size.
+template<std::size_t _Min, std::size_t _Max, std::size_t _Initial>
+std::size_t adaptive_receive<_Min, _Max, _Initial>::size() const noexcept
+{
+    return size_;
+}
+
+/// Bytes to request by next read of socket.
+template<std::size_t _Min, std::size_t _Max, std::size_t _Initial>
+std::size_t adaptive_receive<_Min, _Max, _Initial>::next(network::detail::socket_t _s) noexcept
+{
+    if( full_ && size_ < _Max ) {
+        const std::size_t pending = network::detail::available(_s);
+        while( size_ < pending && size_ < _Max )
+            size_ *= 2;
+        if( size_ > _Max )
+            size_ = _Max;
+    }
+    return size_;
+}
+
+/**
+ * Adjusts size after read
+ * @param _requested - bytes requested, i.e. last next() result
+ * @param _received - bytes read
+ */
+template<std::size_t _Min, std::size_t _Max, std::size_t _Initial>
+void adaptive_receive<_Min, _Max, _Initial>::record(std::size_t _requested, std::size_t _received) noexcept
+{
+    full_ = _received >= _requested;
+    if( full_ ) {
+        small_reads_ = 0;
+        size_ = size_ > _Max / 2 ? _Max : size_ * 2;
+    }
+    else if( _received < size_ / 4 && size_ > _Min ) {
+        if( ++small_reads_ < 2 )
+            return;
+        small_reads_ = 0;
+        size_ = size_ / 2 < _Min ? _Min : size_ / 2;
+    }
+    else
+        small_reads_ = 0;
+}
+
+///                             adaptive_receive
@@ -0,0 +1,255 @@
+#pragma once
+
+
+///                              send_queue_budget
+
+send_queue_budget::send_queue_budget(std::size_t _limit) noexcept
+    : limit_(_limit)
+{
+}
+
+/// Maximum bytes all queues may hold together.
+std::size_t send_queue_budget::limit() const noexcept
+{
+    return limit_.load(std::memory_order_relaxed);
+}
+
+void send_queue_budget::limit(std::size_t _limit) noexcept
+{
+    limit_.store(_limit, std::memory_order_relaxed);
+}
+
+/// Bytes currently held by all queues.
+std::size_t send_queue_budget::used() const noexcept
+{
+    return used_.load(std::memory_order_relaxed);
+}
+
+/// Reserves bytes if it doesn't exceed limit.
+bool send_queue_budget::try_acquire(std::size_t _bytes) noexcept
+{
+    std::size_t used = used_.load(std::memory_order_relaxed);
+    do {
+        if( _bytes > limit() || used > limit() - _bytes )
+            return false;
+    } while( !used_.compare_exchange_weak(used, used + _bytes, std::memory_order_relaxed) );
+    return true;
+}
+
+void send_queue_budget::release(std::size_t _bytes) noexcept
+{
+    used_.fetch_sub(_bytes, std::memory_order_relaxed);
+}
+
+/// Budget used by queues by default, unlimited until limit(std::size_t) is called.
+send_queue_budget& send_queue_budget::global() noexcept
+{
+    static send_queue_budget budget;
+    return budget;
+}
+
+///                              send_queue_budget
+
+
+///                              Constructors
+
+send_queue::send_queue(std::size_t _high, std::size_t _low, send_queue_budget& _budget) noexcept
+    : high_(_high)
+    , low_(_low < _high ? _low : _high)
+    , budget_(_budget)
+{
+}
+
+send_queue::~send_queue() noexcept
+{
+    clear();
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+/// Queued bytes count.
+std::size_t send_queue::size() const noexcept
+{
+    return size_;
+}
+
+bool send_queue::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+/// If queue accepts data, i.e. high watermark wasn't reached or it was drained below low one since.
+bool send_queue::writable() const noexcept
+{
+    return !paused_;
+}
+
+std::size_t send_queue::high_watermark() const noexcept
+{
+    return high_;
+}
+
+std::size_t send_queue::low_watermark() const noexcept
+{
+    return low_;
+}
+
+void send_queue::watermarks(std::size_t _high, std::size_t _low) noexcept
+{
+    high_ = _high;
+    low_ = _low < _high ? _low : _high;
+    paused_ = paused_ ? size_ > low_ : size_ >= high_;
+}
+
+/// Sets callback invoked by flush when paused queue drains to low watermark.
+void send_queue::on_writable(send_queue::callback_t _callback)
+{
+    on_writable_ = std::move(_callback);
+}
+
+///                             Properties
+
+
+///                             Modifiers
+
+/// Copies data to the queue, fails if queue isn't writable or budget is exhausted.
+bool send_queue::push(const char* _data, std::size_t _length)
+{
+    return push(std::vector<char>(_data, _data + _length));
+}
+
+bool send_queue::push(std::vector<char>&& _data)
+{
+    if( paused_ || !budget_.try_acquire(_data.size()) )
+        return false;
+    if( _data.empty() )
+        return true;
+    size_ += _data.size();
+    budgeted_ += _data.size();
+    chunks_.push_back(chunk { std::move(_data), nullptr });
+    paused_ = size_ >= high_;
+    return true;
+}
+
+/// Queues reference to immutable buffer, fails if queue isn't writable.
+bool send_queue::push(shared_buffer _data)
+{
+    if( paused_ )
+        return false;
+    if( !_data || _data->empty() )
+        return true;
+    size_ += _data->size();
+    chunks_.push_back(chunk { std::vector<char>(), std::move(_data) });
+    paused_ = size_ >= high_;
+    return true;
+}
+
+/// Drops all queued data and returns it to budget.
+void send_queue::clear() noexcept
+{
+    budget_.release(budgeted_);
+    chunks_.clear();
+    offset_ = 0;
+    size_ = 0;
+    budgeted_ = 0;
+    paused_ = false;
+}
+
+/// Removes sent bytes, they may span several chunks.
+void send_queue::consume(std::size_t _bytes)
+{
+    size_ -= _bytes;
+    while( _bytes ) {
+        chunk& front = chunks_.front();
+        const std::size_t length = front.size() - offset_ < _bytes ? front.size() - offset_ : _bytes;
+        if( !front.shared ) {
+            budget_.release(length);
+            budgeted_ -= length;
+        }
+        _bytes -= length;
+        offset_ += length;
+        if( offset_ == front.size() ) {
+            chunks_.pop_front();
+            offset_ = 0;
+        }
+    }
+}
+
+///                             Modifiers
+
+
+///                             Sending
+
+/**
+ * Sends queued data until socket would block
+ * @param _s - non-blocking socket
+ * @param _flags - send flags
+ * @return false on socket error, queue remains untouched from failed chunk
+ */
+template<class _Socket>
+bool send_queue::flush(const _Socket& _s, int _flags)
+{
+    return flush_some(_s, SIZE_MAX, _flags) != -1;
+}
+
+template<class _Socket>
+bool send_queue::flush(const _Socket& _s, network::error& _error, int _flags)
+{
+    return network::detail::set_error(flush(_s, _flags), _error);
+}
+
+/**
+ * Sends at most _max_bytes of queued data until socket would block, e.g. for pacing
+ * @param _s - non-blocking socket
+ * @param _max_bytes - send limit
+ * @param _flags - send flags
+ * @return sent bytes count or -1 on socket error
+ */
+template<class _Socket>
+long long send_queue::flush_some(const _Socket& _s, std::size_t _max_bytes, int _flags)
+{
+    std::size_t sent = 0;
+    while( !chunks_.empty() && sent < _max_bytes ) {
+#ifndef _WIN32
+        // Queued chunks go out in one sendmsg, e.g. many small broadcast messages.
+        iovec iov[gather_max];
+        std::size_t count = 0;
+        std::size_t length = 0;
+        std::size_t skip = offset_;
+        for( auto it = chunks_.begin(); it != chunks_.end() && count < gather_max && length < _max_bytes - sent; ++it ) {
+            std::size_t size = it->size() - skip;
+            if( size > _max_bytes - sent - length )
+                size = _max_bytes - sent - length;
+            iov[count++] = iovec { const_cast<char*>(it->data() + skip), size };
+            length += size;
+            skip = 0;
+        }
+        long long size = network::detail::send_gather(_s.socket(), iov, count, _flags);
+#else
+        const auto& chunk = chunks_.front();
+        std::size_t length = chunk.size() - offset_;
+        if( length > _max_bytes - sent )
+            length = _max_bytes - sent;
+        long long size = network::detail::send_some(_s.socket(), chunk.data() + offset_, length, _flags);
+#endif
+        if( size == -1 )
+            return -1;
+        if( size == 0 )
+            break;
+        consume(static_cast<std::size_t>(size));
+        sent += static_cast<std::size_t>(size);
+        if( static_cast<std::size_t>(size) < length )
+            break;
+    }
+    if( paused_ && size_ <= low_ ) {
+        paused_ = false;
+        if( on_writable_ )
+            on_writable_();
+    }
+    return (long long)sent;
+}
+
+///                             Sending
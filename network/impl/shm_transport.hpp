@@ -0,0 +1,448 @@
+#pragma once
+
+
+namespace detail {
+
+const std::uint64_t shm_magic = 0x4e45545f53484d31ull;
+const std::size_t shm_cache_line = 64;
+const long shm_wait_timeout_ns = 100 * 1000 * 1000;
+/// Peer shrinking memfd would turn ring accesses into SIGBUS.
+const int shm_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+inline std::size_t shm_header_size() noexcept
+{
+    return (sizeof(shm_region_header) + shm_cache_line - 1) / shm_cache_line * shm_cache_line;
+}
+
+inline std::size_t shm_data_offset() noexcept
+{
+    return shm_header_size() + 2 * sizeof(shm_ring_header);
+}
+
+/// Sleeps while *_addr == _value, wakes up periodically to let caller recheck peer state.
+inline void futex_wait(std::atomic<std::uint32_t>& _addr, std::uint32_t _value) noexcept
+{
+    timespec timeout { 0, shm_wait_timeout_ns };
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&_addr), FUTEX_WAIT, _value, &timeout, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<std::uint32_t>& _addr) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&_addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace detail
+
+
+///                              Constructors
+
+shm_transport::shm_transport(shm_transport&& _other) noexcept
+{
+    *this = std::move(_other);
+}
+
+shm_transport& shm_transport::operator=(shm_transport&& _other) noexcept
+{
+    if( this != &_other ) {
+        close();
+        unmap();
+        memfd_ = _other.memfd_;
+        base_ = _other.base_;
+        length_ = _other.length_;
+        capacity_ = _other.capacity_;
+        region_ = _other.region_;
+        tx_ = _other.tx_;
+        rx_ = _other.rx_;
+        spin_ = _other.spin_;
+        _other.memfd_ = -1;
+        _other.base_ = nullptr;
+        _other.region_ = nullptr;
+        _other.capacity_ = 0;
+    }
+    return *this;
+}
+
+shm_transport::~shm_transport() noexcept
+{
+    close();
+    unmap();
+}
+
+///                              Constructors
+
+
+///                             Setup
+
+/**
+ * Creates shared region
+ * @param _capacity - bytes per direction, rounded up to power of two (at least 4096)
+ * @return false on memfd/mmap failure, errno is set
+ */
+bool shm_transport::create(std::size_t _capacity) noexcept
+{
+    std::size_t capacity = 4096;
+    while( capacity < _capacity )
+        capacity <<= 1;
+    const std::size_t length = detail::shm_data_offset() + 2 * capacity;
+
+    int fd = ::memfd_create("network-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if( fd == -1 )
+        return false;
+    if( ::ftruncate(fd, (off_t)length) != GOOD || ::fcntl(fd, F_ADD_SEALS, detail::shm_seals) != GOOD ) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+    }
+    char* base = (char*)::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if( base == MAP_FAILED ) {
+        ::close(fd);
+        return false;
+    }
+    auto* region = new (base) detail::shm_region_header();
+    region->capacity = capacity;
+    new (base + detail::shm_header_size()) detail::shm_ring_header();
+    new (base + detail::shm_header_size() + sizeof(detail::shm_ring_header)) detail::shm_ring_header();
+    region->magic = detail::shm_magic;
+    ::munmap(base, length);
+    return map(fd, length, true);
+}
+
+/// Maps region created by peer, takes ownership of _memfd, it must have size sealed (EPERM otherwise).
+bool shm_transport::attach(int _memfd) noexcept
+{
+    const int seals = ::fcntl(_memfd, F_GET_SEALS);
+    if( seals == -1 || (seals & detail::shm_seals) != detail::shm_seals ) {
+        ::close(_memfd);
+        errno = EPERM;
+        return false;
+    }
+    struct stat st { };
+    if( ::fstat(_memfd, &st) != GOOD || (std::size_t)st.st_size < detail::shm_data_offset() ) {
+        ::close(_memfd);
+        errno = EINVAL;
+        return false;
+    }
+    return map(_memfd, (std::size_t)st.st_size, false);
+}
+
+/// Creates region and sends its memfd over unix domain socket.
+template<class _Socket>
+bool shm_transport::offer(const _Socket& _s, std::size_t _capacity) noexcept
+{
+    if( !is_open() && !create(_capacity) )
+        return false;
+    return network::local::write_with_fds(_s, "S", 1, { memfd_ }) == 1;
+}
+
+/// Receives memfd from peer over unix domain socket and maps it.
+template<class _Socket>
+bool shm_transport::accept(const _Socket& _s) noexcept
+{
+    std::vector<network::detail::socket_t> fds;
+    char tag;
+    const long long size = network::local::read_with_fds(_s, &tag, 1, fds);
+    if( size != 1 || fds.size() != 1 ) {
+        // Short message or wrong descriptors count isn't a socket error, errno is meaningless.
+        const int error = size == -1 ? errno : EPROTO;
+        for( int fd : fds )
+            ::close(fd);
+        errno = error;
+        return false;
+    }
+    return attach(fds[0]);
+}
+
+/// Marks transport closed for both sides and wakes blocked peer, region stays mapped.
+bool shm_transport::close() noexcept
+{
+    if( !region_ || region_->closed.exchange(1) )
+        return false;
+    for( auto* ring : { tx_.header, rx_.header } ) {
+        ring->data_seq.fetch_add(1);
+        ring->space_seq.fetch_add(1);
+        detail::futex_wake(ring->data_seq);
+        detail::futex_wake(ring->space_seq);
+    }
+    return true;
+}
+
+bool shm_transport::map(int _memfd, std::size_t _length, bool _creator) noexcept
+{
+    unmap();
+    char* base = (char*)::mmap(nullptr, _length, PROT_READ | PROT_WRITE, MAP_SHARED, _memfd, 0);
+    if( base == MAP_FAILED ) {
+        ::close(_memfd);
+        return false;
+    }
+    auto* region = reinterpret_cast<detail::shm_region_header*>(base);
+    // Region may come from untrusted peer, capacity is read once and must describe the mapping.
+    const std::uint64_t capacity = region->capacity;
+    const bool valid = capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+                       capacity <= (SIZE_MAX - detail::shm_data_offset()) / 2 &&
+                       _length == detail::shm_data_offset() + 2 * capacity;
+    if( region->magic != detail::shm_magic || !valid ) {
+        ::munmap(base, _length);
+        ::close(_memfd);
+        errno = EINVAL;
+        return false;
+    }
+    memfd_ = _memfd;
+    base_ = base;
+    length_ = _length;
+    capacity_ = (std::size_t)capacity;
+    region_ = region;
+
+    detail::shm_ring rings[2];
+    for( int i = 0; i < 2; ++i ) {
+        rings[i].header = reinterpret_cast<detail::shm_ring_header*>(base + detail::shm_header_size() + i * sizeof(detail::shm_ring_header));
+        rings[i].data = base + detail::shm_data_offset() + i * capacity_;
+        rings[i].mask = capacity_ - 1;
+    }
+    tx_ = rings[_creator ? 0 : 1];
+    rx_ = rings[_creator ? 1 : 0];
+    return true;
+}
+
+void shm_transport::unmap() noexcept
+{
+    if( base_ )
+        ::munmap(base_, length_);
+    if( memfd_ != -1 )
+        ::close(memfd_);
+    memfd_ = -1;
+    base_ = nullptr;
+    capacity_ = 0;
+    region_ = nullptr;
+    tx_ = rx_ = detail::shm_ring();
+}
+
+///                             Setup
+
+
+///                             Properties
+
+bool shm_transport::is_open() const noexcept
+{
+    return region_ != nullptr;
+}
+
+/// If either side closed transport, remaining data may still be read.
+bool shm_transport::peer_closed() const noexcept
+{
+    return !region_ || region_->closed.load(std::memory_order_acquire);
+}
+
+/// Bytes per direction.
+std::size_t shm_transport::capacity() const noexcept
+{
+    return capacity_;
+}
+
+int shm_transport::memfd() const noexcept
+{
+    return memfd_;
+}
+
+/// Iterations blocked side spins before sleeping, 0 disables busy polling.
+unsigned shm_transport::spin() const noexcept
+{
+    return spin_;
+}
+
+void shm_transport::spin(unsigned _iterations) noexcept
+{
+    spin_ = _iterations;
+}
+
+///                             Properties
+
+
+///                             IO
+
+/// Writes as much as ring fits, returns written bytes count, 0 if ring is full, -1 if closed.
+long long shm_transport::write_some(const char* _data, std::size_t _length) const noexcept
+{
+    if( peer_closed() )
+        return -1;
+    auto& h = *tx_.header;
+    const std::uint64_t head = h.head.load(std::memory_order_relaxed);
+    const std::uint64_t used = head - h.tail.load(std::memory_order_acquire);
+    const std::uint64_t free = used < capacity_ ? capacity_ - used : 0;
+    const std::size_t n = (std::size_t)(_length < free ? _length : free);
+    if( n == 0 )
+        return 0;
+    const std::size_t offset = (std::size_t)(head & tx_.mask);
+    const std::size_t first = n < capacity() - offset ? n : capacity() - offset;
+    memcpy(tx_.data + offset, _data, first);
+    memcpy(tx_.data, _data + first, n - first);
+    h.head.store(head + n, std::memory_order_release);
+    notify(h.data_seq, h.consumer_waiting);
+    return (long long)n;
+}
+
+/// Reads available bytes, returns read bytes count, 0 if ring is empty, -1 if empty and closed.
+long long shm_transport::read_some(char* _buff, std::size_t _length) const noexcept
+{
+    if( !region_ )
+        return -1;
+    auto& h = *rx_.header;
+    const std::uint64_t tail = h.tail.load(std::memory_order_relaxed);
+    const std::uint64_t available = readable();
+    const std::size_t n = (std::size_t)(_length < available ? _length : available);
+    if( n == 0 )
+        return peer_closed() ? -1 : 0;
+    const std::size_t offset = (std::size_t)(tail & rx_.mask);
+    const std::size_t first = n < capacity() - offset ? n : capacity() - offset;
+    memcpy(_buff, rx_.data + offset, first);
+    memcpy(_buff + first, rx_.data, n - first);
+    h.tail.store(tail + n, std::memory_order_release);
+    notify(h.space_seq, h.producer_waiting);
+    return (long long)n;
+}
+
+bool shm_transport::write_n(const char* _data, int _length, int) const noexcept
+{
+    std::size_t done = 0;
+    while( done < (std::size_t)_length ) {
+        long long size = write_some(_data + done, _length - done);
+        if( size == -1 )
+            return false;
+        if( size == 0 && !wait_space() )
+            return false;
+        done += (std::size_t)size;
+    }
+    return true;
+}
+
+bool shm_transport::write_n(const std::vector<char>& _data, int _flags) const noexcept
+{
+    return write_n(_data.data(), (int)_data.size(), _flags);
+}
+
+bool shm_transport::write(const std::string& _data, int _flags) const noexcept
+{
+    return write_n(_data.data(), (int)_data.size(), _flags);
+}
+
+bool shm_transport::read_n(char* _buff, int _length, int) const noexcept
+{
+    std::size_t done = 0;
+    while( done < (std::size_t)_length ) {
+        if( !wait_data() )
+            return false;
+        long long size = read_some(_buff + done, _length - done);
+        if( size == -1 )
+            return false;
+        done += (std::size_t)size;
+    }
+    return true;
+}
+
+bool shm_transport::read_n(std::vector<char>& _buff, int _flags) const noexcept
+{
+    return read_n(_buff.data(), (int)_buff.size(), _flags);
+}
+
+/// Waits for data and reads everything available.
+template<class _Container>
+bool shm_transport::read(_Container& _data, int) const
+{
+    _data.clear();
+    if( !wait_data() )
+        return false;
+    _data.resize((std::size_t)readable());
+    long long size = read_some(&_data[0], _data.size());
+    if( size == -1 )
+        return false;
+    _data.resize((std::size_t)size);
+    return true;
+}
+
+/// Reads up to and including _val, which isn't stored, following bytes stay in ring.
+template<class _Container>
+bool shm_transport::read_until(_Container& _data, char _val, int) const
+{
+    _data.clear();
+    auto& h = *rx_.header;
+    for( ;; ) {
+        if( !wait_data() )
+            return false;
+        const std::uint64_t tail = h.tail.load(std::memory_order_relaxed);
+        const std::uint64_t head = tail + readable();
+        std::uint64_t pos = tail;
+        bool found = false;
+        for( ; pos != head; ++pos ) {
+            const char c = rx_.data[pos & rx_.mask];
+            if( c == _val ) {
+                found = true;
+                ++pos;
+                break;
+            }
+            _data.push_back(c);
+        }
+        h.tail.store(pos, std::memory_order_release);
+        notify(h.space_seq, h.producer_waiting);
+        if( found )
+            return true;
+    }
+}
+
+template<class _Ready>
+bool shm_transport::wait(std::atomic<std::uint32_t>& _seq, std::atomic<std::uint32_t>& _waiting, const _Ready& _ready) const noexcept
+{
+    for( unsigned i = 0; i < spin_; ++i ) {
+        if( _ready() )
+            return true;
+        network::detail::cpu_relax();
+    }
+    for( ;; ) {
+        _waiting.store(1, std::memory_order_seq_cst);
+        const std::uint32_t seq = _seq.load(std::memory_order_seq_cst);
+        if( _ready() || peer_closed() ) {
+            _waiting.store(0, std::memory_order_relaxed);
+            return _ready();
+        }
+        detail::futex_wait(_seq, seq);
+        _waiting.store(0, std::memory_order_relaxed);
+        if( _ready() )
+            return true;
+    }
+}
+
+void shm_transport::notify(std::atomic<std::uint32_t>& _seq, std::atomic<std::uint32_t>& _waiting) noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if( _waiting.load(std::memory_order_relaxed) ) {
+        _seq.fetch_add(1, std::memory_order_release);
+        detail::futex_wake(_seq);
+    }
+}
+
+bool shm_transport::wait_data() const noexcept
+{
+    if( !region_ )
+        return false;
+    auto& h = *rx_.header;
+    return wait(h.data_seq, h.consumer_waiting, [this] { return readable() != 0; });
+}
+
+bool shm_transport::wait_space() const noexcept
+{
+    if( !region_ )
+        return false;
+    auto& h = *tx_.header;
+    return wait(h.space_seq, h.producer_waiting, [this, &h] {
+        return peer_closed() || h.head.load(std::memory_order_relaxed) - h.tail.load(std::memory_order_acquire) < capacity_;
+    });
+}
+
+/// Bytes in rx ring, clamped to capacity so corrupted peer head can't make reads overrun it.
+std::uint64_t shm_transport::readable() const noexcept
+{
+    auto& h = *rx_.header;
+    const std::uint64_t available = h.head.load(std::memory_order_acquire) - h.tail.load(std::memory_order_relaxed);
+    return available < capacity_ ? available : capacity_;
+}
+
+///                             IO
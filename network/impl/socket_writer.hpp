@@ -0,0 +1,185 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * @param _loop - loop owning attached sockets
+ * @param _high - per-socket send queue high watermark, writes above it close socket as slow consumer
+ * @param _low - per-socket send queue low watermark
+ */
+socket_writer::socket_writer(event_loop& _loop, std::size_t _high, std::size_t _low)
+    : loop_(_loop)
+    , high_(_high)
+    , low_(_low)
+{
+}
+
+/// Closes attached sockets, queued data is dropped.
+socket_writer::~socket_writer() noexcept
+{
+    for( auto& c : connections_ )
+        loop_.remove(c.first);
+}
+
+///                              Constructors
+
+
+///                             Loop thread
+
+/**
+ * Takes socket over, the loop watches it for reads and writes queued data
+ * @param _s - connected socket, it's switched to non-blocking mode
+ * @param _on_read - called on readability
+ * @param _on_close - called once socket is closed by close(), error or slow consumer
+ * @return handle, its socket is invalid if loop refused socket
+ */
+writer_handle socket_writer::attach(base_socket&& _s, socket_writer::read_handler_t _on_read,
+                                    socket_writer::close_handler_t _on_close)
+{
+    _s.non_blocking();
+    std::unique_ptr<connection> c(new connection(high_, low_));
+    c->generation = next_generation_++;
+    c->on_read = std::move(_on_read);
+    c->on_close = std::move(_on_close);
+    connection* raw = c.get();
+    const network::detail::socket_t s = _s.socket();
+    if( !loop_.add(s, event_loop::read, [this, raw](unsigned _events) { on_events(*raw, _events); }) )
+        return writer_handle();
+    c->s = std::move(_s);
+    connections_[s] = std::move(c);
+    return writer_handle { s, raw->generation };
+}
+
+/// If handle refers to attached socket, i.e. it wasn't closed since.
+bool socket_writer::contains(writer_handle _handle) const noexcept
+{
+    return find(_handle) != nullptr;
+}
+
+std::size_t socket_writer::size() const noexcept
+{
+    return connections_.size();
+}
+
+/// Bytes waiting for socket writability.
+std::size_t socket_writer::queued(writer_handle _handle) const noexcept
+{
+    const connection* c = find(_handle);
+    return c ? c->queue.size() : 0;
+}
+
+///                             Loop thread
+
+
+///                             Any thread
+
+/// Appends data to socket output, ignored if socket is already closed.
+void socket_writer::write(writer_handle _handle, std::vector<char>&& _data)
+{
+    operation op;
+    op.handle = _handle;
+    op.op = Op::Write;
+    op.data = std::move(_data);
+    submit(std::move(op));
+}
+
+/// Closes socket once data written before is sent.
+void socket_writer::close(writer_handle _handle)
+{
+    operation op;
+    op.handle = _handle;
+    op.op = Op::Close;
+    submit(std::move(op));
+}
+
+/// Queues operation, only the first one since the last drain costs a loop submission.
+void socket_writer::submit(socket_writer::operation&& _operation)
+{
+    operations_.push(std::move(_operation));
+    if( !scheduled_.exchange(true, std::memory_order_acq_rel) )
+        loop_.submit([this] { drain(); });
+}
+
+///                             Any thread
+
+
+///                             Applying
+
+void socket_writer::drain()
+{
+    // Reset before popping: later pushes either get popped below or schedule another drain.
+    // Read-modify-write, so pops can't be reordered before the reset.
+    scheduled_.exchange(false, std::memory_order_acq_rel);
+    operation op;
+    while( operations_.pop(op) )
+        apply(op);
+}
+
+void socket_writer::apply(socket_writer::operation& _operation)
+{
+    connection* c = find(_operation.handle);
+    if( !c || c->closing )
+        return;
+    if( _operation.op == Op::Close )
+        c->closing = true;
+    else if( !c->queue.push(std::move(_operation.data)) ) {
+        finish(*c);
+        return;
+    }
+    update(*c);
+}
+
+socket_writer::connection* socket_writer::find(writer_handle _handle) const noexcept
+{
+    auto it = connections_.find(_handle.s);
+    if( it == connections_.end() || it->second->generation != _handle.generation )
+        return nullptr;
+    return it->second.get();
+}
+
+void socket_writer::on_events(connection& _c, unsigned _events)
+{
+    const writer_handle handle { _c.s.socket(), _c.generation };
+    if( _events & event_loop::error ) {
+        finish(_c);
+        return;
+    }
+    if( _events & event_loop::write ) {
+        update(_c);
+        if( !find(handle) )
+            return;
+    }
+    if( (_events & event_loop::read) && _c.on_read )
+        _c.on_read(handle, _events);
+}
+
+/// Flushes queue and watches writability while data remains, closes socket if it's done.
+void socket_writer::update(connection& _c)
+{
+    if( !_c.queue.empty() && !_c.queue.flush(_c.s) ) {
+        finish(_c);
+        return;
+    }
+    if( _c.closing && _c.queue.empty() ) {
+        finish(_c);
+        return;
+    }
+    const unsigned events = event_loop::read | (_c.queue.empty() ? event_loop::none : event_loop::write);
+    if( events != _c.events ) {
+        _c.events = events;
+        loop_.modify(_c.s.socket(), events);
+    }
+}
+
+void socket_writer::finish(connection& _c)
+{
+    const writer_handle handle { _c.s.socket(), _c.generation };
+    close_handler_t on_close = std::move(_c.on_close);
+    loop_.remove(handle.s);
+    connections_.erase(handle.s);
+    if( on_close )
+        on_close(handle);
+}
+
+///                             Applying
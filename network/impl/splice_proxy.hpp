@@ -0,0 +1,292 @@
+#pragma once
+
+
+namespace detail {
+
+/// If process ignores SIGPIPE, i.e. writes to broken connections can't kill it.
+inline bool sigpipe_ignored() noexcept
+{
+    struct sigaction action { };
+    return ::sigaction(SIGPIPE, nullptr, &action) == GOOD && action.sa_handler == SIG_IGN;
+}
+
+/**
+ * splice which reports broken connection by EPIPE only, splice has no MSG_NOSIGNAL
+ * SIGPIPE is blocked around the call and the one it raised is consumed, signal pending
+ * before the call is left for its owner.
+ */
+inline ssize_t splice_nosignal(int _in, int _out, std::size_t _length, unsigned _flags) noexcept
+{
+    sigset_t sigpipe;
+    sigset_t pending;
+    sigset_t old;
+    sigemptyset(&sigpipe);
+    sigaddset(&sigpipe, SIGPIPE);
+    sigpending(&pending);
+    const bool was_pending = sigismember(&pending, SIGPIPE) == 1;
+    ::pthread_sigmask(SIG_BLOCK, &sigpipe, &old);
+    const ssize_t size = ::splice(_in, nullptr, _out, nullptr, _length, _flags);
+    const int error = errno;
+    if( size == -1 && error == EPIPE && !was_pending ) {
+        const timespec zero { 0, 0 };
+        while( ::sigtimedwait(&sigpipe, nullptr, &zero) == -1 && errno == EINTR ) {
+        }
+    }
+    ::pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    errno = error;
+    return size;
+}
+
+} // namespace detail
+
+
+///                              Constructors
+
+/**
+ * @param _loop - loop running the proxy
+ * @param _a - connected socket, e.g. accepted client
+ * @param _b - connected socket, e.g. upstream
+ * @param _idle_timeout - proxy closes after this long without data in either direction, 0 disables it
+ * @param _pipe_size - per-direction pipe capacity (F_SETPIPE_SZ), i.e. bytes in flight
+ */
+splice_proxy::splice_proxy(event_loop& _loop, base_socket&& _a, base_socket&& _b,
+                           std::chrono::milliseconds _idle_timeout, std::size_t _pipe_size)
+    : loop_(_loop)
+    , a_(std::move(_a))
+    , b_(std::move(_b))
+    , idle_timeout_(_idle_timeout)
+    , pipe_size_(_pipe_size)
+{
+    forward_.from = backward_.to = a_.socket();
+    forward_.to = backward_.from = b_.socket();
+}
+
+/// Closes sockets without invoking close handler.
+splice_proxy::~splice_proxy() noexcept
+{
+    release();
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+/// Bytes delivered from a to b.
+std::uint64_t splice_proxy::a_to_b() const noexcept
+{
+    return forward_.forwarded;
+}
+
+/// Bytes delivered from b to a.
+std::uint64_t splice_proxy::b_to_a() const noexcept
+{
+    return backward_.forwarded;
+}
+
+bool splice_proxy::running() const noexcept
+{
+    return running_;
+}
+
+/// If proxy was closed by idle timeout.
+bool splice_proxy::timed_out() const noexcept
+{
+    return timed_out_;
+}
+
+/// Error (errno) which closed proxy, 0 if it closed normally.
+int splice_proxy::error() const noexcept
+{
+    return error_;
+}
+
+void splice_proxy::on_close(splice_proxy::close_handler_t _handler)
+{
+    on_close_ = std::move(_handler);
+}
+
+///                             Properties
+
+
+///                             Running
+
+/// Starts relaying, false if pipes can't be created or loop refused sockets.
+bool splice_proxy::start()
+{
+    if( running_ || a_.socket() == network::detail::invalid_socket || b_.socket() == network::detail::invalid_socket )
+        return false;
+    if( !a_.non_blocking() || !b_.non_blocking() )
+        return false;
+    for( direction* d : { &forward_, &backward_ } ) {
+        if( ::pipe2(d->pipe, O_NONBLOCK | O_CLOEXEC) != GOOD ) {
+            release();
+            return false;
+        }
+        if( pipe_size_ != default_pipe_size )
+            ::fcntl(d->pipe[1], F_SETPIPE_SZ, (int)pipe_size_);
+    }
+    guard_sigpipe_ = !network::detail::sigpipe_ignored();
+    running_ = true;
+    last_activity_ = event_loop::clock_t::now();
+    update();
+    if( !a_events_ || !b_events_ ) {
+        release();
+        return false;
+    }
+    if( idle_timeout_.count() > 0 )
+        arm_idle_timer(idle_timeout_);
+    return true;
+}
+
+/// Stops relaying and closes both sockets, invokes close handler.
+void splice_proxy::close()
+{
+    if( !running_ )
+        return;
+    release();
+    close_handler_t handler = std::move(on_close_);
+    if( handler )
+        handler();
+}
+
+void splice_proxy::release() noexcept
+{
+    running_ = false;
+    if( a_events_ )
+        loop_.remove(a_.socket());
+    if( b_events_ )
+        loop_.remove(b_.socket());
+    a_events_ = b_events_ = event_loop::none;
+    loop_.cancel_timer(idle_timer_);
+    for( direction* d : { &forward_, &backward_ } ) {
+        for( int& fd : d->pipe ) {
+            if( fd != -1 )
+                ::close(fd);
+            fd = -1;
+        }
+        d->pending = 0;
+    }
+    a_ = base_socket();
+    b_ = base_socket();
+}
+
+/**
+ * Moves data of one direction until sockets would block
+ * Socket is read only when pipe is empty, so EAGAIN of either splice tells which socket to wait for.
+ * @return false on socket error
+ */
+bool splice_proxy::pump(direction& _d)
+{
+    const unsigned flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+    for( ;; ) {
+        ssize_t size;
+        if( _d.pending ) {
+            size = guard_sigpipe_ ? network::detail::splice_nosignal(_d.pipe[0], _d.to, _d.pending, flags)
+                                  : ::splice(_d.pipe[0], nullptr, _d.to, nullptr, _d.pending, flags);
+            if( size > 0 ) {
+                _d.pending -= (std::size_t)size;
+                _d.forwarded += (std::uint64_t)size;
+                last_activity_ = event_loop::clock_t::now();
+                continue;
+            }
+        }
+        else if( !_d.eof ) {
+            size = ::splice(_d.from, nullptr, _d.pipe[1], nullptr, pipe_size_, flags);
+            if( size > 0 ) {
+                _d.pending += (std::size_t)size;
+                continue;
+            }
+            if( size == 0 )
+                _d.eof = true;
+        }
+        else
+            break;
+
+        if( size == -1 ) {
+            const int err = network::detail::last_error();
+            if( err == EINTR )
+                continue;
+            if( !network::detail::would_block(err) ) {
+                error_ = err;
+                return false;
+            }
+        }
+        break;
+    }
+    // Half-close: peer of _d.from finished sending and everything reached _d.to.
+    if( _d.eof && !_d.pending && !_d.shut ) {
+        ::shutdown(_d.to, SHUT_WR);
+        _d.shut = true;
+    }
+    return true;
+}
+
+void splice_proxy::on_events(network::detail::socket_t _s, unsigned _events)
+{
+    if( _events & event_loop::error ) {
+        int err = 0;
+        socklen_t size = sizeof(err);
+        ::getsockopt(_s, SOL_SOCKET, SO_ERROR, &err, &size);
+        if( err ) {
+            error_ = err;
+            close();
+            return;
+        }
+    }
+    if( !pump(forward_) || !pump(backward_) ) {
+        close();
+        return;
+    }
+    if( forward_.shut && backward_.shut ) {
+        close();
+        return;
+    }
+    update();
+}
+
+/// Events socket waits for: read while its pipe is empty, write while the other pipe holds data.
+unsigned splice_proxy::interest(network::detail::socket_t _s) const noexcept
+{
+    const direction& out = _s == forward_.from ? forward_ : backward_;
+    const direction& in = _s == forward_.from ? backward_ : forward_;
+    return (!out.eof && !out.pending ? event_loop::read : event_loop::none)
+         | (in.pending ? event_loop::write : event_loop::none);
+}
+
+/// Applies interest, socket without any is removed from loop since hangup is reported regardless.
+void splice_proxy::update()
+{
+    for( int i = 0; i < 2; ++i ) {
+        const network::detail::socket_t s = i ? b_.socket() : a_.socket();
+        unsigned& current = i ? b_events_ : a_events_;
+        const unsigned events = interest(s);
+        if( events == current )
+            continue;
+        if( !events )
+            loop_.remove(s);
+        else if( !current ) {
+            if( !loop_.add(s, events, [this, s](unsigned _events) { on_events(s, _events); }) )
+                continue;
+        }
+        else
+            loop_.modify(s, events);
+        current = events;
+    }
+}
+
+void splice_proxy::arm_idle_timer(std::chrono::milliseconds _delay)
+{
+    idle_timer_ = loop_.add_timer(_delay, [this] {
+        const auto idle = event_loop::clock_t::now() - last_activity_;
+        if( idle >= idle_timeout_ ) {
+            timed_out_ = true;
+            close();
+            return;
+        }
+        arm_idle_timer(std::chrono::duration_cast<std::chrono::milliseconds>(idle_timeout_ - idle)
+                       + std::chrono::milliseconds(1));
+    });
+}
+
+///                             Running
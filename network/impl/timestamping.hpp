@@ -0,0 +1,163 @@
+#pragma once
+
+
+namespace detail {
+
+const std::size_t timestamping_control_size = 256;
+
+inline std::chrono::nanoseconds to_nanoseconds(const timespec& _ts) noexcept
+{
+    return std::chrono::nanoseconds((long long)_ts.tv_sec * 1000000000ll + _ts.tv_nsec);
+}
+
+/// Fills software and hardware timestamps from SCM_TIMESTAMPING, false if there is none.
+inline bool parse_timestamping(msghdr& _msg, std::chrono::nanoseconds& _software, std::chrono::nanoseconds& _hardware) noexcept
+{
+    for( cmsghdr* c = CMSG_FIRSTHDR(&_msg); c; c = CMSG_NXTHDR(&_msg, c) ) {
+        if( c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPING ) {
+            scm_timestamping ts;
+            memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            _software = to_nanoseconds(ts.ts[0]);
+            _hardware = to_nanoseconds(ts.ts[2]);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace detail
+
+
+/// Now by CLOCK_REALTIME, the clock of software timestamps.
+std::chrono::nanoseconds realtime_now() noexcept
+{
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME, &ts);
+    return network::detail::to_nanoseconds(ts);
+}
+
+std::chrono::nanoseconds packet_timestamps::age() const noexcept
+{
+    return software.count() ? realtime_now() - software : std::chrono::nanoseconds(0);
+}
+
+/// Records how long received data waited in the socket, skipped if software timestamp is absent.
+void record_age(latency_histogram& _histogram, const packet_timestamps& _timestamps) noexcept
+{
+    if( _timestamps.software.count() )
+        _histogram.record(_timestamps.age());
+}
+
+
+///                             Enabling
+
+/**
+ * Enables SO_TIMESTAMPING on socket
+ * @param _s - socket
+ * @param _flags - timestamp flag sets, e.g. timestamp::software_rx | timestamp::software_tx
+ * @return false if kernel rejected flags
+ */
+bool enable_timestamping(network::detail::socket_t _s, unsigned _flags) noexcept
+{
+    return ::setsockopt(_s, SOL_SOCKET, SO_TIMESTAMPING, &_flags, sizeof(_flags)) == 0;
+}
+
+bool enable_timestamping(network::detail::socket_t _s, unsigned _flags, network::error& _error) noexcept
+{
+    return network::detail::set_error(enable_timestamping(_s, _flags), _error);
+}
+
+/**
+ * Turns on NIC timestamping (SIOCSHWTSTAMP), it's device-wide and requires CAP_NET_ADMIN
+ * @param _s - any socket, used for ioctl
+ * @param _interface - interface name
+ * @param _tx - timestamp outgoing packets
+ * @param _rx - timestamp all incoming packets
+ * @return false if NIC doesn't support it or it is not permitted
+ */
+bool enable_hardware_timestamping(network::detail::socket_t _s, const char* _interface, bool _tx, bool _rx) noexcept
+{
+    hwtstamp_config config { };
+    config.tx_type = _tx ? HWTSTAMP_TX_ON : HWTSTAMP_TX_OFF;
+    config.rx_filter = _rx ? HWTSTAMP_FILTER_ALL : HWTSTAMP_FILTER_NONE;
+    ifreq request { };
+    strncpy(request.ifr_name, _interface, sizeof(request.ifr_name) - 1);
+    request.ifr_data = reinterpret_cast<char*>(&config);
+    return ::ioctl(_s, SIOCSHWTSTAMP, &request) == 0;
+}
+
+///                             Enabling
+
+
+///                             Reading
+
+/**
+ * Receives data with kernel rx timestamps of (the first packet of) it
+ * @param _s - socket with rx timestamping enabled
+ * @param _buff - buffer
+ * @param _length - buffer length
+ * @param _timestamps - timestamps, zero if kernel reported none
+ * @param _flags - recv flags
+ * @return received bytes count, 0 on shutdown, -1 on error
+ */
+long long read_with_timestamps(network::detail::socket_t _s, char* _buff, std::size_t _length,
+                               packet_timestamps& _timestamps, int _flags) noexcept
+{
+    iovec iov { _buff, _length };
+    alignas(cmsghdr) char control[network::detail::timestamping_control_size];
+    msghdr msg { };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    long long size = ::recvmsg(_s, &msg, _flags);
+    _timestamps = packet_timestamps();
+    if( size > 0 )
+        network::detail::parse_timestamping(msg, _timestamps.software, _timestamps.hardware);
+    return size;
+}
+
+/**
+ * Drains tx timestamps from socket error queue without blocking
+ * @param _s - socket with tx timestamping enabled
+ * @param _timestamps - timestamps are appended to it
+ * @return appended timestamps count, -1 on error
+ * Error queue readiness is reported as error event (event_loop::error).
+ */
+long long read_tx_timestamps(network::detail::socket_t _s, std::vector<tx_timestamp>& _timestamps)
+{
+    long long count = 0;
+    for( ;; ) {
+        alignas(cmsghdr) char control[network::detail::timestamping_control_size];
+        msghdr msg { };
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if( ::recvmsg(_s, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1 ) {
+            const int err = network::detail::last_error();
+            return network::detail::would_block(err) ? count : -1;
+        }
+
+        tx_timestamp ts;
+        bool has_timestamp = network::detail::parse_timestamping(msg, ts.software, ts.hardware);
+        bool has_id = false;
+        for( cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c) ) {
+            if( (c->cmsg_level == IPPROTO_IP && c->cmsg_type == IP_RECVERR)
+                || (c->cmsg_level == IPPROTO_IPV6 && c->cmsg_type == IPV6_RECVERR) ) {
+                sock_extended_err err;
+                memcpy(&err, CMSG_DATA(c), sizeof(err));
+                if( err.ee_errno == ENOMSG && err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING ) {
+                    ts.id = err.ee_data;
+                    ts.type = static_cast<timestamp::Type>(err.ee_info);
+                    has_id = true;
+                }
+            }
+        }
+        if( has_timestamp && has_id ) {
+            _timestamps.push_back(ts);
+            ++count;
+        }
+    }
+}
+
+///                             Reading
@@ -10,10 +10,10 @@ class address
 public:
     /// @see Constructors
     address() noexcept = default;
-    address(address_v4&& _v4) noexcept;
-    address(address_v6&& _v6) noexcept;
-    address(const address_v4& _v4) noexcept;
-    address(const address_v6& _v6) noexcept;
+    constexpr address(address_v4&& _v4) noexcept;
+    constexpr address(address_v6&& _v6) noexcept;
+    constexpr address(const address_v4& _v4) noexcept;
+    constexpr address(const address_v6& _v6) noexcept;
     address(address&& _other) noexcept = default;
     address(const address& _other) noexcept = default;
 
@@ -26,10 +26,11 @@ public:
     address& operator=(const address& _other) noexcept = default;
 
     /// @see Properties
-    bool is_v4() const noexcept;
+    constexpr bool is_v4() const noexcept;
     bool is_loopback() const noexcept;
-    address_v4 v4() const noexcept;
-    address_v6 v6() const noexcept;
+    bool is_multicast() const noexcept;
+    constexpr address_v4 v4() const noexcept;
+    constexpr address_v6 v6() const noexcept;
 
     /// @see Conversions
     std::string to_string() const;
@@ -43,12 +44,12 @@ private:
 namespace detail {
 
 // TODO : BIDLOCODE!
-network::ip::address to_address(const char* _saddr, network::error* _error = nullptr) noexcept;
+constexpr network::ip::address to_address(const char* _saddr, network::error* _error = nullptr) noexcept;
 
 } // namespace detail
 
-network::ip::address to_address(const char* _saddr) noexcept;
-network::ip::address to_address(const char* _saddr, network::error& _error) noexcept;
+constexpr network::ip::address to_address(const char* _saddr) noexcept;
+constexpr network::ip::address to_address(const char* _saddr, network::error& _error) noexcept;
 network::ip::address to_address(const std::string& _saddr) noexcept;
 network::ip::address to_address(const std::string& _saddr, network::error& _error) noexcept;
 
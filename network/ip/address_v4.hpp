@@ -41,8 +41,8 @@ public:
 
     /// @see Constructors
     address_v4() noexcept = default;
-    explicit address_v4(addr_t _addr) noexcept;
-    explicit address_v4(uint_t _uint) noexcept;
+    constexpr explicit address_v4(addr_t _addr) noexcept;
+    constexpr explicit address_v4(uint_t _uint) noexcept;
     explicit address_v4(const byte_t& _bytes) noexcept;
     address_v4(address_v4&& _other) noexcept = default;
     address_v4(const address_v4& _other) noexcept = default;
@@ -60,7 +60,7 @@ public:
     std::string to_string() const;
 
     /// @see Properties
-    addr_t addr() const noexcept;
+    constexpr addr_t addr() const noexcept;
     bool is_unicast() const noexcept;
     bool is_multicast() const noexcept;
     bool is_broadcast() const noexcept;
@@ -85,12 +85,13 @@ private:
 
 namespace detail {
 
-network::ip::address_v4 to_address_v4(const char* _saddr, network::error* _error = nullptr) noexcept;
+constexpr bool parse_address_v4(const char* _saddr, std::size_t _length, std::uint32_t& _host) noexcept;
+constexpr network::ip::address_v4 to_address_v4(const char* _saddr, network::error* _error = nullptr) noexcept;
 
 } // namespace detail
 
-address_v4 to_address_v4(const char* _saddr) noexcept;
-address_v4 to_address_v4(const char* _saddr, network::error& _error) noexcept;
+constexpr address_v4 to_address_v4(const char* _saddr) noexcept;
+constexpr address_v4 to_address_v4(const char* _saddr, network::error& _error) noexcept;
 address_v4 to_address_v4(const std::string& _saddr) noexcept;
 address_v4 to_address_v4(const std::string& _saddr, network::error& _error) noexcept;
 
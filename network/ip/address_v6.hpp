@@ -1,5 +1,8 @@
 #pragma once
+#include "address_v4.hpp"
 #include "../detail/common.hpp"
+
+#include <array>
 #include <string>
 
 namespace network {
@@ -15,7 +18,7 @@ public:
 
     /// @see Constructors
     address_v6() noexcept = default;
-    explicit address_v6(addr_t _addr, scope_id_t _scope_id = 0) noexcept;
+    constexpr explicit address_v6(addr_t _addr, scope_id_t _scope_id = 0) noexcept;
     explicit address_v6(const byte_t& _bytes, scope_id_t _scope_id = 0) noexcept;
     address_v6(address_v6&& _other) noexcept = default;
     address_v6(const address_v6& _other) noexcept = default;
@@ -29,9 +32,10 @@ public:
     std::string to_string() const;
 
     /// @see Properties
-    addr_t addr() const noexcept;
-    scope_id_t scope_id() const noexcept;
+    constexpr addr_t addr() const noexcept;
+    constexpr scope_id_t scope_id() const noexcept;
     bool is_loopback() const noexcept;
+    bool is_multicast() const noexcept;
 
     /// @see Comparison operators
     friend bool operator==(const address_v6& _a, const address_v6& _b) noexcept;
@@ -50,17 +54,18 @@ private:
 
 namespace detail {
 
-network::ip::address_v6 to_address_v6(const char* _saddr, network::error* _error = nullptr) noexcept;
+constexpr bool parse_address_v6(const char* _saddr, std::size_t _length, network::detail::in6_addr_t& _addr) noexcept;
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr, network::error* _error = nullptr) noexcept;
 
 } // namespace detail
 
-network::ip::address_v6 to_address_v6(const char* _saddr) noexcept;
-network::ip::address_v6 to_address_v6(const char* _saddr, network::error& _error) noexcept;
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr) noexcept;
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr, network::error& _error) noexcept;
 network::ip::address_v6 to_address_v6(const std::string& _saddr) noexcept;
 network::ip::address_v6 to_address_v6(const std::string& _saddr, network::error& _error) noexcept;
 
 template<class _CharT, class _Traits>
-std::basic_ostream<_CharT, _Traits>& operator<<(std::basic_ostream<_CharT, _Traits>& _os, const address_v4& _address);
+std::basic_ostream<_CharT, _Traits>& operator<<(std::basic_ostream<_CharT, _Traits>& _os, const address_v6& _address);
 
 #include "impl/address_v6.hpp"
 
@@ -0,0 +1,179 @@
+#pragma once
+#include "endpoint.hpp"
+#include "internet_protocol.hpp"
+
+#include <functional>
+
+namespace network {
+namespace ip {
+
+namespace detail {
+
+template<class _InternetProtocol>
+struct endpoint_traits;
+
+template<>
+struct endpoint_traits<ipv4>
+{
+    typedef network::detail::sockaddr_in4_t sockaddr_type;
+    typedef address_v4 address_type;
+
+    static void assign(sockaddr_type& _sa, const address_type& _addr) noexcept
+    {
+        _sa.sin_addr = _addr.addr();
+    }
+
+    static address_type address(const sockaddr_type& _sa) noexcept
+    {
+        return address_type(_sa.sin_addr);
+    }
+
+    static unsigned short& port(sockaddr_type& _sa) noexcept
+    {
+        return _sa.sin_port;
+    }
+
+    static unsigned short port(const sockaddr_type& _sa) noexcept
+    {
+        return _sa.sin_port;
+    }
+};
+
+template<>
+struct endpoint_traits<ipv6>
+{
+    typedef network::detail::sockaddr_in6_t sockaddr_type;
+    typedef address_v6 address_type;
+
+    static void assign(sockaddr_type& _sa, const address_type& _addr) noexcept
+    {
+        _sa.sin6_addr = _addr.addr();
+        _sa.sin6_scope_id = _addr.scope_id();
+    }
+
+    static address_type address(const sockaddr_type& _sa) noexcept
+    {
+        return address_type(_sa.sin6_addr, _sa.sin6_scope_id);
+    }
+
+    static unsigned short& port(sockaddr_type& _sa) noexcept
+    {
+        return _sa.sin6_port;
+    }
+
+    static unsigned short port(const sockaddr_type& _sa) noexcept
+    {
+        return _sa.sin6_port;
+    }
+};
+
+} // namespace detail
+
+/// @class basic_endpoint
+/**
+ * Endpoint of protocol family known at compile time
+ * Unlike endpoint it stores only family sockaddr (sockaddr_in for ipv4) and
+ * resolves size, port and address access without runtime family checks.
+ * @param Threadsafe - no threadsafe
+ * @throw any std::string exceptions in to_string() function
+ */
+template<class _InternetProtocol>
+class basic_endpoint
+{
+    typedef detail::endpoint_traits<_InternetProtocol> traits_t;
+public:
+    typedef _InternetProtocol protocol_type;
+    typedef typename traits_t::address_type address_type;
+    typedef typename traits_t::sockaddr_type sockaddr_type;
+
+    /// @see Constructors
+    constexpr basic_endpoint() noexcept;
+    constexpr basic_endpoint(const address_type& _addr, unsigned short _port = 0) noexcept;
+    explicit basic_endpoint(const endpoint& _ep) noexcept;
+    basic_endpoint(basic_endpoint&& _other) noexcept = default;
+    basic_endpoint(const basic_endpoint& _other) noexcept = default;
+
+    /// @see Assign operators
+    basic_endpoint& operator=(basic_endpoint&& _other) noexcept = default;
+    basic_endpoint& operator=(const basic_endpoint& _other) noexcept = default;
+
+    /// @see Properties
+    static constexpr bool is_v4() noexcept;
+    static constexpr std::size_t size() noexcept;
+    static constexpr std::size_t capacity() noexcept;
+    unsigned short port() const noexcept;
+    void port(unsigned short _port) noexcept;
+    network::detail::sockaddr_t* sockaddr_ptr() noexcept;
+    const network::detail::sockaddr_t* sockaddr_ptr() const noexcept;
+    operator network::detail::sockaddr_t*() noexcept;
+    operator const network::detail::sockaddr_t*() const noexcept;
+
+    /// @see Conversions
+    std::string to_string() const;
+    address_type to_address() const noexcept;
+    endpoint to_endpoint() const noexcept;
+
+    /// @see Comparison operators
+    template<class _P>
+    friend bool operator==(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept;
+    template<class _P>
+    friend bool operator<(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept;
+
+private:
+    sockaddr_type data_ { };
+};
+
+using endpoint_v4 = basic_endpoint<ipv4>;
+using endpoint_v6 = basic_endpoint<ipv6>;
+
+namespace detail {
+
+/// Endpoint type sockets of protocol use: family-specialized if family is known at compile time.
+template<class _InternetProtocol>
+struct protocol_endpoint
+{
+    typedef network::ip::endpoint type;
+};
+
+template<>
+struct protocol_endpoint<ipv4>
+{
+    typedef network::ip::endpoint_v4 type;
+};
+
+template<>
+struct protocol_endpoint<ipv6>
+{
+    typedef network::ip::endpoint_v6 type;
+};
+
+} // namespace detail
+
+template<class _P>
+bool operator!=(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept;
+
+template<class _CharT, class _Traits, class _P>
+std::basic_ostream<_CharT, _Traits>& operator<<(std::basic_ostream<_CharT, _Traits>& _os, const basic_endpoint<_P>& _ep);
+
+#include "impl/basic_endpoint.hpp"
+
+} // namespace ip
+} // namespace network
+
+namespace std {
+
+/// Hash for flow tables keyed by endpoint.
+template<class _InternetProtocol>
+struct hash<network::ip::basic_endpoint<_InternetProtocol>>
+{
+    std::size_t operator()(const network::ip::basic_endpoint<_InternetProtocol>& _ep) const noexcept
+    {
+        const auto bytes = _ep.to_address().to_bytes();
+        std::size_t h = 14695981039346656037ull;
+        for( unsigned char b : bytes )
+            h = (h ^ b) * 1099511628211ull;
+        return (h ^ _ep.port()) * 1099511628211ull;
+    }
+};
+
+} // namespace std
@@ -0,0 +1,123 @@
+#pragma once
+#include "basic_endpoint.hpp"
+
+#include <vector>
+
+namespace network {
+namespace ip {
+
+namespace detail {
+
+template<class _InternetProtocol>
+struct packet_info_traits;
+
+template<>
+struct packet_info_traits<ipv4>
+{
+#if defined(IP_PKTINFO)
+    typedef in_pktinfo info_type;
+    static const int level = IPPROTO_IP;
+    static const int type = IP_PKTINFO;
+    static const int option = IP_PKTINFO;
+
+    static address_v4 destination(const info_type& _info) noexcept
+    {
+        return address_v4(_info.ipi_addr);
+    }
+#else
+    typedef in_addr info_type;
+    static const int level = IPPROTO_IP;
+    static const int type = IP_RECVDSTADDR;
+    static const int option = IP_RECVDSTADDR;
+
+    static address_v4 destination(const info_type& _info) noexcept
+    {
+        return address_v4(_info);
+    }
+#endif
+};
+
+template<>
+struct packet_info_traits<ipv6>
+{
+    typedef in6_pktinfo info_type;
+    static const int level = IPPROTO_IPV6;
+    static const int type = IPV6_PKTINFO;
+    static const int option = IPV6_RECVPKTINFO;
+
+    static address_v6 destination(const info_type& _info) noexcept
+    {
+        return address_v6(_info.ipi6_addr);
+    }
+};
+
+} // namespace detail
+
+/// @class datagram_batch
+/**
+ * Preallocated buffers for receiving many datagrams per syscall (recvmmsg on Linux)
+ * @param Threadsafe - no threadsafe
+ * Besides payload and source each datagram carries its destination address if socket
+ * has packet info enabled, e.g. to tell multicast groups sharing one socket apart.
+ * Datagrams stay valid until the next receive.
+ */
+template<class _InternetProtocol>
+class datagram_batch
+{
+    typedef detail::packet_info_traits<_InternetProtocol> traits_t;
+public:
+    typedef basic_endpoint<_InternetProtocol> endpoint_type;
+    typedef typename endpoint_type::address_type address_type;
+
+    static const std::size_t default_count = 64;
+    static const std::size_t default_datagram_size = 2048;
+
+    /// @see Constructors
+    explicit datagram_batch(std::size_t _count = default_count, std::size_t _datagram_size = default_datagram_size);
+    datagram_batch(const datagram_batch& _other) = delete;
+    datagram_batch& operator=(const datagram_batch& _other) = delete;
+
+    /// @see Properties
+    std::size_t capacity() const noexcept;
+    std::size_t datagram_size() const noexcept;
+    std::size_t size() const noexcept;
+
+    /// @see Datagrams
+    const char* data(std::size_t _i) const noexcept;
+    std::size_t length(std::size_t _i) const noexcept;
+    bool truncated(std::size_t _i) const noexcept;
+    const endpoint_type& source(std::size_t _i) const noexcept;
+    const address_type& destination(std::size_t _i) const noexcept;
+
+    /// @see Receiving
+    long long receive(network::detail::socket_t _s, int _flags = 0);
+
+    /// @see Static
+    static bool enable_packet_info(network::detail::socket_t _s) noexcept;
+
+private:
+    static const std::size_t control_size = 64;
+
+    void prepare(std::size_t _i) noexcept;
+    void complete(std::size_t _i, std::size_t _length) noexcept;
+
+    std::size_t datagram_size_;
+    std::size_t size_ { };
+    std::vector<char> buffers_;
+    std::vector<char> control_;
+    std::vector<endpoint_type> sources_;
+    std::vector<address_type> destinations_;
+    std::vector<std::size_t> lengths_;
+    std::vector<bool> truncated_;
+    std::vector<iovec> iov_;
+#if defined(__linux__)
+    std::vector<mmsghdr> headers_;
+#else
+    std::vector<msghdr> headers_;
+#endif
+};
+
+#include "impl/datagram_batch.hpp"
+
+} // namespace ip
+} // namespace network
@@ -8,8 +8,8 @@ class endpoint
 {
 public:
     /// @see Constructors
-    endpoint() noexcept;
-    endpoint(const address& _addr, unsigned short _port = 0) noexcept;
+    constexpr endpoint() noexcept;
+    constexpr endpoint(const address& _addr, unsigned short _port = 0) noexcept;
     endpoint(endpoint&& _other) noexcept = default;
     endpoint(const endpoint& _other) noexcept = default;
 
@@ -33,14 +33,39 @@ public:
     address to_address() const noexcept;
 
 private:
-    union {
+    union storage
+    {
         network::detail::family_t base;
         network::detail::sockaddr_in4_t v4;
         network::detail::sockaddr_in6_t v6;
-    } data_ { };
+
+        constexpr storage(const network::detail::sockaddr_in4_t& _v4) noexcept
+            : v4(_v4)
+        {
+        }
+
+        constexpr storage(const network::detail::sockaddr_in6_t& _v6) noexcept
+            : v6(_v6)
+        {
+        }
+    } data_;
     bool is_v4_ { true };
 };
 
+namespace detail {
+
+constexpr network::detail::sockaddr_in4_t make_sockaddr(const address_v4& _addr, unsigned short _port) noexcept;
+constexpr network::detail::sockaddr_in6_t make_sockaddr(const address_v6& _addr, unsigned short _port) noexcept;
+constexpr bool parse_endpoint(const char* _sep, std::size_t _length, address& _addr, unsigned short& _port) noexcept;
+constexpr network::ip::endpoint to_endpoint(const char* _sep, network::error* _error = nullptr) noexcept;
+
+} // namespace detail
+
+constexpr endpoint to_endpoint(const char* _sep) noexcept;
+constexpr endpoint to_endpoint(const char* _sep, network::error& _error) noexcept;
+endpoint to_endpoint(const std::string& _sep) noexcept;
+endpoint to_endpoint(const std::string& _sep, network::error& _error) noexcept;
+
 
 #include "impl/endpoint.hpp"
 
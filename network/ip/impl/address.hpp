@@ -3,23 +3,23 @@
 
 ///                              Constructors
 
-address::address(address_v4&& _v4) noexcept
+constexpr address::address(address_v4&& _v4) noexcept
     : v4_(std::move(_v4))
 {
 }
 
-address::address(address_v6&& _v6) noexcept
+constexpr address::address(address_v6&& _v6) noexcept
     : v6_(std::move(_v6))
     , is_v4_(false)
 {
 }
 
-address::address(const address_v4& _v4) noexcept
+constexpr address::address(const address_v4& _v4) noexcept
     : v4_(_v4)
 {
 }
 
-address::address(const address_v6& _v6) noexcept
+constexpr address::address(const address_v6& _v6) noexcept
     : v6_(_v6)
     , is_v4_(false)
 {
@@ -75,7 +75,7 @@ std::string address::to_string() const
 ///                             Properties
 
 /// Is address ipv4.
-bool address::is_v4() const noexcept
+constexpr bool address::is_v4() const noexcept
 {
     return is_v4_;
 }
@@ -86,13 +86,18 @@ bool address::is_loopback() const noexcept
     return is_v4_ ? v4_.is_loopback() : v6_.is_loopback();
 }
 
+bool address::is_multicast() const noexcept
+{
+    return is_v4_ ? v4_.is_multicast() : v6_.is_multicast();
+}
+
 
-address_v4 address::v4() const noexcept
+constexpr address_v4 address::v4() const noexcept
 {
     return v4_;
 }
 
-address_v6 address::v6() const noexcept
+constexpr address_v6 address::v6() const noexcept
 {
     return v6_;
 }
@@ -108,29 +113,20 @@ namespace detail {
  * @param _error - slot for error handling(by default nullptr)
  * @return cstring address address class representation
  */
-network::ip::address to_address(const char* _saddr, network::error* _error) noexcept
-{
-    network::detail::in4_addr_t in4_addr;
-    int tmp = inet_pton(AF_INET, _saddr, &in4_addr);
-    if( tmp != 1 ) {
-        network::detail::in6_addr_t in6_addr;
-        tmp = inet_pton(AF_INET6, _saddr, &in6_addr);
-        if( tmp != 1 ) {
-            if( _error )
-                _error->value = network::detail::last_error();
-        }
-        else {
-            if( _error )
-                _error->value = NO_ERROR;
-            return network::ip::address_v6(in6_addr);
-        }
-    }
-    else {
+constexpr network::ip::address to_address(const char* _saddr, network::error* _error) noexcept
+{
+    const std::size_t length = network::detail::length(_saddr);
+    std::uint32_t host = 0;
+    if( parse_address_v4(_saddr, length, host) ) {
         if( _error )
             _error->value = NO_ERROR;
-        return network::ip::address_v4(in4_addr);
+        return network::ip::address_v4((address_v4::uint_t)host);
     }
-    return { };
+    network::detail::in6_addr_t addr { };
+    const bool parsed = parse_address_v6(_saddr, length, addr);
+    if( _error )
+        _error->value = parsed ? NO_ERROR : EINVAL;
+    return parsed ? network::ip::address(network::ip::address_v6(addr)) : network::ip::address();
 }
 
 } // namespace detail
@@ -140,7 +136,7 @@ network::ip::address to_address(const char* _saddr, network::error* _error) noex
  * @param _saddr - cstring ipv4/ipv6 address
  * @return cstring ipv4/ipv6 address address representation
  */
-network::ip::address to_address(const char* _saddr) noexcept
+constexpr network::ip::address to_address(const char* _saddr) noexcept
 {
     return network::ip::detail::to_address(_saddr);
 }
@@ -151,7 +147,7 @@ network::ip::address to_address(const char* _saddr) noexcept
  * @param _error - slot for error handling
  * @return cstring ipv4/ipv6 address address representation
  */
-network::ip::address to_address(const char* _saddr, network::error& _error) noexcept
+constexpr network::ip::address to_address(const char* _saddr, network::error& _error) noexcept
 {
     return network::ip::detail::to_address(_saddr, &_error);
 }
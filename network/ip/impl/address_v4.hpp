@@ -2,15 +2,15 @@
 
 ///                              Constructors
 
-address_v4::address_v4(address_v4::addr_t _addr) noexcept
+constexpr address_v4::address_v4(address_v4::addr_t _addr) noexcept
     : addr_(_addr)
 {
 }
 
 /// Creates address from uint in a host byte order.
-address_v4::address_v4(address_v4::uint_t _uint) noexcept
+constexpr address_v4::address_v4(address_v4::uint_t _uint) noexcept
+    : addr_(network::detail::make_in4_addr((std::uint32_t)_uint))
 {
-    addr_.s_addr = _uint;
 }
 
 /// Creates address from bytes in a network byte order.
@@ -75,7 +75,7 @@ std::string address_v4::to_string() const
 ///                             Properties
 
 /// Native ipv4 address.
-address_v4::addr_t address_v4::addr() const noexcept
+constexpr address_v4::addr_t address_v4::addr() const noexcept
 {
     return addr_;
 }
@@ -85,9 +85,10 @@ bool address_v4::is_unicast() const noexcept
     return true;
 }
 
+/// If address is in 224.0.0.0/4.
 bool address_v4::is_multicast() const noexcept
 {
-    return address_class() == Class::D;
+    return (((const unsigned char*)&addr_)[0] & 0xf0) == 0xe0;
 }
 
 bool address_v4::is_broadcast() const noexcept
@@ -178,21 +179,47 @@ address_v4 address_v4::loopback() noexcept
 
 namespace detail {
 
+/**
+ * Parses dotted-decimal ipv4 address as inet_pton does, usable in constant expressions
+ * @param _saddr - address characters, not necessarily null-terminated
+ * @param _length - characters count
+ * @param _host - parsed address in a host byte order
+ * @return false if text isn't exactly four decimal octets without leading zeros
+ */
+constexpr bool parse_address_v4(const char* _saddr, std::size_t _length, std::uint32_t& _host) noexcept
+{
+    std::uint32_t host = 0;
+    std::size_t i = 0;
+    for( int octet = 0; octet < 4; ++octet ) {
+        if( octet && (i == _length || _saddr[i++] != '.') )
+            return false;
+        const std::size_t begin = i;
+        unsigned value = 0;
+        while( i < _length && _saddr[i] >= '0' && _saddr[i] <= '9' && i - begin < 3 )
+            value = value * 10 + (unsigned)(_saddr[i++] - '0');
+        if( i == begin || value > 255 || (_saddr[begin] == '0' && i - begin > 1) )
+            return false;
+        host = (host << 8) | value;
+    }
+    if( i != _length )
+        return false;
+    _host = host;
+    return true;
+}
+
 /**
  * Creates address_v4 from cstring ipv4 address and puts error if occured in _error
  * @param _saddr - cstring ipv4 address
- * @param _error - slot for error handling(by default nullptr)
+ * @param _error - slot for error handling(by default nullptr), EINVAL if address is malformed
  * @return cstring ipv4 address address_v4 representation
  */
-network::ip::address_v4 to_address_v4(const char* _saddr, network::error* _error) noexcept
+constexpr network::ip::address_v4 to_address_v4(const char* _saddr, network::error* _error) noexcept
 {
-    using namespace network::detail;
-    in4_addr_t addr{ };
-    int tmp = inet_pton(AF_INET, _saddr, &addr);
-    if( _error ) {
-        _error->value = tmp == 1 ? NO_ERROR : last_error();
-    }
-    return network::ip::address_v4(addr);
+    std::uint32_t host = 0;
+    const bool parsed = parse_address_v4(_saddr, network::detail::length(_saddr), host);
+    if( _error )
+        _error->value = parsed ? NO_ERROR : EINVAL;
+    return network::ip::address_v4((address_v4::uint_t)host);
 }
 
 } // namespace detail
@@ -202,7 +229,7 @@ network::ip::address_v4 to_address_v4(const char* _saddr, network::error* _error
  * @param _saddr - cstring ipv4 address
  * @return cstring ipv4 address address_v4 representation
  */
-address_v4 to_address_v4(const char* _saddr) noexcept
+constexpr address_v4 to_address_v4(const char* _saddr) noexcept
 {
     return network::ip::detail::to_address_v4(_saddr);
 }
@@ -213,7 +240,7 @@ address_v4 to_address_v4(const char* _saddr) noexcept
  * @param _error - slot for error handling
  * @return cstring ipv4 address address_v4 representation
  */
-address_v4 to_address_v4(const char* _saddr, network::error& _error) noexcept
+constexpr address_v4 to_address_v4(const char* _saddr, network::error& _error) noexcept
 {
     return network::ip::detail::to_address_v4(_saddr, &_error);
 }
@@ -2,7 +2,7 @@
 
 ///                              Constructors
 
-address_v6::address_v6(address_v6::addr_t _addr, address_v6::scope_id_t _scope_id) noexcept
+constexpr address_v6::address_v6(address_v6::addr_t _addr, address_v6::scope_id_t _scope_id) noexcept
     : addr_(_addr)
     , scope_id_(_scope_id)
 {
@@ -32,7 +32,7 @@ address_v6::byte_t address_v6::to_bytes() const noexcept
 std::string address_v6::to_string() const
 {
     char buff[network::detail::in6_addr_str_len]{ };
-    return inet_ntop(AF_INET6, &addr_, buff, network::detail::in6_addr_bytes_len);
+    return inet_ntop(AF_INET6, &addr_, buff, network::detail::in6_addr_str_len);
 }
 
 ///                             Conversions
@@ -41,13 +41,13 @@ std::string address_v6::to_string() const
 ///                             Properties
 
 /// Native ipv6 address.
-address_v6::addr_t address_v6::addr() const noexcept
+constexpr address_v6::addr_t address_v6::addr() const noexcept
 {
     return addr_;
 }
 
 /// Address scope id.
-address_v6::scope_id_t address_v6::scope_id() const noexcept
+constexpr address_v6::scope_id_t address_v6::scope_id() const noexcept
 {
     return scope_id_;
 }
@@ -59,6 +59,12 @@ bool address_v6::is_loopback() const noexcept
     return memcmp(&addr_, in6_addr_loopback.data(), in6_addr_bytes_len) == 0;
 }
 
+/// If address is in ff00::/8.
+bool address_v6::is_multicast() const noexcept
+{
+    return ((const unsigned char*)&addr_)[0] == 0xff;
+}
+
 ///                             Properties
 
 ///                             Comparison operators
@@ -111,20 +117,90 @@ address_v6 address_v6::loopback() noexcept
 
 namespace detail {
 
+/// Hex digit value, -1 if character isn't one.
+constexpr int hex_digit(char _c) noexcept
+{
+    return _c >= '0' && _c <= '9' ? _c - '0'
+         : _c >= 'a' && _c <= 'f' ? _c - 'a' + 10
+         : _c >= 'A' && _c <= 'F' ? _c - 'A' + 10 : -1;
+}
+
+/**
+ * Parses colon-delimited ipv6 address as inet_pton does, usable in constant expressions
+ * Accepts one "::" gap and trailing dotted ipv4 part, e.g. "::ffff:10.0.0.1".
+ * @param _saddr - address characters, not necessarily null-terminated
+ * @param _length - characters count
+ * @param _addr - parsed address
+ * @return false if text is malformed
+ */
+constexpr bool parse_address_v6(const char* _saddr, std::size_t _length, network::detail::in6_addr_t& _addr) noexcept
+{
+    unsigned char bytes[network::detail::in6_addr_bytes_len] { };
+    std::size_t count = 0;
+    std::size_t gap = SIZE_MAX;
+    std::size_t i = 0;
+    if( _length && _saddr[0] == ':' ) {
+        if( _length < 2 || _saddr[1] != ':' )
+            return false;
+        gap = 0;
+        i = 2;
+    }
+    while( i < _length ) {
+        if( count == sizeof(bytes) )
+            return false;
+        const std::size_t begin = i;
+        unsigned value = 0;
+        while( i < _length && hex_digit(_saddr[i]) != -1 && i - begin < 4 )
+            value = value * 16 + (unsigned)hex_digit(_saddr[i++]);
+        if( i == begin )
+            return false;
+        if( i < _length && _saddr[i] == '.' ) {
+            // Trailing ipv4 part takes the last 32 bits.
+            std::uint32_t host = 0;
+            if( count > sizeof(bytes) - 4 || !parse_address_v4(_saddr + begin, _length - begin, host) )
+                return false;
+            for( int shift = 24; shift >= 0; shift -= 8 )
+                bytes[count++] = (unsigned char)(host >> shift);
+            break;
+        }
+        bytes[count++] = (unsigned char)(value >> 8);
+        bytes[count++] = (unsigned char)value;
+        if( i == _length )
+            break;
+        if( _saddr[i++] != ':' || i == _length )
+            return false;
+        if( _saddr[i] == ':' ) {
+            if( gap != SIZE_MAX )
+                return false;
+            gap = count;
+            ++i;
+        }
+    }
+    if( gap == SIZE_MAX ? count != sizeof(bytes) : count == sizeof(bytes) )
+        return false;
+    network::detail::in6_addr_t addr { };
+    const std::size_t tail = gap == SIZE_MAX ? 0 : count - gap;
+    const std::size_t head = count - tail;
+    for( std::size_t b = 0; b < head; ++b )
+        addr.s6_addr[b] = bytes[b];
+    for( std::size_t b = 0; b < tail; ++b )
+        addr.s6_addr[sizeof(bytes) - tail + b] = bytes[head + b];
+    _addr = addr;
+    return true;
+}
+
 /**
  * Creates address_v6 from cstring ipv6 address and puts error if occured in _error
  * @param _saddr - cstring ipv6 address
- * @param _error - slot for error handling(by default nullptr)
+ * @param _error - slot for error handling(by default nullptr), EINVAL if address is malformed
  * @return cstring ipv6 address address_v6 representation
  */
-network::ip::address_v6 to_address_v6(const char* _saddr, network::error* _error) noexcept
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr, network::error* _error) noexcept
 {
-    using namespace network::detail;
-    in6_addr addr{ };
-    int tmp = inet_pton(AF_INET6, _saddr, &addr);
-    if( _error ) {
-        _error->value = tmp == 1 ? NO_ERROR : last_error();
-    }
+    network::detail::in6_addr_t addr { };
+    const bool parsed = parse_address_v6(_saddr, network::detail::length(_saddr), addr);
+    if( _error )
+        _error->value = parsed ? NO_ERROR : EINVAL;
     return network::ip::address_v6(addr);
 }
 
@@ -135,7 +211,7 @@ network::ip::address_v6 to_address_v6(const char* _saddr, network::error* _error
  * @param _saddr - cstring ipv6 address
  * @return cstring ipv6 address address_v6 representation
  */
-network::ip::address_v6 to_address_v6(const char* _saddr) noexcept
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr) noexcept
 {
     return network::ip::detail::to_address_v6(_saddr);
 }
@@ -146,7 +222,7 @@ network::ip::address_v6 to_address_v6(const char* _saddr) noexcept
  * @param _error - slot for error handling
  * @return cstring ipv6 address address_v6 representation
  */
-network::ip::address_v6 to_address_v6(const char* _saddr, network::error& _error) noexcept
+constexpr network::ip::address_v6 to_address_v6(const char* _saddr, network::error& _error) noexcept
 {
     return network::ip::detail::to_address_v6(_saddr, &_error);
 }
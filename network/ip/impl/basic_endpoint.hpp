@@ -0,0 +1,156 @@
+#pragma once
+
+
+///                              Constructors
+
+/// Any address endpoint with zero port.
+template<class _InternetProtocol>
+constexpr basic_endpoint<_InternetProtocol>::basic_endpoint() noexcept
+    : data_(detail::make_sockaddr(address_type(), 0))
+{
+}
+
+template<class _InternetProtocol>
+constexpr basic_endpoint<_InternetProtocol>::basic_endpoint(const address_type& _addr, unsigned short _port) noexcept
+    : data_(detail::make_sockaddr(_addr, _port))
+{
+}
+
+/// Converts runtime endpoint, endpoint of another family gives any address endpoint.
+template<class _InternetProtocol>
+basic_endpoint<_InternetProtocol>::basic_endpoint(const endpoint& _ep) noexcept
+    : basic_endpoint()
+{
+    if( _ep.is_v4() == is_v4() )
+        memcpy(&data_, _ep.sockaddr_ptr(), sizeof(data_));
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _InternetProtocol>
+constexpr bool basic_endpoint<_InternetProtocol>::is_v4() noexcept
+{
+    return _InternetProtocol::address_family() == AddressFamily::Ipv4;
+}
+
+/// Native sockaddr size.
+template<class _InternetProtocol>
+constexpr std::size_t basic_endpoint<_InternetProtocol>::size() noexcept
+{
+    return sizeof(sockaddr_type);
+}
+
+template<class _InternetProtocol>
+constexpr std::size_t basic_endpoint<_InternetProtocol>::capacity() noexcept
+{
+    return sizeof(sockaddr_type);
+}
+
+template<class _InternetProtocol>
+unsigned short basic_endpoint<_InternetProtocol>::port() const noexcept
+{
+    return ntohs(traits_t::port(data_));
+}
+
+template<class _InternetProtocol>
+void basic_endpoint<_InternetProtocol>::port(unsigned short _port) noexcept
+{
+    traits_t::port(data_) = htons(_port);
+}
+
+template<class _InternetProtocol>
+network::detail::sockaddr_t* basic_endpoint<_InternetProtocol>::sockaddr_ptr() noexcept
+{
+    return (network::detail::sockaddr_t*)&data_;
+}
+
+template<class _InternetProtocol>
+const network::detail::sockaddr_t* basic_endpoint<_InternetProtocol>::sockaddr_ptr() const noexcept
+{
+    return (const network::detail::sockaddr_t*)&data_;
+}
+
+template<class _InternetProtocol>
+basic_endpoint<_InternetProtocol>::operator network::detail::sockaddr_t*() noexcept
+{
+    return sockaddr_ptr();
+}
+
+template<class _InternetProtocol>
+basic_endpoint<_InternetProtocol>::operator const network::detail::sockaddr_t*() const noexcept
+{
+    return sockaddr_ptr();
+}
+
+///                             Properties
+
+
+///                             Conversions
+
+/// Endpoint string representation, ipv6 address is enclosed in brackets.
+template<class _InternetProtocol>
+std::string basic_endpoint<_InternetProtocol>::to_string() const
+{
+    std::string str_ep;
+    if( is_v4() ) {
+        str_ep = to_address().to_string();
+    }
+    else {
+        str_ep = '[';
+        str_ep += to_address().to_string();
+        str_ep += ']';
+    }
+    str_ep += ':';
+    str_ep += std::to_string(port());
+    return str_ep;
+}
+
+template<class _InternetProtocol>
+typename basic_endpoint<_InternetProtocol>::address_type basic_endpoint<_InternetProtocol>::to_address() const noexcept
+{
+    return traits_t::address(data_);
+}
+
+/// Runtime endpoint, for APIs not specialized by family.
+template<class _InternetProtocol>
+endpoint basic_endpoint<_InternetProtocol>::to_endpoint() const noexcept
+{
+    return endpoint(to_address(), port());
+}
+
+///                             Conversions
+
+
+///                             Comparison operators
+
+template<class _P>
+bool operator==(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept
+{
+    return _a.to_address() == _b.to_address() && _a.port() == _b.port();
+}
+
+template<class _P>
+bool operator!=(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept
+{
+    return !(_a == _b);
+}
+
+template<class _P>
+bool operator<(const basic_endpoint<_P>& _a, const basic_endpoint<_P>& _b) noexcept
+{
+    const auto a = _a.to_address();
+    const auto b = _b.to_address();
+    return a < b || (a == b && _a.port() < _b.port());
+}
+
+///                             Comparison operators
+
+
+template<class _CharT, class _Traits, class _P>
+std::basic_ostream<_CharT, _Traits>& operator<<(std::basic_ostream<_CharT, _Traits>& _os, const basic_endpoint<_P>& _ep)
+{
+    return _os << _ep.to_string();
+}
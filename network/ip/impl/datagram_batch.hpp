@@ -0,0 +1,173 @@
+#pragma once
+
+
+///                              Constructors
+
+/**
+ * @param _count - max datagrams received by one call
+ * @param _datagram_size - buffer size of one datagram, longer datagrams are truncated
+ */
+template<class _InternetProtocol>
+datagram_batch<_InternetProtocol>::datagram_batch(std::size_t _count, std::size_t _datagram_size)
+    : datagram_size_(_datagram_size)
+    , buffers_(_count * _datagram_size)
+    , control_(_count * control_size)
+    , sources_(_count)
+    , destinations_(_count)
+    , lengths_(_count)
+    , truncated_(_count)
+    , iov_(_count)
+    , headers_(_count)
+{
+    for( std::size_t i = 0; i < _count; ++i ) {
+        iov_[i].iov_base = buffers_.data() + i * datagram_size_;
+        iov_[i].iov_len = datagram_size_;
+    }
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _InternetProtocol>
+std::size_t datagram_batch<_InternetProtocol>::capacity() const noexcept
+{
+    return iov_.size();
+}
+
+template<class _InternetProtocol>
+std::size_t datagram_batch<_InternetProtocol>::datagram_size() const noexcept
+{
+    return datagram_size_;
+}
+
+/// Datagrams received by the last receive.
+template<class _InternetProtocol>
+std::size_t datagram_batch<_InternetProtocol>::size() const noexcept
+{
+    return size_;
+}
+
+///                             Properties
+
+
+///                             Datagrams
+
+template<class _InternetProtocol>
+const char* datagram_batch<_InternetProtocol>::data(std::size_t _i) const noexcept
+{
+    return buffers_.data() + _i * datagram_size_;
+}
+
+template<class _InternetProtocol>
+std::size_t datagram_batch<_InternetProtocol>::length(std::size_t _i) const noexcept
+{
+    return lengths_[_i];
+}
+
+/// If datagram didn't fit datagram_size and its tail was dropped.
+template<class _InternetProtocol>
+bool datagram_batch<_InternetProtocol>::truncated(std::size_t _i) const noexcept
+{
+    return truncated_[_i];
+}
+
+template<class _InternetProtocol>
+const typename datagram_batch<_InternetProtocol>::endpoint_type& datagram_batch<_InternetProtocol>::source(std::size_t _i) const noexcept
+{
+    return sources_[_i];
+}
+
+/// Destination address of datagram, unspecified address if packet info isn't enabled.
+template<class _InternetProtocol>
+const typename datagram_batch<_InternetProtocol>::address_type& datagram_batch<_InternetProtocol>::destination(std::size_t _i) const noexcept
+{
+    return destinations_[_i];
+}
+
+///                             Datagrams
+
+
+///                             Receiving
+
+/**
+ * Receives available datagrams up to capacity
+ * @param _s - datagram socket, normally non-blocking
+ * @param _flags - receive flags
+ * @return received datagrams count, 0 if would block, -1 on error
+ */
+template<class _InternetProtocol>
+long long datagram_batch<_InternetProtocol>::receive(network::detail::socket_t _s, int _flags)
+{
+    size_ = 0;
+#if defined(__linux__)
+    for( std::size_t i = 0; i < headers_.size(); ++i )
+        prepare(i);
+    int count = ::recvmmsg(_s, headers_.data(), (unsigned)headers_.size(), _flags, nullptr);
+    if( count == -1 )
+        return network::detail::would_block(network::detail::last_error()) ? 0 : -1;
+    for( int i = 0; i < count; ++i )
+        complete((std::size_t)i, headers_[i].msg_len);
+#else
+    for( std::size_t i = 0; i < headers_.size(); ++i ) {
+        prepare(i);
+        long long length = ::recvmsg(_s, &headers_[i], _flags);
+        if( length == -1 ) {
+            if( i == 0 && !network::detail::would_block(network::detail::last_error()) )
+                return -1;
+            break;
+        }
+        complete(i, (std::size_t)length);
+    }
+#endif
+    return (long long)size_;
+}
+
+template<class _InternetProtocol>
+void datagram_batch<_InternetProtocol>::prepare(std::size_t _i) noexcept
+{
+#if defined(__linux__)
+    msghdr& header = headers_[_i].msg_hdr;
+#else
+    msghdr& header = headers_[_i];
+#endif
+    header.msg_name = sources_[_i].sockaddr_ptr();
+    header.msg_namelen = (socklen_t)endpoint_type::capacity();
+    header.msg_iov = &iov_[_i];
+    header.msg_iovlen = 1;
+    header.msg_control = control_.data() + _i * control_size;
+    header.msg_controllen = control_size;
+    header.msg_flags = 0;
+}
+
+template<class _InternetProtocol>
+void datagram_batch<_InternetProtocol>::complete(std::size_t _i, std::size_t _length) noexcept
+{
+#if defined(__linux__)
+    msghdr& header = headers_[_i].msg_hdr;
+#else
+    msghdr& header = headers_[_i];
+#endif
+    lengths_[_i] = _length;
+    truncated_[_i] = (header.msg_flags & MSG_TRUNC) != 0;
+    destinations_[_i] = address_type();
+    for( cmsghdr* c = CMSG_FIRSTHDR(&header); c; c = CMSG_NXTHDR(&header, c) ) {
+        if( c->cmsg_level == traits_t::level && c->cmsg_type == traits_t::type ) {
+            typename traits_t::info_type info;
+            memcpy(&info, CMSG_DATA(c), sizeof(info));
+            destinations_[_i] = traits_t::destination(info);
+        }
+    }
+    ++size_;
+}
+
+/// Makes socket report datagrams destination addresses.
+template<class _InternetProtocol>
+bool datagram_batch<_InternetProtocol>::enable_packet_info(network::detail::socket_t _s) noexcept
+{
+    int on = 1;
+    return ::setsockopt(_s, traits_t::level, traits_t::option, (const char*)&on, sizeof(on)) == 0;
+}
+
+///                             Receiving
@@ -2,25 +2,17 @@
 
 ///                              Constructors
 
-endpoint::endpoint() noexcept
+/// Any ipv4 address endpoint with zero port.
+constexpr endpoint::endpoint() noexcept
+    : data_(detail::make_sockaddr(address_v4(), 0))
 {
-    data_.base = AF_INET;
-    data_.v4.sin_addr.s_addr = INADDR_ANY;
-    data_.v4.sin_port = 0;
 }
 
-endpoint::endpoint(const address& _addr, unsigned short _port) noexcept
+constexpr endpoint::endpoint(const address& _addr, unsigned short _port) noexcept
+    : data_(_addr.is_v4() ? storage(detail::make_sockaddr(_addr.v4(), _port))
+                          : storage(detail::make_sockaddr(_addr.v6(), _port)))
+    , is_v4_(_addr.is_v4())
 {
-    if( _addr.is_v4() ) {
-        data_.base = AF_INET;
-        data_.v4.sin_addr = _addr.v4().addr();
-        data_.v4.sin_port = htons(_port);
-    }
-    else {
-        data_.base = AF_INET6;
-        data_.v6.sin6_addr = _addr.v6().addr();
-        data_.v6.sin6_port = htons(_port);
-    }
 }
 
 ///                              Constructors
@@ -106,4 +98,135 @@ address endpoint::to_address() const noexcept
     return address_v6(data_.v6.sin6_addr);
 }
 
-///                             Conversions
\ No newline at end of file
+///                             Conversions
+
+
+namespace detail {
+
+/// Native ipv4 sockaddr, usable in constant expressions.
+constexpr network::detail::sockaddr_in4_t make_sockaddr(const address_v4& _addr, unsigned short _port) noexcept
+{
+    network::detail::sockaddr_in4_t sa { };
+    sa.sin_family = AF_INET;
+    sa.sin_port = network::detail::host_to_network16(_port);
+    sa.sin_addr = _addr.addr();
+    return sa;
+}
+
+/// Native ipv6 sockaddr with address scope id, usable in constant expressions.
+constexpr network::detail::sockaddr_in6_t make_sockaddr(const address_v6& _addr, unsigned short _port) noexcept
+{
+    network::detail::sockaddr_in6_t sa { };
+    sa.sin6_family = AF_INET6;
+    sa.sin6_port = network::detail::host_to_network16(_port);
+    sa.sin6_addr = _addr.addr();
+    sa.sin6_scope_id = (std::uint32_t)_addr.scope_id();
+    return sa;
+}
+
+/**
+ * Parses endpoint in to_string format, usable in constant expressions
+ * @param _sep - "a.b.c.d[:port]" or "[ipv6][:port]", not necessarily null-terminated
+ * @param _length - characters count
+ * @param _addr - parsed address
+ * @param _port - parsed port, 0 if omitted
+ * @return false if text is malformed
+ */
+constexpr bool parse_endpoint(const char* _sep, std::size_t _length, address& _addr, unsigned short& _port) noexcept
+{
+    std::size_t end = 0;
+    std::size_t i = 0;
+    if( _length && _sep[0] == '[' ) {
+        while( end < _length && _sep[end] != ']' )
+            ++end;
+        network::detail::in6_addr_t addr { };
+        if( end == _length || !parse_address_v6(_sep + 1, end - 1, addr) )
+            return false;
+        _addr = address(address_v6(addr));
+        i = end + 1;
+    }
+    else {
+        while( end < _length && _sep[end] != ':' )
+            ++end;
+        std::uint32_t host = 0;
+        if( !parse_address_v4(_sep, end, host) )
+            return false;
+        _addr = address(address_v4((address_v4::uint_t)host));
+        i = end;
+    }
+    _port = 0;
+    if( i == _length )
+        return true;
+    if( _sep[i++] != ':' || i == _length || _length - i > 5 )
+        return false;
+    unsigned port = 0;
+    for( ; i < _length; ++i ) {
+        if( _sep[i] < '0' || _sep[i] > '9' )
+            return false;
+        port = port * 10 + (unsigned)(_sep[i] - '0');
+    }
+    if( port > 65535 )
+        return false;
+    _port = (unsigned short)port;
+    return true;
+}
+
+/**
+ * Creates endpoint from cstring and puts error if occured in _error
+ * @param _sep - cstring endpoint, e.g. "10.0.0.1:80" or "[::1]:443"
+ * @param _error - slot for error handling(by default nullptr), EINVAL if endpoint is malformed
+ * @return parsed endpoint, any address endpoint if malformed
+ */
+constexpr network::ip::endpoint to_endpoint(const char* _sep, network::error* _error) noexcept
+{
+    address addr;
+    unsigned short port = 0;
+    const bool parsed = parse_endpoint(_sep, network::detail::length(_sep), addr, port);
+    if( _error )
+        _error->value = parsed ? NO_ERROR : EINVAL;
+    return parsed ? network::ip::endpoint(addr, port) : network::ip::endpoint();
+}
+
+} // namespace detail
+
+/**
+ * Creates endpoint from cstring without error handling
+ * @param _sep - cstring endpoint
+ * @return parsed endpoint
+ */
+constexpr endpoint to_endpoint(const char* _sep) noexcept
+{
+    return network::ip::detail::to_endpoint(_sep);
+}
+
+/**
+ * Creates endpoint from cstring with error handling
+ * @param _sep - cstring endpoint
+ * @param _error - slot for error handling
+ * @return parsed endpoint
+ */
+constexpr endpoint to_endpoint(const char* _sep, network::error& _error) noexcept
+{
+    return network::ip::detail::to_endpoint(_sep, &_error);
+}
+
+/**
+ * Creates endpoint from string without error handling
+ * @param _sep - string endpoint
+ * @return parsed endpoint
+ */
+endpoint to_endpoint(const std::string& _sep) noexcept
+{
+    return network::ip::to_endpoint(_sep.c_str());
+}
+
+/**
+ * Creates endpoint from string with error handling
+ * @param _sep - string endpoint
+ * @param _error - slot for error handling
+ * @return parsed endpoint
+ */
+endpoint to_endpoint(const std::string& _sep, network::error& _error) noexcept
+{
+    return network::ip::to_endpoint(_sep.c_str(), _error);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+
+inline namespace literals {
+
+/// Dotted-decimal ipv4 address.
+constexpr address_v4 operator"" _ip4(const char* _saddr, std::size_t _length)
+{
+    std::uint32_t host = 0;
+    if( !detail::parse_address_v4(_saddr, _length, host) )
+        throw std::invalid_argument("malformed ipv4 address literal");
+    return address_v4((address_v4::uint_t)host);
+}
+
+/// Colon-delimited ipv6 address.
+constexpr address_v6 operator"" _ip6(const char* _saddr, std::size_t _length)
+{
+    network::detail::in6_addr_t addr { };
+    if( !detail::parse_address_v6(_saddr, _length, addr) )
+        throw std::invalid_argument("malformed ipv6 address literal");
+    return address_v6(addr);
+}
+
+/// Ipv4 or ipv6 address.
+constexpr address operator"" _ip(const char* _saddr, std::size_t _length)
+{
+    std::uint32_t host = 0;
+    if( detail::parse_address_v4(_saddr, _length, host) )
+        return address_v4((address_v4::uint_t)host);
+    return operator"" _ip6(_saddr, _length);
+}
+
+/// Ipv4 endpoint "a.b.c.d[:port]".
+constexpr endpoint_v4 operator"" _ep4(const char* _sep, std::size_t _length)
+{
+    address addr;
+    unsigned short port = 0;
+    if( !detail::parse_endpoint(_sep, _length, addr, port) || !addr.is_v4() )
+        throw std::invalid_argument("malformed ipv4 endpoint literal");
+    return endpoint_v4(addr.v4(), port);
+}
+
+/// Ipv6 endpoint "[ipv6][:port]".
+constexpr endpoint_v6 operator"" _ep6(const char* _sep, std::size_t _length)
+{
+    address addr;
+    unsigned short port = 0;
+    if( !detail::parse_endpoint(_sep, _length, addr, port) || addr.is_v4() )
+        throw std::invalid_argument("malformed ipv6 endpoint literal");
+    return endpoint_v6(addr.v6(), port);
+}
+
+/// Ipv4 or ipv6 endpoint.
+constexpr endpoint operator"" _ep(const char* _sep, std::size_t _length)
+{
+    address addr;
+    unsigned short port = 0;
+    if( !detail::parse_endpoint(_sep, _length, addr, port) )
+        throw std::invalid_argument("malformed endpoint literal");
+    return endpoint(addr, port);
+}
+
+} // namespace literals
@@ -0,0 +1,266 @@
+#pragma once
+
+
+unsigned interface_index(const char* _name) noexcept
+{
+    return ::if_nametoindex(_name);
+}
+
+
+///                              Constructors
+
+/**
+ * Opens socket bound to wildcard address and _port with packet info enabled
+ * @param _loop - loop driving the socket
+ * @param _port - port all groups are received on
+ * @param _batch - datagrams received per syscall
+ * @param _datagram_size - max datagram size, longer datagrams are truncated
+ */
+template<class _InternetProtocol>
+multicast_receiver<_InternetProtocol>::multicast_receiver(network::event_loop& _loop, unsigned short _port,
+                                                          std::size_t _batch, std::size_t _datagram_size)
+    : loop_(_loop)
+    , s_(SocketType::Udp)
+    , batch_(_batch, _datagram_size)
+{
+    open_ = s_.set_option(network::option::reuse_address(true))
+         && datagram_batch<_InternetProtocol>::enable_packet_info(s_.socket())
+         && s_.bind(endpoint_type(address_type(), _port))
+         && s_.non_blocking(true)
+         && loop_.add(s_.socket(), network::event_loop::read, [this](unsigned) { receive(); });
+}
+
+/// Leaves all groups by closing the socket.
+template<class _InternetProtocol>
+multicast_receiver<_InternetProtocol>::~multicast_receiver() noexcept
+{
+    if( open_ )
+        loop_.remove(s_.socket());
+    s_.close();
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::is_open() const noexcept
+{
+    return open_;
+}
+
+template<class _InternetProtocol>
+network::detail::socket_t multicast_receiver<_InternetProtocol>::socket() const noexcept
+{
+    return s_.socket();
+}
+
+/// Groups joined at least once.
+template<class _InternetProtocol>
+std::size_t multicast_receiver<_InternetProtocol>::groups() const noexcept
+{
+    return groups_.size();
+}
+
+/// Interface index following joins use, 0 lets the kernel choose by routing table.
+template<class _InternetProtocol>
+void multicast_receiver<_InternetProtocol>::join_interface(unsigned _interface) noexcept
+{
+    interface_ = _interface;
+}
+
+/// If datagrams sent through this socket reach local receivers.
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::loopback(bool _on) const noexcept
+{
+    return s_.set_option(typename traits_t::loop_option(_on));
+}
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::hops(int _hops) const noexcept
+{
+    return s_.set_option(typename traits_t::hops_option(_hops));
+}
+
+template<class _InternetProtocol>
+void multicast_receiver<_InternetProtocol>::max_batches(std::size_t _batches) noexcept
+{
+    max_batches_ = _batches ? _batches : 1;
+}
+
+/// Sets handler for datagrams which destination isn't a joined group (e.g. unicast to the port).
+template<class _InternetProtocol>
+void multicast_receiver<_InternetProtocol>::on_unmatched(handler_t _handler)
+{
+    on_unmatched_ = std::move(_handler);
+}
+
+///                             Properties
+
+
+///                             Statistics
+
+template<class _InternetProtocol>
+std::uint64_t multicast_receiver<_InternetProtocol>::received() const noexcept
+{
+    return received_;
+}
+
+template<class _InternetProtocol>
+std::uint64_t multicast_receiver<_InternetProtocol>::unmatched() const noexcept
+{
+    return unmatched_;
+}
+
+template<class _InternetProtocol>
+std::uint64_t multicast_receiver<_InternetProtocol>::truncated() const noexcept
+{
+    return truncated_;
+}
+
+/// Receive syscalls which returned data, received() / batches() is average batch size.
+template<class _InternetProtocol>
+std::uint64_t multicast_receiver<_InternetProtocol>::batches() const noexcept
+{
+    return batches_;
+}
+
+///                             Statistics
+
+
+///                             Membership
+
+/**
+ * Joins group from any source
+ * @param _group - multicast address
+ * @param _handler - handler of group datagrams, replaces previous one
+ * @return false if socket failed to join
+ */
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::join(const address_type& _group, handler_t _handler)
+{
+    if( !_group.is_multicast() ) {
+        errno = EINVAL;
+        return false;
+    }
+    return s_.set_option(network::option::join_group(address(_group), interface_))
+        && add(_group, std::move(_handler));
+}
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::join(const address_type& _group, handler_t _handler, network::error& _error)
+{
+    return network::detail::set_error(join(_group, std::move(_handler)), _error);
+}
+
+/// Joins group from _source only (SSM), group may be joined from several sources.
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::join(const address_type& _group, const address_type& _source, handler_t _handler)
+{
+    if( !_group.is_multicast() ) {
+        errno = EINVAL;
+        return false;
+    }
+    return s_.set_option(network::option::join_source_group(address(_group), address(_source), interface_))
+        && add(_group, std::move(_handler));
+}
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::join(const address_type& _group, const address_type& _source, handler_t _handler, network::error& _error)
+{
+    return network::detail::set_error(join(_group, _source, std::move(_handler)), _error);
+}
+
+/// Leaves any-source group, interface must be the same as on join.
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::leave(const address_type& _group)
+{
+    if( !s_.set_option(network::option::leave_group(address(_group), interface_)) )
+        return false;
+    release(_group);
+    return true;
+}
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::leave(const address_type& _group, const address_type& _source)
+{
+    if( !s_.set_option(network::option::leave_source_group(address(_group), address(_source), interface_)) )
+        return false;
+    release(_group);
+    return true;
+}
+
+template<class _InternetProtocol>
+typename multicast_receiver<_InternetProtocol>::group_t* multicast_receiver<_InternetProtocol>::find(const address_type& _group) noexcept
+{
+    for( auto& group : groups_ ) {
+        if( group.group == _group )
+            return &group;
+    }
+    return nullptr;
+}
+
+template<class _InternetProtocol>
+bool multicast_receiver<_InternetProtocol>::add(const address_type& _group, handler_t&& _handler)
+{
+    auto handler = std::make_shared<const handler_t>(std::move(_handler));
+    if( group_t* group = find(_group) ) {
+        group->handler = std::move(handler);
+        ++group->memberships;
+    }
+    else
+        groups_.push_back(group_t { _group, std::move(handler), 1 });
+    return true;
+}
+
+template<class _InternetProtocol>
+void multicast_receiver<_InternetProtocol>::release(const address_type& _group)
+{
+    group_t* group = find(_group);
+    if( group && --group->memberships == 0 )
+        groups_.erase(groups_.begin() + (group - groups_.data()));
+}
+
+///                             Membership
+
+
+///                             Receiving
+
+/**
+ * Drains socket in batches and dispatches datagrams to group handlers
+ * Invoked by the loop on readiness, at most max_batches batches are received per call.
+ * @return dispatched datagrams count
+ */
+template<class _InternetProtocol>
+std::size_t multicast_receiver<_InternetProtocol>::receive()
+{
+    std::size_t total = 0;
+    for( std::size_t n = 0; n < max_batches_; ++n ) {
+        const long long count = batch_.receive(s_.socket());
+        if( count <= 0 )
+            break;
+        ++batches_;
+        for( std::size_t i = 0; i < (std::size_t)count; ++i ) {
+            truncated_ += batch_.truncated(i);
+            // Looked up per datagram: previous handlers may have changed membership.
+            group_t* group = find(batch_.destination(i));
+            if( group ) {
+                const std::shared_ptr<const handler_t> handler = group->handler;
+                (*handler)(batch_.data(i), batch_.length(i), batch_.source(i));
+            }
+            else {
+                ++unmatched_;
+                if( on_unmatched_ )
+                    on_unmatched_(batch_.data(i), batch_.length(i), batch_.source(i));
+            }
+        }
+        received_ += (std::uint64_t)count;
+        total += (std::size_t)count;
+        if( (std::size_t)count < batch_.capacity() )
+            break;
+    }
+    return total;
+}
+
+///                             Receiving
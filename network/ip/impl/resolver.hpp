@@ -0,0 +1,531 @@
+#pragma once
+
+
+namespace detail {
+
+const std::uint16_t dns_type_a = 1;
+const std::uint16_t dns_type_soa = 6;
+const std::uint16_t dns_type_aaaa = 28;
+const std::uint16_t dns_class_in = 1;
+const std::uint16_t dns_flag_response = 0x8000;
+const std::uint16_t dns_flag_recursion_desired = 0x0100;
+const std::uint16_t dns_rcode_mask = 0x000f;
+const std::uint16_t dns_rcode_nxdomain = 3;
+const std::size_t dns_header_len = 12;
+const std::size_t dns_max_udp_len = 4096;
+
+inline std::uint16_t read_u16(const unsigned char* _p) noexcept
+{
+    return (std::uint16_t)((_p[0] << 8) | _p[1]);
+}
+
+inline std::uint32_t read_u32(const unsigned char* _p) noexcept
+{
+    return ((std::uint32_t)_p[0] << 24) | ((std::uint32_t)_p[1] << 16) | ((std::uint32_t)_p[2] << 8) | _p[3];
+}
+
+inline void write_u16(std::vector<char>& _packet, std::uint16_t _value)
+{
+    _packet.push_back((char)(_value >> 8));
+    _packet.push_back((char)(_value & 0xff));
+}
+
+/// Advances _pos past (possibly compressed) domain name, false if packet is malformed.
+inline bool skip_dns_name(const unsigned char* _data, std::size_t _length, std::size_t& _pos) noexcept
+{
+    while( _pos < _length ) {
+        unsigned char len = _data[_pos];
+        if( len == 0 ) {
+            ++_pos;
+            return true;
+        }
+        if( (len & 0xc0) == 0xc0 ) {
+            _pos += 2;
+            return _pos <= _length;
+        }
+        _pos += len + 1;
+    }
+    return false;
+}
+
+/**
+ * Reads (possibly compressed) domain name as lowercase dotted string
+ * @param _pos - name offset, advanced past the name in place
+ * @return false if packet is malformed
+ */
+inline bool read_dns_name(const unsigned char* _data, std::size_t _length, std::size_t& _pos, std::string& _name)
+{
+    _name.clear();
+    std::size_t pos = _pos;
+    bool jumped = false;
+    // Each pointer must go backwards, so the chain ends.
+    std::size_t limit = _pos;
+    while( pos < _length ) {
+        const unsigned char len = _data[pos];
+        if( len == 0 ) {
+            if( !jumped )
+                _pos = pos + 1;
+            return true;
+        }
+        if( (len & 0xc0) == 0xc0 ) {
+            if( pos + 2 > _length )
+                return false;
+            const std::size_t target = ((std::size_t)(len & 0x3f) << 8) | _data[pos + 1];
+            if( target >= limit )
+                return false;
+            if( !jumped )
+                _pos = pos + 2;
+            jumped = true;
+            limit = target;
+            pos = target;
+            continue;
+        }
+        if( (len & 0xc0) || pos + 1 + len > _length || _name.size() + len + 1 > 255 )
+            return false;
+        if( !_name.empty() )
+            _name.push_back('.');
+        for( std::size_t i = pos + 1; i < pos + 1 + len; ++i )
+            _name.push_back((char)std::tolower(_data[i]));
+        pos += len + 1;
+    }
+    return false;
+}
+
+/// Parses literal ipv4/ipv6 address, unlike to_address reports failure reliably.
+inline bool parse_literal(const std::string& _saddr, address& _addr) noexcept
+{
+    network::detail::in4_addr_t in4 { };
+    if( inet_pton(AF_INET, _saddr.c_str(), &in4) == 1 ) {
+        _addr = address_v4(in4);
+        return true;
+    }
+    network::detail::in6_addr_t in6 { };
+    if( inet_pton(AF_INET6, _saddr.c_str(), &in6) == 1 ) {
+        _addr = address_v6(in6);
+        return true;
+    }
+    return false;
+}
+
+/// Lowercase host name without trailing dot, DNS names are case-insensitive.
+std::string normalize_host(const std::string& _host)
+{
+    std::string name(_host);
+    if( !name.empty() && name.back() == '.' )
+        name.pop_back();
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char _c) { return (char)std::tolower(_c); });
+    return name;
+}
+
+/**
+ * Builds recursive DNS query packet
+ * @param _packet - slot for packet
+ * @param _id - query id
+ * @param _name - normalized host name
+ * @param _type - record type
+ * @return false if name isn't a valid domain name
+ */
+bool encode_dns_query(std::vector<char>& _packet, std::uint16_t _id, const std::string& _name, std::uint16_t _type)
+{
+    if( _name.empty() || _name.size() > 253 )
+        return false;
+    _packet.clear();
+    write_u16(_packet, _id);
+    write_u16(_packet, dns_flag_recursion_desired);
+    write_u16(_packet, 1);
+    write_u16(_packet, 0);
+    write_u16(_packet, 0);
+    write_u16(_packet, 0);
+
+    std::size_t begin = 0;
+    while( begin <= _name.size() ) {
+        std::size_t end = _name.find('.', begin);
+        if( end == std::string::npos )
+            end = _name.size();
+        const std::size_t len = end - begin;
+        if( len == 0 || len > 63 )
+            return false;
+        _packet.push_back((char)len);
+        _packet.insert(_packet.end(), _name.begin() + begin, _name.begin() + end);
+        begin = end + 1;
+    }
+    _packet.push_back(0);
+    write_u16(_packet, _type);
+    write_u16(_packet, dns_class_in);
+    return true;
+}
+
+} // namespace detail
+
+
+///                              Constructors
+
+resolver::resolver(network::event_loop& _loop, const endpoint& _server, const std::string& _hosts_path)
+    : loop_(_loop)
+    , server_(_server)
+    , alive_(std::make_shared<char>())
+{
+    if( !_hosts_path.empty() )
+        load_hosts(_hosts_path);
+}
+
+/// Pending lookups are dropped without invoking their handlers.
+resolver::~resolver() noexcept
+{
+    if( socket_.socket() != network::detail::invalid_socket )
+        loop_.remove(socket_.socket());
+    for( const auto& q : queries_ )
+        loop_.cancel_timer(q.second.timer);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+/// DNS server endpoint.
+const endpoint& resolver::server() const noexcept
+{
+    return server_;
+}
+
+/// Time to wait for an answer before retransmitting.
+void resolver::timeout(std::chrono::milliseconds _timeout) noexcept
+{
+    timeout_ = _timeout;
+}
+
+/// Transmissions count per query.
+void resolver::attempts(unsigned _attempts) noexcept
+{
+    attempts_ = _attempts ? _attempts : 1;
+}
+
+/// How long missing names are cached.
+void resolver::negative_ttl(std::chrono::seconds _ttl) noexcept
+{
+    negative_ttl_ = _ttl;
+}
+
+/// Cached names count, including expired ones not yet evicted.
+std::size_t resolver::cache_size() const noexcept
+{
+    return cache_.size();
+}
+
+/// Names being resolved.
+std::size_t resolver::pending() const noexcept
+{
+    return lookups_.size();
+}
+
+///                             Properties
+
+
+///                             Hosts
+
+/// Loads hosts file entries, they take precedence over DNS and never expire.
+bool resolver::load_hosts(const std::string& _path)
+{
+    std::ifstream file(_path);
+    if( !file )
+        return false;
+    std::string line;
+    while( std::getline(file, line) ) {
+        line.erase(std::find(line.begin(), line.end(), '#'), line.end());
+        std::istringstream fields(line);
+        std::string saddr;
+        address addr;
+        if( !(fields >> saddr) || !network::ip::detail::parse_literal(saddr, addr) )
+            continue;
+        std::string name;
+        while( fields >> name )
+            add_host(name, addr);
+    }
+    return true;
+}
+
+void resolver::add_host(const std::string& _name, const address& _addr)
+{
+    hosts_[network::ip::detail::normalize_host(_name)].push_back(_addr);
+}
+
+///                             Hosts
+
+
+///                             Resolving
+
+/**
+ * Resolves host name or literal address into endpoints
+ * @param _host - host name or literal ipv4/ipv6 address
+ * @param _port - port of produced endpoints
+ * @param _handler - invoked from the loop, never from async_resolve itself,
+ *                   ipv6 endpoints go first when name has both families
+ */
+void resolver::async_resolve(const std::string& _host, unsigned short _port, resolver::handler_t _handler)
+{
+    address literal;
+    if( network::ip::detail::parse_literal(_host, literal) ) {
+        std::vector<waiter> waiters { { _port, std::move(_handler) } };
+        std::weak_ptr<char> alive = alive_;
+        loop_.post([this, alive, literal, waiters]() mutable {
+            if( !alive.expired() )
+                complete({ literal }, NO_ERROR, waiters);
+        });
+        return;
+    }
+
+    const std::string name = network::ip::detail::normalize_host(_host);
+    auto host = hosts_.find(name);
+    if( host != hosts_.end() ) {
+        std::vector<waiter> waiters { { _port, std::move(_handler) } };
+        auto addresses = host->second;
+        std::weak_ptr<char> alive = alive_;
+        loop_.post([this, alive, addresses, waiters]() mutable {
+            if( !alive.expired() )
+                complete(addresses, NO_ERROR, waiters);
+        });
+        return;
+    }
+
+    auto cached = cache_.find(name);
+    if( cached != cache_.end() ) {
+        if( cached->second.expires > clock_t::now() ) {
+            std::vector<waiter> waiters { { _port, std::move(_handler) } };
+            auto entry = cached->second;
+            std::weak_ptr<char> alive = alive_;
+            loop_.post([this, alive, entry, waiters]() mutable {
+                if( !alive.expired() )
+                    complete(entry.addresses, entry.error, waiters);
+            });
+            return;
+        }
+        cache_.erase(cached);
+    }
+
+    auto it = lookups_.find(name);
+    if( it != lookups_.end() ) {
+        it->second.waiters.push_back({ _port, std::move(_handler) });
+        return;
+    }
+
+    lookup& l = lookups_[name];
+    l.waiters.push_back({ _port, std::move(_handler) });
+    if( !open() ) {
+        l.error = network::detail::last_error();
+        std::weak_ptr<char> alive = alive_;
+        loop_.post([this, alive, name] {
+            if( !alive.expired() )
+                finish_lookup(name);
+        });
+        return;
+    }
+    l.outstanding = 2;
+    send_query(name, network::ip::detail::dns_type_aaaa);
+    send_query(name, network::ip::detail::dns_type_a);
+}
+
+void resolver::clear_cache() noexcept
+{
+    cache_.clear();
+}
+
+bool resolver::open()
+{
+    if( socket_.socket() != network::detail::invalid_socket )
+        return true;
+    network::base_socket s(server_.is_v4() ? AF_INET : AF_INET6, (int)SocketType::Udp);
+    if( s.socket() == network::detail::invalid_socket || !s.non_blocking(true) || !s.connect(server_) )
+        return false;
+    if( !loop_.add(s.socket(), network::event_loop::read, [this](unsigned) { on_read(); }) )
+        return false;
+    socket_ = std::move(s);
+    return true;
+}
+
+void resolver::send_query(const std::string& _name, std::uint16_t _type)
+{
+    std::uint16_t id;
+    do
+        id = (std::uint16_t)random_();
+    while( queries_.count(id) );
+
+    query& q = queries_[id];
+    q.name = _name;
+    q.type = _type;
+    q.attempts = attempts_;
+    if( !network::ip::detail::encode_dns_query(q.packet, id, _name, _type) ) {
+        std::weak_ptr<char> alive = alive_;
+        loop_.post([this, alive, id] {
+            if( !alive.expired() )
+                finish_query(id, EAI_NONAME);
+        });
+        return;
+    }
+    transmit(id);
+}
+
+void resolver::transmit(std::uint16_t _id)
+{
+    query& q = queries_[_id];
+    --q.attempts;
+    network::detail::send_some(socket_.socket(), q.packet.data(), q.packet.size());
+    q.timer = loop_.add_timer(timeout_, [this, _id] { on_timeout(_id); });
+}
+
+void resolver::on_timeout(std::uint16_t _id)
+{
+    auto it = queries_.find(_id);
+    if( it == queries_.end() )
+        return;
+    if( it->second.attempts )
+        transmit(_id);
+    else
+        finish_query(_id, network::detail::timed_out);
+}
+
+void resolver::on_read()
+{
+    char buff[network::ip::detail::dns_max_udp_len];
+    long long size;
+    while( (size = ::recv(socket_.socket(), buff, sizeof(buff), 0)) > 0 )
+        on_answer(buff, (std::size_t)size);
+}
+
+/// Parses answer, unknown ids, other questions and malformed packets are ignored and left to timeout.
+void resolver::on_answer(const char* _data, std::size_t _length)
+{
+    using namespace network::ip::detail;
+    const auto* data = reinterpret_cast<const unsigned char*>(_data);
+    if( _length < dns_header_len )
+        return;
+    const std::uint16_t id = read_u16(data);
+    auto q = queries_.find(id);
+    const std::uint16_t flags = read_u16(data + 2);
+    if( q == queries_.end() || !(flags & dns_flag_response) )
+        return;
+
+    // Answer must echo our question, id alone is too easy to guess for a forged reply.
+    std::size_t pos = dns_header_len;
+    const unsigned qd = read_u16(data + 4);
+    const unsigned an = read_u16(data + 6);
+    const unsigned ns = read_u16(data + 8);
+    std::string qname;
+    if( qd != 1 || !read_dns_name(data, _length, pos, qname) || pos + 4 > _length
+        || qname != q->second.name || read_u16(data + pos) != q->second.type || read_u16(data + pos + 2) != dns_class_in )
+        return;
+    pos += 4;
+    lookup& l = lookups_[q->second.name];
+
+    std::vector<address> v4, v6;
+    std::uint32_t ttl = UINT32_MAX;
+    std::uint32_t negative_ttl = UINT32_MAX;
+    for( unsigned i = 0; i < an + ns; ++i ) {
+        if( !skip_dns_name(data, _length, pos) || pos + 10 > _length )
+            return;
+        const std::uint16_t type = read_u16(data + pos);
+        const std::uint32_t rr_ttl = read_u32(data + pos + 4);
+        const std::size_t rdlength = read_u16(data + pos + 8);
+        pos += 10;
+        if( pos + rdlength > _length )
+            return;
+        if( i < an && type == dns_type_a && rdlength == network::detail::in4_addr_bytes_len ) {
+            address_v4::byte_t bytes;
+            std::copy(data + pos, data + pos + rdlength, bytes.begin());
+            v4.push_back(address_v4(bytes));
+            ttl = std::min(ttl, rr_ttl);
+        }
+        else if( i < an && type == dns_type_aaaa && rdlength == network::detail::in6_addr_bytes_len ) {
+            address_v6::byte_t bytes;
+            std::copy(data + pos, data + pos + rdlength, bytes.begin());
+            v6.push_back(address_v6(bytes));
+            ttl = std::min(ttl, rr_ttl);
+        }
+        else if( i >= an && type == dns_type_soa ) {
+            std::size_t soa = pos;
+            if( skip_dns_name(data, _length, soa) && skip_dns_name(data, _length, soa) && soa + 20 <= pos + rdlength )
+                negative_ttl = std::min(rr_ttl, read_u32(data + soa + 16));
+        }
+        pos += rdlength;
+    }
+
+    l.v4.insert(l.v4.end(), v4.begin(), v4.end());
+    l.v6.insert(l.v6.end(), v6.begin(), v6.end());
+    l.ttl = std::min(l.ttl, ttl);
+    l.negative_ttl = std::min(l.negative_ttl, negative_ttl);
+
+    const std::uint16_t rcode = flags & dns_rcode_mask;
+    finish_query(id, rcode == NO_ERROR ? NO_ERROR : rcode == dns_rcode_nxdomain ? EAI_NONAME : EAI_FAIL);
+}
+
+void resolver::finish_query(std::uint16_t _id, int _error)
+{
+    auto q = queries_.find(_id);
+    if( q == queries_.end() )
+        return;
+    loop_.cancel_timer(q->second.timer);
+    const std::string name = std::move(q->second.name);
+    queries_.erase(q);
+
+    lookup& l = lookups_[name];
+    if( _error == EAI_NONAME || (_error != NO_ERROR && l.error == NO_ERROR) )
+        l.error = _error;
+    if( --l.outstanding == 0 )
+        finish_lookup(name);
+}
+
+/// Caches lookup result and notifies all waiters.
+void resolver::finish_lookup(const std::string& _name)
+{
+    auto it = lookups_.find(_name);
+    if( it == lookups_.end() )
+        return;
+    lookup l = std::move(it->second);
+    lookups_.erase(it);
+
+    std::vector<address> addresses(std::move(l.v6));
+    addresses.insert(addresses.end(), l.v4.begin(), l.v4.end());
+    int error = NO_ERROR;
+    std::uint32_t ttl = l.ttl;
+    if( addresses.empty() ) {
+        if( l.error != NO_ERROR && l.error != EAI_NONAME ) {
+            complete(addresses, l.error, l.waiters);
+            return;
+        }
+        error = EAI_NONAME;
+        ttl = std::min<std::uint32_t>(l.negative_ttl, (std::uint32_t)negative_ttl_.count());
+    }
+    if( ttl != 0 && ttl != UINT32_MAX )
+        cache_[_name] = cache_entry { addresses, clock_t::now() + std::chrono::seconds(ttl), error };
+    complete(addresses, error, l.waiters);
+}
+
+void resolver::complete(const std::vector<address>& _addresses, int _error, std::vector<waiter>& _waiters)
+{
+    network::error error;
+    error = _error;
+    for( auto& w : _waiters ) {
+        std::vector<endpoint> eps;
+        eps.reserve(_addresses.size());
+        for( const auto& addr : _addresses )
+            eps.emplace_back(addr, w.port);
+        w.handler(eps, error);
+    }
+}
+
+///                             Resolving
+
+
+///                             Static
+
+/// Platform hosts file location.
+std::string resolver::default_hosts_path()
+{
+#ifdef _WIN32
+    return "C:\\Windows\\System32\\drivers\\etc\\hosts";
+#else
+    return "/etc/hosts";
+#endif
+}
+
+///                             Static
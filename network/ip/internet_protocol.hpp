@@ -18,6 +18,29 @@ struct internet_protocol
     }
 };
 
+/// Protocol which family is known only at runtime, e.g. for dual-stack connects.
+class basic_internet_protocol
+{
+public:
+    constexpr basic_internet_protocol(AddressFamily _family = AddressFamily::Ipv4) noexcept
+        : family_(_family)
+    {
+    }
+
+    constexpr int family() const noexcept
+    {
+        return (int)family_;
+    }
+
+    constexpr AddressFamily address_family() const noexcept
+    {
+        return family_;
+    }
+
+private:
+    AddressFamily family_;
+};
+
 using ipv4 = internet_protocol<AddressFamily::Ipv4>;
 using ipv6 = internet_protocol<AddressFamily::Ipv6>;
 
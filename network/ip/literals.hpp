@@ -0,0 +1,29 @@
+#pragma once
+#include "basic_endpoint.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace network {
+namespace ip {
+
+/**
+ * Address and endpoint literals, e.g. "10.0.0.1"_ip4 or "[::1]:443"_ep
+ * Parsing is constexpr: literal initializing constexpr variable is built at compile time
+ * and malformed one fails the build; elsewhere it throws std::invalid_argument.
+ */
+inline namespace literals {
+
+constexpr address_v4 operator"" _ip4(const char* _saddr, std::size_t _length);
+constexpr address_v6 operator"" _ip6(const char* _saddr, std::size_t _length);
+constexpr address operator"" _ip(const char* _saddr, std::size_t _length);
+constexpr endpoint_v4 operator"" _ep4(const char* _sep, std::size_t _length);
+constexpr endpoint_v6 operator"" _ep6(const char* _sep, std::size_t _length);
+constexpr endpoint operator"" _ep(const char* _sep, std::size_t _length);
+
+} // namespace literals
+
+#include "impl/literals.hpp"
+
+} // namespace ip
+} // namespace network
@@ -0,0 +1,294 @@
+#pragma once
+#include "address.hpp"
+#include "datagram_batch.hpp"
+#include "../event_loop.hpp"
+#include "../socket_impl.hpp"
+
+#include <net/if.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace network {
+namespace option {
+
+/// @class basic_membership
+/**
+ * Any-source (MCAST_JOIN_GROUP) or source-specific (MCAST_JOIN_SOURCE_GROUP) group membership
+ * Level follows group family, so one type serves ipv4 and ipv6 sockets.
+ * @param _Name - MCAST_JOIN_GROUP, MCAST_LEAVE_GROUP, MCAST_JOIN_SOURCE_GROUP or MCAST_LEAVE_SOURCE_GROUP
+ * @param _Request - group_req or group_source_req
+ */
+template<int _Name, class _Request>
+class basic_membership
+{
+public:
+    /// @see Constructors
+    basic_membership(const network::ip::address& _group, unsigned _interface = 0) noexcept
+        : is_v4_(_group.is_v4())
+    {
+        request_.gr_interface = _interface;
+        assign(request_.gr_group, _group);
+    }
+
+    basic_membership(const network::ip::address& _group, const network::ip::address& _source, unsigned _interface = 0) noexcept
+        : is_v4_(_group.is_v4())
+    {
+        request_.gsr_interface = _interface;
+        assign(request_.gsr_group, _group);
+        assign(request_.gsr_source, _source);
+    }
+
+    /// @see Traits
+    int level() const noexcept
+    {
+        return is_v4_ ? IPPROTO_IP : IPPROTO_IPV6;
+    }
+
+    static constexpr int name() noexcept
+    {
+        return _Name;
+    }
+
+    static constexpr unsigned types() noexcept
+    {
+        return udp;
+    }
+
+    static constexpr unsigned families() noexcept
+    {
+        return inet;
+    }
+
+    static constexpr bool applies_to(SocketType _type) noexcept
+    {
+        return (types() & type_mask(_type)) != 0;
+    }
+
+    static constexpr bool applies_to(AddressFamily _family) noexcept
+    {
+        return (families() & family_mask(_family)) != 0;
+    }
+
+    /// @see Value
+    const void* data() const noexcept
+    {
+        return &request_;
+    }
+
+    static constexpr socklen_t size() noexcept
+    {
+        return sizeof(_Request);
+    }
+
+private:
+    static void assign(sockaddr_storage& _storage, const network::ip::address& _address) noexcept
+    {
+        const network::ip::endpoint ep(_address);
+        memcpy(&_storage, ep.sockaddr_ptr(), ep.size());
+    }
+
+    _Request request_ { };
+    bool is_v4_;
+};
+
+using join_group = basic_membership<MCAST_JOIN_GROUP, group_req>;
+using leave_group = basic_membership<MCAST_LEAVE_GROUP, group_req>;
+using join_source_group = basic_membership<MCAST_JOIN_SOURCE_GROUP, group_source_req>;
+using leave_source_group = basic_membership<MCAST_LEAVE_SOURCE_GROUP, group_source_req>;
+
+/// @class multicast_interface_v4
+/**
+ * Interface outgoing ipv4 multicast datagrams leave from, by local address or (Linux) by index
+ */
+class multicast_interface_v4
+{
+public:
+    /// @see Constructors
+    explicit multicast_interface_v4(const network::ip::address_v4& _local) noexcept
+    {
+#if defined(__linux__)
+        request_.imr_address = _local.addr();
+#else
+        request_ = _local.addr();
+#endif
+    }
+
+#if defined(__linux__)
+    explicit multicast_interface_v4(unsigned _interface) noexcept
+    {
+        request_.imr_ifindex = (int)_interface;
+    }
+#endif
+
+    /// @see Traits
+    static constexpr int level() noexcept
+    {
+        return IPPROTO_IP;
+    }
+
+    static constexpr int name() noexcept
+    {
+        return IP_MULTICAST_IF;
+    }
+
+    static constexpr unsigned types() noexcept
+    {
+        return udp;
+    }
+
+    static constexpr unsigned families() noexcept
+    {
+        return v4;
+    }
+
+    static constexpr bool applies_to(SocketType _type) noexcept
+    {
+        return (types() & type_mask(_type)) != 0;
+    }
+
+    static constexpr bool applies_to(AddressFamily _family) noexcept
+    {
+        return (families() & family_mask(_family)) != 0;
+    }
+
+    /// @see Value
+    const void* data() const noexcept
+    {
+        return &request_;
+    }
+
+    static constexpr socklen_t size() noexcept
+    {
+#if defined(__linux__)
+        return sizeof(ip_mreqn);
+#else
+        return sizeof(in_addr);
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    ip_mreqn request_ { };
+#else
+    in_addr request_ { };
+#endif
+};
+
+} // namespace option
+
+
+namespace ip {
+
+/// Index of network interface by name (e.g. "eth0"), 0 if there is no such interface.
+unsigned interface_index(const char* _name) noexcept;
+
+namespace detail {
+
+template<class _InternetProtocol>
+struct multicast_traits;
+
+template<>
+struct multicast_traits<ipv4>
+{
+    typedef network::option::multicast_loop_v4 loop_option;
+    typedef network::option::multicast_hops_v4 hops_option;
+};
+
+template<>
+struct multicast_traits<ipv6>
+{
+    typedef network::option::multicast_loop_v6 loop_option;
+    typedef network::option::multicast_hops_v6 hops_option;
+};
+
+} // namespace detail
+
+/// @class multicast_receiver
+/**
+ * Drains many multicast groups through one socket bound to their common port
+ * @param Threadsafe - no threadsafe, must be used from the loop thread
+ * Datagrams are received in batches and dispatched to group handlers by their
+ * destination address, so one core serves all groups with a few syscalls.
+ * Handlers are invoked from the loop, they may join and leave groups but must not
+ * destroy the receiver.
+ */
+template<class _InternetProtocol>
+class multicast_receiver
+{
+    typedef detail::multicast_traits<_InternetProtocol> traits_t;
+public:
+    typedef basic_endpoint<_InternetProtocol> endpoint_type;
+    typedef typename endpoint_type::address_type address_type;
+    typedef std::function<void(const char* _data, std::size_t _length, const endpoint_type& _source)> handler_t;
+
+    /// Batches drained per readiness notification before yielding to other handlers.
+    static const std::size_t default_max_batches = 16;
+
+    /// @see Constructors
+    multicast_receiver(network::event_loop& _loop, unsigned short _port,
+                       std::size_t _batch = datagram_batch<_InternetProtocol>::default_count,
+                       std::size_t _datagram_size = datagram_batch<_InternetProtocol>::default_datagram_size);
+    multicast_receiver(const multicast_receiver& _other) = delete;
+    multicast_receiver& operator=(const multicast_receiver& _other) = delete;
+    ~multicast_receiver() noexcept;
+
+    /// @see Properties
+    bool is_open() const noexcept;
+    network::detail::socket_t socket() const noexcept;
+    std::size_t groups() const noexcept;
+    void join_interface(unsigned _interface) noexcept;
+    bool loopback(bool _on) const noexcept;
+    bool hops(int _hops) const noexcept;
+    void max_batches(std::size_t _batches) noexcept;
+    void on_unmatched(handler_t _handler);
+
+    /// @see Statistics
+    std::uint64_t received() const noexcept;
+    std::uint64_t unmatched() const noexcept;
+    std::uint64_t truncated() const noexcept;
+    std::uint64_t batches() const noexcept;
+
+    /// @see Membership
+    bool join(const address_type& _group, handler_t _handler);
+    bool join(const address_type& _group, handler_t _handler, network::error& _error);
+    bool join(const address_type& _group, const address_type& _source, handler_t _handler);
+    bool join(const address_type& _group, const address_type& _source, handler_t _handler, network::error& _error);
+    bool leave(const address_type& _group);
+    bool leave(const address_type& _group, const address_type& _source);
+
+    /// @see Receiving
+    std::size_t receive();
+
+private:
+    struct group_t
+    {
+        address_type group;
+        /// Shared so dispatch keeps handler alive while it leaves or rejoins its group.
+        std::shared_ptr<const handler_t> handler;
+        std::size_t memberships;
+    };
+
+    group_t* find(const address_type& _group) noexcept;
+    bool add(const address_type& _group, handler_t&& _handler);
+    void release(const address_type& _group);
+
+    network::event_loop& loop_;
+    socket_impl<_InternetProtocol> s_;
+    datagram_batch<_InternetProtocol> batch_;
+    std::vector<group_t> groups_;
+    handler_t on_unmatched_;
+    unsigned interface_ { };
+    std::size_t max_batches_ { default_max_batches };
+    std::uint64_t received_ { };
+    std::uint64_t unmatched_ { };
+    std::uint64_t truncated_ { };
+    std::uint64_t batches_ { };
+    bool open_ { false };
+};
+
+#include "impl/multicast.hpp"
+
+} // namespace ip
+} // namespace network
@@ -0,0 +1,140 @@
+#pragma once
+#include "endpoint.hpp"
+#include "../base_socket.hpp"
+#include "../event_loop.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <netdb.h>
+#endif
+
+namespace network {
+namespace ip {
+
+/// @class resolver
+/**
+ * Non-blocking host name resolver driven by event_loop
+ * @param Threadsafe - no threadsafe, must be used from the loop thread
+ * Looks names up in hosts file first and then sends A and AAAA queries over UDP
+ * to the configured DNS server. Answers are cached respecting record TTL,
+ * missing names are cached for negative_ttl (or SOA minimum if it is smaller),
+ * concurrent lookups of the same name share one query.
+ * Errors: EAI_NONAME - name doesn't exist, EAI_FAIL - server failure or malformed answer,
+ * timed out - no answer after all attempts.
+ */
+class resolver
+{
+public:
+    typedef std::function<void(const std::vector<endpoint>& _eps, network::error _error)> handler_t;
+
+    /// @see Constructors
+    explicit resolver(network::event_loop& _loop,
+                      const endpoint& _server = endpoint(address_v4::loopback(), 53),
+                      const std::string& _hosts_path = default_hosts_path());
+    resolver(const resolver& _other) = delete;
+    resolver& operator=(const resolver& _other) = delete;
+    ~resolver() noexcept;
+
+    /// @see Properties
+    const endpoint& server() const noexcept;
+    void timeout(std::chrono::milliseconds _timeout) noexcept;
+    void attempts(unsigned _attempts) noexcept;
+    void negative_ttl(std::chrono::seconds _ttl) noexcept;
+    std::size_t cache_size() const noexcept;
+    std::size_t pending() const noexcept;
+
+    /// @see Hosts
+    bool load_hosts(const std::string& _path);
+    void add_host(const std::string& _name, const address& _addr);
+
+    /// @see Resolving
+    void async_resolve(const std::string& _host, unsigned short _port, handler_t _handler);
+    void clear_cache() noexcept;
+
+    /// @see Static
+    static std::string default_hosts_path();
+
+private:
+    typedef std::chrono::steady_clock clock_t;
+
+    struct waiter
+    {
+        unsigned short port;
+        handler_t handler;
+    };
+
+    struct lookup
+    {
+        std::vector<waiter> waiters;
+        std::vector<address> v6;
+        std::vector<address> v4;
+        std::uint32_t ttl { UINT32_MAX };
+        std::uint32_t negative_ttl { UINT32_MAX };
+        unsigned outstanding { };
+        int error { NO_ERROR };
+    };
+
+    struct query
+    {
+        std::string name;
+        std::uint16_t type;
+        std::vector<char> packet;
+        unsigned attempts;
+        network::event_loop::timer_t timer;
+    };
+
+    struct cache_entry
+    {
+        std::vector<address> addresses;
+        clock_t::time_point expires;
+        int error;
+    };
+
+    bool open();
+    void send_query(const std::string& _name, std::uint16_t _type);
+    void transmit(std::uint16_t _id);
+    void on_timeout(std::uint16_t _id);
+    void on_read();
+    void on_answer(const char* _data, std::size_t _length);
+    void finish_query(std::uint16_t _id, int _error);
+    void finish_lookup(const std::string& _name);
+    void complete(const std::vector<address>& _addresses, int _error, std::vector<waiter>& _waiters);
+
+    network::event_loop& loop_;
+    endpoint server_;
+    network::base_socket socket_;
+    std::unordered_map<std::string, std::vector<address>> hosts_;
+    std::unordered_map<std::string, cache_entry> cache_;
+    std::unordered_map<std::string, lookup> lookups_;
+    std::unordered_map<std::uint16_t, query> queries_;
+    std::chrono::milliseconds timeout_ { 1000 };
+    unsigned attempts_ { 3 };
+    std::chrono::seconds negative_ttl_ { 30 };
+    /// Query ids must be unpredictable, answers are only as trusted as the id and question match.
+    std::random_device random_;
+    std::shared_ptr<char> alive_;
+};
+
+namespace detail {
+
+std::string normalize_host(const std::string& _host);
+bool encode_dns_query(std::vector<char>& _packet, std::uint16_t _id, const std::string& _name, std::uint16_t _type);
+
+} // namespace detail
+
+#include "impl/resolver.hpp"
+
+} // namespace ip
+} // namespace network
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace network {
+
+/// @class latency_histogram
+/**
+ * Log-linear histogram of durations with 16 buckets per power of two (~6% precision)
+ * @param Threadsafe - no threadsafe, merge per-thread histograms for reports
+ * Recording is a few instructions and never allocates, so it fits hot paths.
+ */
+class latency_histogram
+{
+public:
+    typedef std::chrono::nanoseconds duration_t;
+
+    /// @see Constructors
+    latency_histogram() noexcept = default;
+
+    /// @see Recording
+    void record(duration_t _value, std::uint64_t _count = 1) noexcept;
+    void merge(const latency_histogram& _other) noexcept;
+    void reset() noexcept;
+
+    /// @see Statistics
+    std::uint64_t count() const noexcept;
+    duration_t min() const noexcept;
+    duration_t max() const noexcept;
+    duration_t mean() const noexcept;
+    duration_t percentile(double _p) const noexcept;
+
+private:
+    static const unsigned sub_bits = 4;
+    static const unsigned linear = 2u << sub_bits;
+    static const std::size_t buckets = (64 - sub_bits) * (1u << sub_bits) + linear;
+
+    static std::size_t index(std::uint64_t _value) noexcept;
+    static std::uint64_t upper_bound(std::size_t _index) noexcept;
+
+    std::array<std::uint64_t, buckets> counts_ { };
+    std::uint64_t count_ { };
+    std::uint64_t min_ { UINT64_MAX };
+    std::uint64_t max_ { };
+    double sum_ { };
+};
+
+#include "impl/latency_histogram.hpp"
+
+} // namespace network
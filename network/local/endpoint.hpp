@@ -0,0 +1,93 @@
+#pragma once
+#include "protocol.hpp"
+#include "../ip/basic_endpoint.hpp"
+#include "../socket_option.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include <sys/un.h>
+
+namespace network {
+namespace local {
+
+/// @class endpoint
+/**
+ * Unix domain socket address: filesystem path or linux abstract namespace name
+ * @param Threadsafe - no threadsafe
+ * @throw any std::string exceptions in to_string() and path() functions
+ */
+class endpoint
+{
+public:
+    typedef sockaddr_un sockaddr_type;
+
+    /// @see Constructors
+    endpoint() noexcept;
+    endpoint(const char* _path) noexcept;
+    endpoint(const std::string& _path) noexcept;
+    endpoint(endpoint&& _other) noexcept = default;
+    endpoint(const endpoint& _other) noexcept = default;
+
+    /// @see Assign operators
+    endpoint& operator=(endpoint&& _other) noexcept = default;
+    endpoint& operator=(const endpoint& _other) noexcept = default;
+
+    /// @see Properties
+    bool is_abstract() const noexcept;
+    std::size_t size() const noexcept;
+    void size(std::size_t _size) noexcept;
+    int error() const noexcept;
+    static constexpr std::size_t capacity() noexcept;
+    static constexpr std::size_t max_path_len() noexcept;
+    network::detail::sockaddr_t* sockaddr_ptr() noexcept;
+    const network::detail::sockaddr_t* sockaddr_ptr() const noexcept;
+    operator network::detail::sockaddr_t*() noexcept;
+    operator const network::detail::sockaddr_t*() const noexcept;
+
+    /// @see Conversions
+    std::string path() const;
+    std::string to_string() const;
+
+    /// @see Static
+    static endpoint abstract(const std::string& _name) noexcept;
+
+private:
+    void assign(const char* _data, std::size_t _length, bool _abstract) noexcept;
+
+    sockaddr_type data_ { };
+    std::size_t size_;
+};
+
+} // namespace network::local
+
+namespace ip {
+namespace detail {
+
+template<>
+struct protocol_endpoint<network::local::protocol>
+{
+    typedef network::local::endpoint type;
+};
+
+} // namespace network::ip::detail
+} // namespace network::ip
+
+namespace option {
+namespace detail {
+
+template<>
+struct protocol_families<network::local::protocol>
+{
+    static constexpr unsigned value = unix_domain;
+};
+
+} // namespace network::option::detail
+} // namespace network::option
+
+namespace local {
+
+#include "impl/endpoint.hpp"
+
+} // namespace network::local
+} // namespace network
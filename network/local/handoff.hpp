@@ -0,0 +1,118 @@
+#pragma once
+#include "socket.hpp"
+#include "../event_loop.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace network {
+namespace local {
+
+/// Socket passed between processes on restart, name tells receiver what it is (e.g. "http").
+struct handoff_socket
+{
+    std::string name;
+    base_socket s;
+    /// Listening socket, otherwise established connection.
+    bool listening { true };
+};
+
+/// @class handoff_sender
+/**
+ * Running (old) process side of zero-downtime restart
+ * @param Threadsafe - no threadsafe, runs on the loop thread
+ * Listens on unix seqpacket socket; successor that connects gets offered sockets with
+ * SCM_RIGHTS and confirms once it accepts on them, then on_confirmed callback should stop
+ * accepting and drain() finishes in-flight connections.
+ * Sockets are handed only to a successor running with the same effective uid (SO_PEERCRED),
+ * verify_peer() may narrow it further. Abstract endpoints have no filesystem permissions,
+ * so this check is all that keeps other local users from taking the listeners.
+ */
+class handoff_sender
+{
+public:
+    typedef std::function<void()> callback_t;
+    typedef std::function<std::size_t()> counter_t;
+    typedef std::function<void(bool _drained)> drain_callback_t;
+    /// Decides if peer with same uid may take sockets over, e.g. by its pid or executable.
+    typedef std::function<bool(const ucred& _peer)> verifier_t;
+
+    static const std::uint32_t magic = 0x46464f48;
+
+    /// @see Constructors
+    explicit handoff_sender(event_loop& _loop) noexcept;
+    handoff_sender(const handoff_sender& _other) = delete;
+    handoff_sender& operator=(const handoff_sender& _other) = delete;
+    ~handoff_sender() noexcept;
+
+    /// @see Properties
+    bool confirmed() const noexcept;
+    std::size_t offered() const noexcept;
+
+    /// @see Handoff
+    bool open(const endpoint& _ep);
+    bool open(const endpoint& _ep, network::error& _error);
+    void offer(const std::string& _name, network::detail::socket_t _s, bool _listening = true);
+    void on_confirmed(callback_t _callback);
+    void verify_peer(verifier_t _verifier);
+
+    /// @see Draining
+    void drain(std::chrono::milliseconds _deadline, counter_t _in_flight, drain_callback_t _done);
+
+private:
+    struct entry
+    {
+        std::string name;
+        network::detail::socket_t s;
+        bool listening;
+    };
+
+    bool trusted(const socket_impl<protocol>& _peer) const;
+    void on_accept();
+    void on_peer(unsigned _events);
+    bool send_sockets();
+    void close_peer();
+    void check_drain(event_loop::clock_t::time_point _deadline, counter_t _in_flight, drain_callback_t _done);
+
+    event_loop& loop_;
+    socket_impl<protocol> listener_;
+    socket_impl<protocol> peer_;
+    std::vector<entry> entries_;
+    callback_t on_confirmed_;
+    verifier_t verifier_;
+    /// Pending drain check, cancelled on destruction.
+    event_loop::timer_t drain_timer_ { };
+    bool confirmed_ { false };
+};
+
+/// @class handoff_receiver
+/**
+ * Starting (new) process side of zero-downtime restart
+ * @param Threadsafe - no threadsafe
+ * Blocking, meant for startup before event loop runs: connect, receive, start accepting
+ * on received sockets, then confirm so predecessor stops accepting.
+ */
+class handoff_receiver
+{
+public:
+    /// @see Handoff
+    bool connect(const endpoint& _ep) noexcept;
+    bool receive(std::vector<handoff_socket>& _sockets, std::chrono::milliseconds _timeout);
+    bool confirm() noexcept;
+
+    /// @see Static
+    template<class _Protocol, class _ReceivePolicy>
+    static bool adopt(handoff_socket& _handoff, socket_impl<_Protocol, _ReceivePolicy>& _s) noexcept;
+    static handoff_socket* find(std::vector<handoff_socket>& _sockets, const std::string& _name) noexcept;
+
+private:
+    socket_impl<protocol> s_;
+};
+
+#include "impl/handoff.hpp"
+
+} // namespace network::local
+} // namespace network
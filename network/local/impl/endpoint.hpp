@@ -0,0 +1,136 @@
+#pragma once
+
+
+///                              Constructors
+
+/// Unnamed endpoint, e.g. for accept or socketpair peers.
+endpoint::endpoint() noexcept
+    : size_(offsetof(sockaddr_type, sun_path))
+{
+    data_.sun_family = AF_UNIX;
+}
+
+/// Filesystem endpoint, path longer than max_path_len() makes bind, connect and send fail with ENAMETOOLONG.
+endpoint::endpoint(const char* _path) noexcept
+    : endpoint()
+{
+    assign(_path, strlen(_path), false);
+}
+
+endpoint::endpoint(const std::string& _path) noexcept
+    : endpoint()
+{
+    assign(_path.data(), _path.size(), false);
+}
+
+///                              Constructors
+
+
+///                             Properties
+
+/// If endpoint is in linux abstract namespace, i.e. doesn't exist in filesystem.
+bool endpoint::is_abstract() const noexcept
+{
+    return size_ > offsetof(sockaddr_type, sun_path) && data_.sun_path[0] == '\0';
+}
+
+/// Native sockaddr size, it depends on path length.
+std::size_t endpoint::size() const noexcept
+{
+    return size_;
+}
+
+/// Sets sockaddr size returned by the system, e.g. by recvfrom, clamped to the valid range.
+void endpoint::size(std::size_t _size) noexcept
+{
+    const std::size_t offset = offsetof(sockaddr_type, sun_path);
+    size_ = _size < offset ? offset : _size > capacity() ? capacity() : _size;
+}
+
+/// ENAMETOOLONG if path or name didn't fit, 0 otherwise.
+int endpoint::error() const noexcept
+{
+    return size_ == 0 ? ENAMETOOLONG : 0;
+}
+
+constexpr std::size_t endpoint::capacity() noexcept
+{
+    return sizeof(sockaddr_type);
+}
+
+constexpr std::size_t endpoint::max_path_len() noexcept
+{
+    return sizeof(sockaddr_type::sun_path) - 1;
+}
+
+network::detail::sockaddr_t* endpoint::sockaddr_ptr() noexcept
+{
+    return (network::detail::sockaddr_t*)&data_;
+}
+
+const network::detail::sockaddr_t* endpoint::sockaddr_ptr() const noexcept
+{
+    return (const network::detail::sockaddr_t*)&data_;
+}
+
+endpoint::operator network::detail::sockaddr_t*() noexcept
+{
+    return sockaddr_ptr();
+}
+
+endpoint::operator const network::detail::sockaddr_t*() const noexcept
+{
+    return sockaddr_ptr();
+}
+
+///                             Properties
+
+
+///                             Conversions
+
+/// Filesystem path or abstract name without leading zero.
+std::string endpoint::path() const
+{
+    const std::size_t offset = offsetof(sockaddr_type, sun_path);
+    if( size_ <= offset )
+        return { };
+    if( is_abstract() )
+        return std::string(data_.sun_path + 1, size_ - offset - 1);
+    return std::string(data_.sun_path, strnlen(data_.sun_path, size_ - offset));
+}
+
+/// Path, abstract names are prefixed with '@' like in ss/netstat output.
+std::string endpoint::to_string() const
+{
+    return is_abstract() ? '@' + path() : path();
+}
+
+///                             Conversions
+
+
+///                             Static
+
+/// Abstract namespace endpoint (linux only), it vanishes with the last socket bound to it, see endpoint(const char*).
+endpoint endpoint::abstract(const std::string& _name) noexcept
+{
+    endpoint ep;
+    ep.assign(_name.data(), _name.size(), true);
+    return ep;
+}
+
+///                             Static
+
+
+void endpoint::assign(const char* _data, std::size_t _length, bool _abstract) noexcept
+{
+    const std::size_t prefix = _abstract ? 1 : 0;
+    memset(data_.sun_path, 0, sizeof(data_.sun_path));
+    if( _length > max_path_len() ) {
+        // Binding truncated path would silently use another file.
+        size_ = 0;
+        return;
+    }
+    memcpy(data_.sun_path + prefix, _data, _length);
+    // Abstract names have leading zero and aren't terminated, paths have terminating zero.
+    size_ = offsetof(sockaddr_type, sun_path) + _length + 1;
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+
+namespace detail {
+
+/// Message: magic (4), count (2), last (1), reserved (1), then per socket: listening (1), name length (2), name.
+const std::size_t handoff_header_size = 8;
+const std::size_t handoff_max_name = 255;
+const std::size_t handoff_max_message = handoff_header_size + max_fds * (3 + handoff_max_name);
+const char handoff_confirm = 'C';
+const std::chrono::milliseconds drain_interval(10);
+
+} // namespace detail
+
+
+///                              handoff_sender
+
+handoff_sender::handoff_sender(event_loop& _loop) noexcept
+    : loop_(_loop)
+{
+}
+
+handoff_sender::~handoff_sender() noexcept
+{
+    loop_.cancel_timer(drain_timer_);
+    close_peer();
+    if( listener_.socket() != network::detail::invalid_socket )
+        loop_.remove(listener_.socket());
+}
+
+/// If successor confirmed takeover.
+bool handoff_sender::confirmed() const noexcept
+{
+    return confirmed_;
+}
+
+std::size_t handoff_sender::offered() const noexcept
+{
+    return entries_.size();
+}
+
+/**
+ * Starts waiting for successor on the loop
+ * @param _ep - handoff endpoint, stale filesystem socket there is removed (new process
+ *              replaces the file of the old one this way, which never removes it itself)
+ * @return false if endpoint can't be bound
+ */
+bool handoff_sender::open(const endpoint& _ep)
+{
+    if( !_ep.is_abstract() )
+        ::unlink(_ep.path().c_str());
+    socket_impl<protocol> s(SocketType::SeqPacket);
+    if( !s.open(_ep, 1) || !s.non_blocking() )
+        return false;
+    if( !loop_.add(s.socket(), event_loop::read, [this](unsigned) { on_accept(); }) )
+        return false;
+    listener_ = std::move(s);
+    return true;
+}
+
+bool handoff_sender::open(const endpoint& _ep, network::error& _error)
+{
+    return network::detail::set_error(open(_ep), _error);
+}
+
+/**
+ * Adds socket passed to successor
+ * @param _name - identifies socket for receiver, truncated to 255 bytes
+ * @param _s - descriptor, stays owned by caller (successor gets duplicate)
+ * @param _listening - listening socket or established connection
+ */
+void handoff_sender::offer(const std::string& _name, network::detail::socket_t _s, bool _listening)
+{
+    entries_.push_back(entry { _name.substr(0, detail::handoff_max_name), _s, _listening });
+}
+
+/// Sets callback invoked on successor confirmation, it should stop accepting on offered sockets.
+void handoff_sender::on_confirmed(handoff_sender::callback_t _callback)
+{
+    on_confirmed_ = std::move(_callback);
+}
+
+/// Sets additional check of successor, peers with other effective uid are refused regardless.
+void handoff_sender::verify_peer(handoff_sender::verifier_t _verifier)
+{
+    verifier_ = std::move(_verifier);
+}
+
+bool handoff_sender::trusted(const socket_impl<protocol>& _peer) const
+{
+    ucred peer { };
+    if( !peer_credentials(_peer, peer) || peer.uid != ::geteuid() )
+        return false;
+    return !verifier_ || verifier_(peer);
+}
+
+void handoff_sender::on_accept()
+{
+    socket_impl<protocol> s;
+    if( !listener_.accept(s) )
+        return;
+    // One successor at a time, the other one may retry after it fails.
+    if( peer_.socket() != network::detail::invalid_socket || !trusted(s) )
+        return;
+    peer_ = std::move(s);
+    if( !send_sockets() || !loop_.add(peer_.socket(), event_loop::read, [this](unsigned _events) { on_peer(_events); }) )
+        close_peer();
+}
+
+void handoff_sender::on_peer(unsigned _events)
+{
+    (void)_events;
+    char confirm = 0;
+    const long long size = ::recv(peer_.socket(), &confirm, 1, network::detail::dont_wait);
+    if( size == -1 && network::detail::would_block(network::detail::last_error()) )
+        return;
+    close_peer();
+    if( size != 1 || confirm != detail::handoff_confirm )
+        return;
+
+    // Successor accepts on the sockets now, no more handoffs from this process.
+    confirmed_ = true;
+    loop_.remove(listener_.socket());
+    listener_ = socket_impl<protocol>();
+    if( on_confirmed_ )
+        on_confirmed_();
+}
+
+/// Sends offered sockets in messages of at most max_fds descriptors (blocking peer).
+bool handoff_sender::send_sockets()
+{
+    std::size_t i = 0;
+    do {
+        const std::size_t count = std::min(entries_.size() - i, max_fds);
+        std::vector<char> message(detail::handoff_header_size);
+        std::vector<network::detail::socket_t> fds;
+        const std::uint32_t magic = handoff_sender::magic;
+        const std::uint16_t n = (std::uint16_t)count;
+        memcpy(message.data(), &magic, sizeof(magic));
+        memcpy(message.data() + 4, &n, sizeof(n));
+        message[6] = i + count == entries_.size() ? 1 : 0;
+        for( std::size_t j = i; j < i + count; ++j ) {
+            const entry& e = entries_[j];
+            const std::uint16_t length = (std::uint16_t)e.name.size();
+            message.push_back(e.listening ? 1 : 0);
+            message.insert(message.end(), (const char*)&length, (const char*)&length + sizeof(length));
+            message.insert(message.end(), e.name.begin(), e.name.end());
+            fds.push_back(e.s);
+        }
+        if( write_with_fds(peer_, message.data(), message.size(), fds) != (long long)message.size() )
+            return false;
+        i += count;
+    } while( i < entries_.size() );
+    return true;
+}
+
+void handoff_sender::close_peer()
+{
+    if( peer_.socket() == network::detail::invalid_socket )
+        return;
+    loop_.remove(peer_.socket());
+    peer_ = socket_impl<protocol>();
+}
+
+/**
+ * Waits for in-flight connections to finish after handoff
+ * @param _deadline - maximum wait
+ * @param _in_flight - returns connections still served by this process, polled every 10 ms
+ * @param _done - invoked on the loop with true if they finished before deadline, it is
+ *                not invoked if sender is destroyed first; drain replaces previous one
+ */
+void handoff_sender::drain(std::chrono::milliseconds _deadline, handoff_sender::counter_t _in_flight,
+                           handoff_sender::drain_callback_t _done)
+{
+    loop_.cancel_timer(drain_timer_);
+    check_drain(event_loop::clock_t::now() + _deadline, std::move(_in_flight), std::move(_done));
+}
+
+void handoff_sender::check_drain(event_loop::clock_t::time_point _deadline, handoff_sender::counter_t _in_flight,
+                                 handoff_sender::drain_callback_t _done)
+{
+    if( _in_flight() == 0 ) {
+        _done(true);
+        return;
+    }
+    if( event_loop::clock_t::now() >= _deadline ) {
+        _done(false);
+        return;
+    }
+    drain_timer_ = loop_.add_timer(detail::drain_interval, [this, _deadline, _in_flight, _done] {
+        check_drain(_deadline, _in_flight, _done);
+    });
+}
+
+///                              handoff_sender
+
+
+///                              handoff_receiver
+
+/// Connects to predecessor handoff endpoint, false if nobody listens there (e.g. cold start).
+bool handoff_receiver::connect(const endpoint& _ep) noexcept
+{
+    socket_impl<protocol> s(SocketType::SeqPacket);
+    if( !s.connect(_ep) )
+        return false;
+    s_ = std::move(s);
+    return true;
+}
+
+/**
+ * Receives sockets of predecessor
+ * @param _sockets - received sockets are appended to it, they are close-on-exec
+ * @param _timeout - wait limit for each message
+ * @return false on timeout, disconnect or malformed message
+ */
+bool handoff_receiver::receive(std::vector<handoff_socket>& _sockets, std::chrono::milliseconds _timeout)
+{
+    std::vector<char> message(detail::handoff_max_message);
+    std::vector<network::detail::socket_t> fds;
+    bool last = false;
+    while( !last ) {
+        network::detail::pollfd_t fd { s_.socket(), POLLIN, 0 };
+        if( network::detail::poll(&fd, 1, (int)_timeout.count()) != 1 )
+            return false;
+        const long long size = read_with_fds(s_, message.data(), message.size(), fds);
+
+        // Received descriptors are owned from here on, malformed message closes them.
+        std::vector<base_socket> owned;
+        for( auto s : fds )
+            owned.emplace_back(s);
+        std::uint32_t magic = 0;
+        std::uint16_t count = 0;
+        if( size < (long long)detail::handoff_header_size )
+            return false;
+        memcpy(&magic, message.data(), sizeof(magic));
+        memcpy(&count, message.data() + 4, sizeof(count));
+        if( magic != handoff_sender::magic || count != owned.size() )
+            return false;
+        last = message[6] != 0;
+
+        std::vector<handoff_socket> received(count);
+        std::size_t offset = detail::handoff_header_size;
+        for( std::size_t i = 0; i < count; ++i ) {
+            std::uint16_t length = 0;
+            if( offset + 3 > (std::size_t)size )
+                return false;
+            received[i].listening = message[offset] != 0;
+            memcpy(&length, message.data() + offset + 1, sizeof(length));
+            offset += 3;
+            if( offset + length > (std::size_t)size )
+                return false;
+            received[i].name.assign(message.data() + offset, length);
+            offset += length;
+            received[i].s = std::move(owned[i]);
+        }
+        for( auto& r : received )
+            _sockets.push_back(std::move(r));
+    }
+    return true;
+}
+
+/// Tells predecessor to stop accepting, call it once received listeners are served.
+bool handoff_receiver::confirm() noexcept
+{
+    const bool sent = ::send(s_.socket(), &detail::handoff_confirm, 1, network::detail::nosignal) == 1;
+    s_ = socket_impl<protocol>();
+    return sent;
+}
+
+/// Moves received descriptor to socket without re-binding, false if protocol family differs.
+template<class _Protocol, class _ReceivePolicy>
+bool handoff_receiver::adopt(handoff_socket& _handoff, socket_impl<_Protocol, _ReceivePolicy>& _s) noexcept
+{
+    return _s.adopt(std::move(_handoff.s));
+}
+
+/// Received socket by name, nullptr if predecessor didn't pass it.
+handoff_socket* handoff_receiver::find(std::vector<handoff_socket>& _sockets, const std::string& _name) noexcept
+{
+    for( auto& s : _sockets ) {
+        if( s.name == _name && s.s.socket() != network::detail::invalid_socket )
+            return &s;
+    }
+    return nullptr;
+}
+
+///                              handoff_receiver
@@ -0,0 +1,23 @@
+#pragma once
+#include "../detail/common.hpp"
+
+namespace network {
+namespace local {
+
+/// Unix domain protocol tag, same shape as ip::internet_protocol.
+/// SocketType::Tcp and SocketType::Udp mean stream and datagram sockets for it.
+struct protocol
+{
+    static constexpr int family() noexcept
+    {
+        return (int)AddressFamily::Local;
+    }
+
+    static constexpr AddressFamily address_family() noexcept
+    {
+        return AddressFamily::Local;
+    }
+};
+
+} // namespace network::local
+} // namespace network
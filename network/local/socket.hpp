@@ -0,0 +1,124 @@
+#pragma once
+#include "endpoint.hpp"
+#include "../socket_impl.hpp"
+
+#include <vector>
+
+namespace network {
+namespace local {
+
+/// Max descriptors passed in one message (linux SCM_MAX_FD).
+const std::size_t max_fds = 253;
+
+/**
+ * Creates pair of connected unix domain sockets
+ * @param _a - slot for the first socket
+ * @param _b - slot for the second socket
+ * @param _type - stream, datagram or seqpacket
+ * @return if sockets were created
+ */
+inline bool socket_pair(socket_impl<protocol>& _a, socket_impl<protocol>& _b, SocketType _type = SocketType::Tcp) noexcept
+{
+    int fds[2];
+    if( ::socketpair(AF_UNIX, (int)_type | SOCK_CLOEXEC, 0, fds) != GOOD )
+        return false;
+    _a = socket_impl<protocol>(base_socket(fds[0]));
+    _b = socket_impl<protocol>(base_socket(fds[1]));
+    return true;
+}
+
+inline bool socket_pair(socket_impl<protocol>& _a, socket_impl<protocol>& _b, SocketType _type, network::error& _error) noexcept
+{
+    return network::detail::set_error(socket_pair(_a, _b, _type), _error);
+}
+
+/**
+ * Sends data together with file descriptors (SCM_RIGHTS)
+ * @param _s - unix domain socket
+ * @param _data - payload, at least one byte is required to carry descriptors
+ * @param _fds - descriptors, they stay owned by caller, receiver gets duplicates
+ * @return sent bytes count or -1 on error, descriptors are sent with the first byte
+ */
+template<class _Socket>
+long long write_with_fds(const _Socket& _s, const char* _data, std::size_t _length,
+                         const std::vector<network::detail::socket_t>& _fds, int _flags = 0) noexcept
+{
+    if( _length == 0 || _fds.size() > max_fds ) {
+        errno = EINVAL;
+        return -1;
+    }
+    iovec iov { const_cast<char*>(_data), _length };
+    msghdr msg { };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int) * max_fds)] { };
+    if( !_fds.empty() ) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * _fds.size());
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * _fds.size());
+        memcpy(CMSG_DATA(cmsg), _fds.data(), sizeof(int) * _fds.size());
+    }
+    return ::sendmsg(_s.socket(), &msg, _flags | network::detail::nosignal);
+}
+
+/**
+ * Receives data together with file descriptors (SCM_RIGHTS)
+ * @param _s - unix domain socket
+ * @param _buff - payload buffer
+ * @param _fds - slot for received descriptors, caller owns them (they are close-on-exec)
+ * @return received bytes count or -1 on error, EMSGSIZE if kernel truncated descriptors
+ */
+template<class _Socket>
+long long read_with_fds(const _Socket& _s, char* _buff, std::size_t _length,
+                        std::vector<network::detail::socket_t>& _fds, int _flags = 0) noexcept
+{
+    iovec iov { _buff, _length };
+    msghdr msg { };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(sizeof(int) * max_fds)] { };
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    _fds.clear();
+    long long size = ::recvmsg(_s.socket(), &msg, _flags | MSG_CMSG_CLOEXEC);
+    if( size == -1 )
+        return -1;
+    for( cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg) ) {
+        if( cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS )
+            continue;
+        const std::size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const std::size_t offset = _fds.size();
+        _fds.resize(offset + n);
+        memcpy(_fds.data() + offset, CMSG_DATA(cmsg), n * sizeof(int));
+    }
+    // More descriptors than max_fds were sent, dropped ones are closed by kernel: partial set is useless.
+    if( msg.msg_flags & MSG_CTRUNC ) {
+        for( auto fd : _fds )
+            network::detail::close(fd);
+        _fds.clear();
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return size;
+}
+
+/**
+ * Credentials of connected peer (SO_PEERCRED), taken by the kernel at connect time
+ * @param _s - connected unix domain socket
+ * @param _peer - slot for peer pid, uid and gid
+ * @return false on error
+ */
+template<class _Socket>
+bool peer_credentials(const _Socket& _s, ucred& _peer) noexcept
+{
+    socklen_t size = sizeof(_peer);
+    return ::getsockopt(_s.socket(), SOL_SOCKET, SO_PEERCRED, &_peer, &size) == GOOD;
+}
+
+} // namespace network::local
+} // namespace network
@@ -0,0 +1,83 @@
+#pragma once
+#include "base_socket.hpp"
+#include "cpu_topology.hpp"
+#include "event_loop.hpp"
+#include "socket_option.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace network {
+
+/// @class loop_group
+/**
+ * Event loops running on their own threads pinned one per CPU
+ * @param Threadsafe - post, accept and dispatch are threadsafe
+ * Each loop is created by its pinned thread, so loop state is first-touched on the
+ * local NUMA node; node_allocator(index) places handlers' buffers there as well.
+ * Loop whose thread couldn't be pinned still runs unpinned, see pinned().
+ * Accepted sockets go to the loop on the CPU which received their packets
+ * (SO_INCOMING_CPU), keeping the data path of a connection on one core.
+ */
+class loop_group
+{
+public:
+    typedef event_loop::task_t task_t;
+    typedef std::function<void(event_loop& _loop, base_socket&& _s)> accept_handler_t;
+
+    /// @see Constructors
+    explicit loop_group(const cpu_topology& _topology = cpu_topology(), std::vector<unsigned> _cpus = { });
+    loop_group(const loop_group& _other) = delete;
+    loop_group& operator=(const loop_group& _other) = delete;
+    ~loop_group() noexcept;
+
+    /// @see Properties
+    std::size_t size() const noexcept;
+    event_loop& loop(std::size_t _index) noexcept;
+    unsigned cpu(std::size_t _index) const noexcept;
+    unsigned node(std::size_t _index) const noexcept;
+    bool pinned(std::size_t _index) const noexcept;
+    int pin_error(std::size_t _index) const noexcept;
+    node_allocator<char> allocator(std::size_t _index) const noexcept;
+    std::size_t index_for_cpu(int _cpu) const noexcept;
+
+    /// @see Tasks
+    void post(std::size_t _index, task_t _task);
+    void stop();
+
+    /// @see Sockets
+    std::size_t dispatch(base_socket&& _s, accept_handler_t _handler);
+    template<class _Socket>
+    bool accept(const _Socket& _listener, accept_handler_t _handler);
+
+private:
+    struct slot
+    {
+        unsigned cpu;
+        unsigned node;
+        unsigned core;
+        unsigned package;
+        /// pin_thread errno, written before the loop is reported started.
+        int pin_error;
+        std::unique_ptr<event_loop> loop;
+        std::thread thread;
+    };
+
+    void run(slot& _slot);
+
+    cpu_topology topology_;
+    std::vector<std::unique_ptr<slot>> slots_;
+    std::mutex ready_mutex_;
+    std::condition_variable ready_;
+    std::size_t started_ { };
+    mutable std::atomic<std::size_t> next_ { };
+    bool stopped_ { false };
+};
+
+#include "impl/loop_group.hpp"
+
+} // namespace network
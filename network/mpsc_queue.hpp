@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace network {
+
+/// @class mpsc_queue
+/**
+ * Unbounded lock-free multi-producer single-consumer queue (Vyukov's intrusive node queue)
+ * @param Threadsafe - push is threadsafe and wait-free, pop and empty must be called by one consumer thread
+ * Values are moved in and out, e.g. buffers are handed over without copying.
+ */
+template<class _T>
+class mpsc_queue
+{
+public:
+    /// @see Constructors
+    mpsc_queue();
+    mpsc_queue(const mpsc_queue& _other) = delete;
+    mpsc_queue& operator=(const mpsc_queue& _other) = delete;
+    ~mpsc_queue() noexcept;
+
+    /// @see Producers
+    void push(_T&& _value);
+
+    /// @see Consumer
+    bool pop(_T& _value);
+    bool empty() const noexcept;
+
+private:
+    struct node
+    {
+        std::atomic<node*> next { nullptr };
+        _T value;
+
+        node() = default;
+        explicit node(_T&& _value)
+            : value(std::move(_value))
+        {
+        }
+    };
+
+    /// Producers append at head, consumer takes from tail, tail is always a consumed (stub) node.
+    /// Padding keeps them on separate cache lines without over-aligning the owner (C++14 new).
+    std::atomic<node*> head_;
+    char padding_[64 - sizeof(std::atomic<node*>)];
+    node* tail_;
+};
+
+#include "impl/mpsc_queue.hpp"
+
+} // namespace network
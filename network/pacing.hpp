@@ -0,0 +1,111 @@
+#pragma once
+#include "event_loop.hpp"
+#include "send_queue.hpp"
+#include "socket_option.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace network {
+
+/// @class token_bucket
+/**
+ * Rate limiter which may be chained: socket bucket -> group bucket -> global bucket
+ * @param Threadsafe - no threadsafe, buckets shared by sockets must live in one loop
+ * Consuming from a bucket consumes from all its ancestors, so bytes available
+ * through bucket are limited by the most restrictive level.
+ */
+class token_bucket
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    /// @see Constructors
+    explicit token_bucket(std::uint64_t _rate = 0, std::uint64_t _burst = 0, token_bucket* _parent = nullptr) noexcept;
+    token_bucket(const token_bucket& _other) = delete;
+    token_bucket& operator=(const token_bucket& _other) = delete;
+
+    /// @see Properties
+    std::uint64_t rate() const noexcept;
+    std::uint64_t burst() const noexcept;
+    void rate(std::uint64_t _rate, std::uint64_t _burst = 0) noexcept;
+    token_bucket* parent() const noexcept;
+    void parent(token_bucket* _parent) noexcept;
+    bool unlimited() const noexcept;
+    std::uint64_t depth() const noexcept;
+
+    /// @see Tokens
+    std::uint64_t available(clock_t::time_point _now = clock_t::now()) noexcept;
+    void consume(std::uint64_t _bytes, clock_t::time_point _now = clock_t::now()) noexcept;
+    std::chrono::nanoseconds delay(std::uint64_t _bytes, clock_t::time_point _now = clock_t::now()) noexcept;
+
+private:
+    void refill(clock_t::time_point _now) noexcept;
+
+    std::uint64_t rate_;
+    std::uint64_t burst_;
+    double tokens_;
+    clock_t::time_point last_;
+    token_bucket* parent_;
+};
+
+/// @class paced_sender
+/**
+ * Write path which keeps egress of one socket within token bucket chain
+ * @param Threadsafe - no threadsafe, must be used from the loop thread
+ * Socket level rate of TCP sockets is delegated to the kernel (SO_MAX_PACING_RATE) when it is supported,
+ * group and global levels are always enforced in user space. Data waits in send_queue
+ * and is released by loop timers as tokens refill.
+ * If sender registers socket itself, loop handler belongs to it, otherwise socket owner
+ * must forward write readiness to on_events and watch write events while wants_write.
+ */
+class paced_sender
+{
+public:
+    static const std::size_t default_quantum = 16 * 1024;
+
+    /// @see Constructors
+    paced_sender(network::event_loop& _loop, network::detail::socket_t _s,
+                 token_bucket* _group = nullptr, bool _register = true);
+    paced_sender(const paced_sender& _other) = delete;
+    paced_sender& operator=(const paced_sender& _other) = delete;
+    ~paced_sender() noexcept;
+
+    /// @see Properties
+    network::detail::socket_t socket() const noexcept;
+    bool rate(std::uint64_t _rate, std::uint64_t _burst = 0, bool _kernel = true) noexcept;
+    bool kernel_paced() const noexcept;
+    token_bucket& bucket() noexcept;
+    send_queue& queue() noexcept;
+    void quantum(std::size_t _bytes) noexcept;
+    bool wants_write() const noexcept;
+    std::uint64_t sent() const noexcept;
+
+    /// @see Sending
+    bool write(const char* _data, std::size_t _length);
+    bool write(std::vector<char>&& _data);
+    void on_events(unsigned _events);
+    void on_error(std::function<void(network::error)> _callback);
+
+private:
+    void flush();
+    void wait_write(bool _on);
+    void schedule(std::chrono::nanoseconds _delay);
+
+    network::event_loop& loop_;
+    network::detail::socket_t s_;
+    token_bucket bucket_;
+    send_queue queue_;
+    std::function<void(network::error)> on_error_;
+    std::size_t quantum_ { default_quantum };
+    std::uint64_t sent_ { };
+    network::event_loop::timer_t timer_ { };
+    bool timer_armed_ { false };
+    bool wants_write_ { false };
+    bool registered_ { false };
+    bool kernel_paced_ { false };
+};
+
+#include "impl/pacing.hpp"
+
+} // namespace network
@@ -0,0 +1,147 @@
+#pragma once
+#include "base_socket.hpp"
+#include "event_loop.hpp"
+#include "send_queue.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace network {
+
+/// @class framed_codec
+/**
+ * Length-prefixed frames: [u32 length][u64 id if correlated][payload], big-endian
+ * Codec concept used by pipeline_client:
+ *  - request_type, response_type
+ *  - static constexpr bool correlated - responses carry ids and may come out of order
+ *  - void encode(std::vector<char>& _out, const request_type& _request, std::uint64_t _id)
+ *    appends encoded request to _out
+ *  - long long decode(const char* _data, std::size_t _length, response_type& _response, std::uint64_t& _id)
+ *    returns consumed bytes count, 0 if response is incomplete, -1 if data is malformed
+ */
+template<bool _Correlated = false>
+class framed_codec
+{
+public:
+    typedef std::vector<char> request_type;
+    typedef std::vector<char> response_type;
+
+    static constexpr bool correlated = _Correlated;
+    static constexpr std::size_t header_len = 4 + (_Correlated ? 8 : 0);
+
+    /// @see Constructors
+    explicit framed_codec(std::size_t _max_frame = 16 << 20) noexcept
+        : max_frame_(_max_frame)
+    {
+    }
+
+    /// @see Codec
+    void encode(std::vector<char>& _out, const request_type& _request, std::uint64_t _id) const
+    {
+        const std::uint32_t len = (std::uint32_t)_request.size();
+        for( int shift = 24; shift >= 0; shift -= 8 )
+            _out.push_back((char)(len >> shift));
+        if( _Correlated ) {
+            for( int shift = 56; shift >= 0; shift -= 8 )
+                _out.push_back((char)(_id >> shift));
+        }
+        _out.insert(_out.end(), _request.begin(), _request.end());
+    }
+
+    long long decode(const char* _data, std::size_t _length, response_type& _response, std::uint64_t& _id) const
+    {
+        if( _length < header_len )
+            return 0;
+        const auto* p = reinterpret_cast<const unsigned char*>(_data);
+        std::uint32_t len = 0;
+        for( int i = 0; i < 4; ++i )
+            len = (len << 8) | p[i];
+        if( len > max_frame_ )
+            return -1;
+        if( _length < header_len + len )
+            return 0;
+        _id = 0;
+        if( _Correlated ) {
+            for( int i = 4; i < 12; ++i )
+                _id = (_id << 8) | p[i];
+        }
+        _response.assign(_data + header_len, _data + header_len + len);
+        return (long long)(header_len + len);
+    }
+
+private:
+    std::size_t max_frame_;
+};
+
+/// @class pipeline_client
+/**
+ * Keeps many requests in flight on one connection
+ * @param Threadsafe - no threadsafe, must be used from the loop thread
+ * Requests issued during one loop iteration are encoded into one buffer and sent
+ * with a single write. Responses are matched by id for correlated codecs and
+ * in FIFO order otherwise. Handlers are invoked from the loop, the client must not
+ * be destroyed from them.
+ */
+template<class _Codec>
+class pipeline_client
+{
+public:
+    typedef typename _Codec::request_type request_type;
+    typedef typename _Codec::response_type response_type;
+    typedef std::function<void(response_type&& _response, network::error _error)> handler_t;
+    typedef std::function<void()> callback_t;
+
+    static const std::size_t default_window = 128;
+
+    /// @see Constructors
+    pipeline_client(network::event_loop& _loop, base_socket&& _s,
+                    std::size_t _window = default_window, _Codec _codec = _Codec());
+    pipeline_client(const pipeline_client& _other) = delete;
+    pipeline_client& operator=(const pipeline_client& _other) = delete;
+    ~pipeline_client() noexcept;
+
+    /// @see Properties
+    bool is_open() const noexcept;
+    std::size_t in_flight() const noexcept;
+    std::size_t window() const noexcept;
+    void window(std::size_t _window) noexcept;
+    void on_window_available(callback_t _callback);
+
+    /// @see Requests
+    bool request(const request_type& _request, handler_t _handler);
+    void close(int _error = ECANCELED);
+
+private:
+    void schedule_flush();
+    void flush();
+    void update_interest();
+    void on_events(unsigned _events);
+    void on_read();
+    bool complete(std::uint64_t _id, response_type&& _response);
+    void check_window();
+
+    network::event_loop& loop_;
+    base_socket s_;
+    std::size_t window_;
+    _Codec codec_;
+    send_queue queue_;
+    std::vector<char> batch_;
+    std::vector<char> rx_;
+    std::size_t rx_begin_ { };
+    std::deque<handler_t> fifo_;
+    std::unordered_map<std::uint64_t, handler_t> by_id_;
+    std::uint64_t next_id_ { };
+    callback_t on_window_available_;
+    std::shared_ptr<char> alive_;
+    bool open_ { false };
+    bool flush_scheduled_ { false };
+    bool window_full_ { false };
+};
+
+#include "impl/pipeline_client.hpp"
+
+} // namespace network
@@ -0,0 +1,53 @@
+#pragma once
+#include "detail/socket.hpp"
+
+#include <cstddef>
+
+namespace network {
+
+/// @class fixed_receive
+/**
+ * Receive policy reading fixed size chunks, default of socket_impl
+ * @param Threadsafe - threadsafe, stateless
+ */
+template<std::size_t _Size = 4096>
+class fixed_receive
+{
+public:
+    static_assert(_Size > 0, "receive size must be positive");
+
+    /// @see Sizing
+    std::size_t size() const noexcept;
+    std::size_t next(network::detail::socket_t _s) const noexcept;
+    void record(std::size_t _requested, std::size_t _received) noexcept;
+};
+
+/// @class adaptive_receive
+/**
+ * Receive policy sizing reads per socket from observed read sizes and pending bytes
+ * @param Threadsafe - no threadsafe, one instance per socket
+ * Size doubles after a read fills the whole buffer and then jumps to FIONREAD if more is
+ * already queued, so bulk flows read up to _Max bytes per call. It halves after two reads
+ * in a row use less than a quarter of it, so chatty sockets keep small buffers.
+ */
+template<std::size_t _Min = 512, std::size_t _Max = 1 << 20, std::size_t _Initial = 4096>
+class adaptive_receive
+{
+public:
+    static_assert(_Min > 0 && _Min <= _Initial && _Initial <= _Max, "bounds must satisfy 0 < min <= initial <= max");
+
+    /// @see Sizing
+    std::size_t size() const noexcept;
+    std::size_t next(network::detail::socket_t _s) noexcept;
+    void record(std::size_t _requested, std::size_t _received) noexcept;
+
+private:
+    std::size_t size_ { _Initial };
+    unsigned short small_reads_ { };
+    /// Last read filled buffer, FIONREAD is worth asking only then.
+    bool full_ { false };
+};
+
+#include "impl/receive_policy.hpp"
+
+} // namespace network
@@ -0,0 +1,140 @@
+#pragma once
+#include "detail/socket.hpp"
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace network {
+
+/// Immutable buffer queued to many send queues without copying, freed after the last one sent it.
+typedef std::shared_ptr<const std::vector<char>> shared_buffer;
+
+inline shared_buffer make_shared_buffer(std::vector<char>&& _data)
+{
+    return std::make_shared<const std::vector<char>>(std::move(_data));
+}
+
+inline shared_buffer make_shared_buffer(const char* _data, std::size_t _length)
+{
+    return std::make_shared<const std::vector<char>>(_data, _data + _length);
+}
+
+/// @class send_queue_budget
+/**
+ * Memory accounting shared by many send queues
+ * @param Threadsafe - threadsafe
+ * Queues acquire bytes from budget before buffering and release them after sending,
+ * so slow consumers all together can't hold more than limit() bytes.
+ */
+class send_queue_budget
+{
+public:
+    /// @see Constructors
+    explicit send_queue_budget(std::size_t _limit = SIZE_MAX) noexcept;
+    send_queue_budget(const send_queue_budget& _other) = delete;
+    send_queue_budget& operator=(const send_queue_budget& _other) = delete;
+
+    /// @see Properties
+    std::size_t limit() const noexcept;
+    void limit(std::size_t _limit) noexcept;
+    std::size_t used() const noexcept;
+
+    /// @see Accounting
+    bool try_acquire(std::size_t _bytes) noexcept;
+    void release(std::size_t _bytes) noexcept;
+
+    /// @see Static
+    static send_queue_budget& global() noexcept;
+private:
+    std::atomic<std::size_t> limit_;
+    std::atomic<std::size_t> used_ { };
+};
+
+/// @class send_queue
+/**
+ * Per-socket outbound queue with high/low watermark backpressure
+ * @param Threadsafe - no threadsafe
+ * Queue stops accepting data once it holds high watermark bytes and becomes writable
+ * again (invoking writable callback) when flush drains it below low watermark.
+ * Shared buffers count towards watermarks but not budget, their memory isn't per queue.
+ */
+class send_queue
+{
+public:
+    typedef std::function<void()> callback_t;
+
+    static const std::size_t default_high_watermark = 1 << 20;
+    static const std::size_t default_low_watermark = 1 << 18;
+
+    /// @see Constructors
+    explicit send_queue(std::size_t _high = default_high_watermark,
+                        std::size_t _low = default_low_watermark,
+                        send_queue_budget& _budget = send_queue_budget::global()) noexcept;
+    send_queue(const send_queue& _other) = delete;
+    send_queue& operator=(const send_queue& _other) = delete;
+    ~send_queue() noexcept;
+
+    /// @see Properties
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    bool writable() const noexcept;
+    std::size_t high_watermark() const noexcept;
+    std::size_t low_watermark() const noexcept;
+    void watermarks(std::size_t _high, std::size_t _low) noexcept;
+    void on_writable(callback_t _callback);
+
+    /// @see Modifiers
+    bool push(const char* _data, std::size_t _length);
+    bool push(std::vector<char>&& _data);
+    bool push(shared_buffer _data);
+    void clear() noexcept;
+
+    /// @see Sending
+    template<class _Socket>
+    bool flush(const _Socket& _s, int _flags = 0);
+    template<class _Socket>
+    bool flush(const _Socket& _s, network::error& _error, int _flags = 0);
+    template<class _Socket>
+    long long flush_some(const _Socket& _s, std::size_t _max_bytes, int _flags = 0);
+
+private:
+    /// Chunks gathered into one send.
+    static const std::size_t gather_max = 64;
+
+    struct chunk
+    {
+        std::vector<char> owned;
+        shared_buffer shared;
+
+        const char* data() const noexcept
+        {
+            return shared ? shared->data() : owned.data();
+        }
+
+        std::size_t size() const noexcept
+        {
+            return shared ? shared->size() : owned.size();
+        }
+    };
+
+    void consume(std::size_t _bytes);
+
+    /// List allocates nothing while empty (deque does), idle queues cost no heap.
+    std::list<chunk> chunks_;
+    std::size_t offset_ { };
+    std::size_t size_ { };
+    /// Bytes of owned chunks, acquired from budget.
+    std::size_t budgeted_ { };
+    std::size_t high_;
+    std::size_t low_;
+    send_queue_budget& budget_;
+    callback_t on_writable_;
+    bool paused_ { false };
+};
+
+#include "impl/send_queue.hpp"
+
+} // namespace network
@@ -0,0 +1,123 @@
+#pragma once
+#include "local/socket.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace network {
+
+namespace detail {
+
+/// Single-producer single-consumer byte ring living in shared memory.
+struct shm_ring_header
+{
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) std::atomic<std::uint32_t> data_seq;
+    std::atomic<std::uint32_t> consumer_waiting;
+    alignas(64) std::atomic<std::uint32_t> space_seq;
+    std::atomic<std::uint32_t> producer_waiting;
+};
+
+struct shm_region_header
+{
+    alignas(64) std::uint64_t magic;
+    std::uint64_t capacity;
+    std::atomic<std::uint32_t> closed;
+};
+
+struct shm_ring
+{
+    shm_ring_header* header { nullptr };
+    char* data { nullptr };
+    std::uint64_t mask { };
+};
+
+} // namespace detail
+
+/// @class shm_transport
+/**
+ * Same-host bidirectional byte stream over shared memory with socket_impl read/write surface
+ * @param Threadsafe - one writer and one reader thread per side
+ * Memory is memfd-backed and holds one SPSC ring per direction. Blocked side spins
+ * for spin() iterations first and then sleeps on futex, so hot paths never enter kernel.
+ * One side creates region and offers it over unix domain socket, the other accepts it.
+ * Region size is sealed, so neither side can truncate it under the other one's mapping.
+ */
+class shm_transport
+{
+public:
+    static const std::size_t default_capacity = 1 << 20;
+    static const unsigned default_spin = 4096;
+
+    /// @see Constructors
+    shm_transport() noexcept = default;
+    shm_transport(shm_transport&& _other) noexcept;
+    shm_transport(const shm_transport& _other) = delete;
+    shm_transport& operator=(shm_transport&& _other) noexcept;
+    shm_transport& operator=(const shm_transport& _other) = delete;
+    ~shm_transport() noexcept;
+
+    /// @see Setup
+    bool create(std::size_t _capacity = default_capacity) noexcept;
+    bool attach(int _memfd) noexcept;
+    template<class _Socket>
+    bool offer(const _Socket& _s, std::size_t _capacity = default_capacity) noexcept;
+    template<class _Socket>
+    bool accept(const _Socket& _s) noexcept;
+    bool close() noexcept;
+
+    /// @see Properties
+    bool is_open() const noexcept;
+    bool peer_closed() const noexcept;
+    std::size_t capacity() const noexcept;
+    int memfd() const noexcept;
+    unsigned spin() const noexcept;
+    void spin(unsigned _iterations) noexcept;
+
+    /// @see IO
+    long long write_some(const char* _data, std::size_t _length) const noexcept;
+    long long read_some(char* _buff, std::size_t _length) const noexcept;
+    bool write_n(const char* _data, int _length, int _flags = 0) const noexcept;
+    bool write_n(const std::vector<char>& _data, int _flags = 0) const noexcept;
+    bool write(const std::string& _data, int _flags = 0) const noexcept;
+    bool read_n(char* _buff, int _length, int _flags = 0) const noexcept;
+    bool read_n(std::vector<char>& _buff, int _flags = 0) const noexcept;
+    template<class _Container>
+    bool read(_Container& _data, int _flags = 0) const;
+    template<class _Container>
+    bool read_until(_Container& _data, char _val, int _flags = 0) const;
+
+private:
+    bool map(int _memfd, std::size_t _length, bool _creator) noexcept;
+    void unmap() noexcept;
+    template<class _Ready>
+    bool wait(std::atomic<std::uint32_t>& _seq, std::atomic<std::uint32_t>& _waiting, const _Ready& _ready) const noexcept;
+    static void notify(std::atomic<std::uint32_t>& _seq, std::atomic<std::uint32_t>& _waiting) noexcept;
+    bool wait_data() const noexcept;
+    bool wait_space() const noexcept;
+    std::uint64_t readable() const noexcept;
+
+    int memfd_ { -1 };
+    void* base_ { nullptr };
+    std::size_t length_ { };
+    /// Copied from region at map, peer can't change it later.
+    std::size_t capacity_ { };
+    detail::shm_region_header* region_ { nullptr };
+    detail::shm_ring tx_;
+    detail::shm_ring rx_;
+    unsigned spin_ { default_spin };
+};
+
+#include "impl/shm_transport.hpp"
+
+} // namespace network
@@ -1,5 +1,16 @@
 #pragma once
 #include "base_socket.hpp"
+#include "busy_poll.hpp"
+#include "receive_policy.hpp"
+#ifndef _WIN32
+#include "file_transfer.hpp"
+#endif
+#include "socket_option.hpp"
+#include "ip/basic_endpoint.hpp"
+#if defined(__linux__)
+#include "timestamping.hpp"
+#endif
+#include <algorithm>
 #include <vector>
 
 namespace network {
@@ -11,27 +22,35 @@ bool Name(_Args&&... _args, error& _error, int _flags = 0) const
     return network::detail::set_error(Name(std::forward<_Args>(_args)..., _flags), _error);     \
 }
 
-template<class _InternetProtocol>
+/**
+ * @param _InternetProtocol - protocol family
+ * @param _ReceivePolicy - read sizing of read and read_until, e.g. adaptive_receive<> for bulk flows
+ */
+template<class _InternetProtocol, class _ReceivePolicy = fixed_receive<>>
 class socket_impl
 {
 private:
+    /// Repeats send or recv until whole length is transferred, false on error or shutdown.
     template<class _CharT, class _FuncT>
-    bool io_n(_CharT _data, int _length, const _FuncT& _func, int _flags = 0) const noexcept
+    bool io_n(_CharT _data, std::size_t _length, const _FuncT& _func, int _flags = 0) const noexcept
     {
-        long long size { };
         std::size_t global = 0;
-        while( global + chunk_size < _length ) {
-            size = ::send(socket(), _data + global, chunk_size, _flags);
-            if( size == -1 )
+        while( global < _length ) {
+            const long long size = _func(socket(), _data + global, _length - global, _flags);
+            if( size == -1 && network::detail::last_error() == EINTR )
+                continue;
+            if( size <= 0 )
                 return false;
-            global += size;
+            global += (std::size_t)size;
         }
-        size = ::send(socket(), _data + global, _length - global, _flags);
-        return size != -1;
+        return true;
     }
 
 public:
     typedef base_socket impl_type;
+    typedef _ReceivePolicy receive_policy;
+    typedef typename ip::detail::protocol_endpoint<_InternetProtocol>::type endpoint_type;
+    /// Read size of default receive policy.
     static const long long chunk_size = 4096;
 
     socket_impl() noexcept = default;
@@ -44,11 +63,32 @@ public:
     {
         static_assert(_InternetProtocol::family(), "");
     }
+    /// Creates socket tuned with profile, options of other families or types are skipped, failed ones are ignored.
+    template<class... _Options>
+    socket_impl(SocketType _type, const socket_profile<_Options...>& _profile) noexcept
+        : socket_impl(_type)
+    {
+        _profile.apply(*this, _type, _InternetProtocol::address_family());
+    }
+    /// Creates socket tuned with profile, _error is set if socket or any applicable option failed.
+    template<class... _Options>
+    socket_impl(SocketType _type, const socket_profile<_Options...>& _profile, network::error& _error) noexcept
+        : socket_impl(_type)
+    {
+        if( socket() == network::detail::invalid_socket )
+            _error = network::detail::last_error();
+        else
+            _profile.apply(*this, _type, _InternetProtocol::address_family(), _error);
+    }
+    explicit socket_impl(base_socket&& _s) noexcept
+        : s_(std::move(_s))
+    {
+    }
     socket_impl(socket_impl&& _other) noexcept = default;
-    socket_impl(const socket_impl& _other) noexcept = default;
+    socket_impl(const socket_impl& _other) = delete;
 
     socket_impl& operator=(socket_impl&& _other) noexcept = default;
-    socket_impl& operator=(const socket_impl& _other) noexcept = default;
+    socket_impl& operator=(const socket_impl& _other) = delete;
 
     bool is_open() const noexcept
     {
@@ -60,16 +100,46 @@ public:
         return is_open_ &= s_.close();
     }
 
-    bool open(const ip::endpoint& _ep, int _n = INT_MAX) noexcept
+    template<class _Endpoint>
+    bool open(const _Endpoint& _ep, int _n = INT_MAX) noexcept
     {
         return is_open_ |=  s_.bind(_ep) && s_.listen(_n) ;
     }
 
-    bool open(const ip::endpoint& _ep, network::error& _error, int _n = INT_MAX) noexcept
+    template<class _Endpoint>
+    bool open(const _Endpoint& _ep, network::error& _error, int _n = INT_MAX) noexcept
     {
         return is_open_ |= s_.bind(_ep, _error) && s_.listen(_error, _n);
     }
 
+    /// Binds without listening, e.g. datagram sockets.
+    template<class _Endpoint, class... _Args>
+    bool bind(const _Endpoint& _ep, _Args&&... _args) noexcept
+    {
+        return is_open_ |= s_.bind(_ep, std::forward<_Args>(_args)...);
+    }
+
+    /// Takes over already bound or connected descriptor without re-binding, e.g. received by handoff.
+    /// Fails and leaves _s untouched if its address family differs from protocol one.
+    bool adopt(base_socket&& _s) noexcept
+    {
+        sockaddr_storage address { };
+        socklen_t size = sizeof(address);
+        if( ::getsockname(_s.socket(), reinterpret_cast<network::detail::sockaddr_t*>(&address), &size) != GOOD
+            || address.ss_family != _InternetProtocol().family() )
+            return false;
+        s_ = std::move(_s);
+        is_open_ = true;
+        return true;
+    }
+
+    /// Gives descriptor up, e.g. to splice_proxy or http::server, socket isn't open afterwards.
+    base_socket release() noexcept
+    {
+        is_open_ = false;
+        return base_socket(s_.exchange());
+    }
+
     template<class... _Args>
     bool accept(socket_impl& _s, _Args&&... _args) const noexcept
     {
@@ -82,11 +152,97 @@ public:
         return s_.connect(std::forward<_Args>(_args)...);
     }
 
+    template<class... _Args>
+    bool non_blocking(_Args&&... _args) const noexcept
+    {
+        return s_.non_blocking(std::forward<_Args>(_args)...);
+    }
+
     network::detail::socket_t socket() const noexcept
     {
         return s_.socket();
     }
 
+    template<class _Option, class... _Args>
+    bool set_option(const _Option& _option, _Args&&... _args) const noexcept
+    {
+        static_assert(option::detail::applies_to_protocol<_Option, _InternetProtocol>::value,
+                      "option doesn't apply to socket protocol family");
+        return s_.set_option(_option, std::forward<_Args>(_args)...);
+    }
+
+    template<class _Option, class... _Args>
+    bool get_option(_Option& _option, _Args&&... _args) const noexcept
+    {
+        static_assert(option::detail::applies_to_protocol<_Option, _InternetProtocol>::value,
+                      "option doesn't apply to socket protocol family");
+        return s_.get_option(_option, std::forward<_Args>(_args)...);
+    }
+
+    template<class... _Options, class... _Args>
+    bool apply(const socket_profile<_Options...>& _profile, _Args&&... _args) const noexcept
+    {
+        return _profile.apply(*this, std::forward<_Args>(_args)...);
+    }
+
+    /// Sends without blocking, returns sent bytes count, 0 if would block, -1 on error.
+    long long write_some(const char* _data, std::size_t _length, int _flags = 0) const noexcept
+    {
+        return network::detail::send_some(socket(), _data, _length, _flags);
+    }
+
+
+#ifndef _WIN32
+    /// Sends file range (sendfile on linux), offset advances by sent bytes, 0 if would block, -1 on error.
+    long long send_file(int _fd, std::uint64_t& _offset, std::size_t _length) const noexcept
+    {
+        return network::detail::send_file(socket(), _fd, _offset, _length);
+    }
+
+    /// Continues header, file range and trailer transfer until socket would block, see file_transfer.
+    long long send_file(file_transfer& _transfer) const
+    {
+        return _transfer.send(socket());
+    }
+#endif
+
+    /// Enables kernel busy polling for blocking reads, see busy_poller::enable_kernel.
+    bool busy_poll(std::chrono::microseconds _usec, bool _prefer = true) const noexcept
+    {
+        return busy_poller::enable_kernel(socket(), _usec, _prefer);
+    }
+
+    /// Receives spinning before blocking, returns received bytes count, 0 on shutdown, -1 on error.
+    long long read_some(char* _buff, std::size_t _length, busy_poller& _poller, int _flags = 0) const
+    {
+        return _poller.read_some(socket(), _buff, _length, _flags);
+    }
+
+#if defined(__linux__)
+    /// Receives with kernel rx timestamps, see read_with_timestamps.
+    long long read_some(char* _buff, std::size_t _length, packet_timestamps& _timestamps, int _flags = 0) const noexcept
+    {
+        return read_with_timestamps(socket(), _buff, _length, _timestamps, _flags);
+    }
+#endif
+
+    /// Sends datagram, returns sent bytes count or -1 on error.
+    long long write_to(const char* _data, std::size_t _length, const endpoint_type& _ep, int _flags = 0) const noexcept
+    {
+        if( !network::detail::check_endpoint(_ep) )
+            return -1;
+        return ::sendto(socket(), _data, _length, _flags | network::detail::nosignal, _ep, (socklen_t)_ep.size());
+    }
+
+    /// Receives datagram and its source, returns received bytes count or -1 on error.
+    long long read_from(char* _buff, std::size_t _length, endpoint_type& _ep, int _flags = 0) const noexcept
+    {
+        socklen_t size = (socklen_t)_ep.capacity();
+        const long long received = ::recvfrom(socket(), _buff, _length, _flags, _ep, &size);
+        if( received >= 0 )
+            network::detail::endpoint_resize(_ep, size, 0);
+        return received;
+    }
 
     bool write_n(const char* _data, int _length, int _flags = 0) const noexcept
     {
@@ -111,40 +267,49 @@ public:
 
     bool read_n(std::vector<char>& _buff, int _flags = 0) const noexcept
     {
-        return io_n(_buff.data(), _buff.size(), _flags);
+        return read_n(_buff.data(), _buff.size(), _flags);
     }
 
+    const receive_policy& receive() const noexcept
+    {
+        return receive_;
+    }
+
+    /// Receives while reads fill the buffer sized by receive policy.
     template<class _Container>
     bool read(_Container& _data, int _flags = 0) const
     {
         _data.clear();
+        std::size_t length;
         long long size;
         do {
-            typename _Container::value_type bytes[chunk_size + 1]{ };
-            size = ::recv(socket(), bytes, chunk_size, _flags);
+            length = receive_.next(socket());
+            size = receive_some(_data, length, _flags);
             if( size == -1 )
                 return false;
-            _data.assign(bytes, bytes + size);
-        } while( size == chunk_size );
+        } while( (std::size_t)size == length );
         return true;
     }
 
+    /// Receives until value (excluded), bytes after it in the same read are dropped.
     template<class _Container>
     bool read_until(_Container& _data, char _val, int _flags = 0) const
     {
         _data.clear();
+        std::size_t length;
         long long size;
-        typename _Container::value_type* end;
-        typename _Container::value_type* it;
         do {
-            typename _Container::value_type bytes[chunk_size + 1]{ };
-            size = ::recv(socket(), bytes, chunk_size, _flags);
+            length = receive_.next(socket());
+            const std::size_t offset = _data.size();
+            size = receive_some(_data, length, _flags);
             if( size == -1 )
                 return false;
-            end = bytes + size;
-            it = std::find(bytes, end + 1, _val);
-            _data.assign(bytes, it);
-        } while( size == chunk_size && it != end + 1 );
+            const auto it = std::find(_data.begin() + offset, _data.end(), _val);
+            if( it != _data.end() ) {
+                _data.erase(it, _data.end());
+                break;
+            }
+        } while( (std::size_t)size == length );
         return true;
     }
     SOCKET_IMPL_METHOD_WITH_ERROR_SET_MACRO(write_n)
@@ -152,8 +317,22 @@ public:
     SOCKET_IMPL_METHOD_WITH_ERROR_SET_MACRO(read_n)
     SOCKET_IMPL_METHOD_WITH_ERROR_SET_MACRO(read)
 private:
+    /// Appends one read of at most _length bytes straight into container.
+    template<class _Container>
+    long long receive_some(_Container& _data, std::size_t _length, int _flags) const
+    {
+        const std::size_t offset = _data.size();
+        _data.resize(offset + _length);
+        const long long size = ::recv(socket(), reinterpret_cast<char*>(&_data[offset]), _length, _flags);
+        _data.resize(offset + (size > 0 ? (std::size_t)size : 0));
+        if( size != -1 )
+            receive_.record(_length, (std::size_t)size);
+        return size;
+    }
+
     base_socket s_;
     bool is_open_ { false };
+    mutable receive_policy receive_;
 };
 
 
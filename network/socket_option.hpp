@@ -0,0 +1,353 @@
+#pragma once
+#include "detail/socket.hpp"
+#include "ip/internet_protocol.hpp"
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace network {
+namespace option {
+
+/// Socket types option applies to.
+const unsigned tcp = 1u << 0;
+const unsigned udp = 1u << 1;
+const unsigned seqpacket = 1u << 2;
+const unsigned any_type = tcp | udp | seqpacket;
+
+/// Address families option applies to.
+const unsigned v4 = 1u << 0;
+const unsigned v6 = 1u << 1;
+const unsigned unix_domain = 1u << 2;
+const unsigned inet = v4 | v6;
+const unsigned any_family = inet | unix_domain;
+
+constexpr unsigned type_mask(SocketType _type) noexcept
+{
+    return _type == SocketType::Tcp ? tcp
+         : _type == SocketType::Udp ? udp
+         : _type == SocketType::SeqPacket ? seqpacket : 0u;
+}
+
+constexpr unsigned family_mask(AddressFamily _family) noexcept
+{
+    return _family == AddressFamily::Ipv4 ? v4
+         : _family == AddressFamily::Ipv6 ? v6
+         : _family == AddressFamily::Local ? unix_domain : 0u;
+}
+
+/// @class basic_option
+/**
+ * Compile-time description of setsockopt option together with its value
+ * @param _Level - option level (SOL_SOCKET, IPPROTO_TCP...)
+ * @param _Name - option name
+ * @param _T - value type, it is passed to the kernel as int
+ * @param _Types - socket types mask option applies to
+ * @param _Families - address families mask option applies to
+ */
+template<int _Level, int _Name, class _T, unsigned _Types = any_type, unsigned _Families = any_family>
+class basic_option
+{
+public:
+    typedef _T value_type;
+
+    /// @see Constructors
+    constexpr basic_option(value_type _value = value_type()) noexcept
+        : native_(static_cast<int>(_value))
+    {
+    }
+
+    /// @see Traits
+    static constexpr int level() noexcept
+    {
+        return _Level;
+    }
+
+    static constexpr int name() noexcept
+    {
+        return _Name;
+    }
+
+    static constexpr unsigned types() noexcept
+    {
+        return _Types;
+    }
+
+    static constexpr unsigned families() noexcept
+    {
+        return _Families;
+    }
+
+    static constexpr bool applies_to(SocketType _type) noexcept
+    {
+        return (_Types & type_mask(_type)) != 0;
+    }
+
+    static constexpr bool applies_to(AddressFamily _family) noexcept
+    {
+        return (_Families & family_mask(_family)) != 0;
+    }
+
+    /// @see Value
+    constexpr value_type value() const noexcept
+    {
+        return static_cast<value_type>(native_);
+    }
+
+    void value(value_type _value) noexcept
+    {
+        native_ = static_cast<int>(_value);
+    }
+
+    const void* data() const noexcept
+    {
+        return &native_;
+    }
+
+    void* data() noexcept
+    {
+        return &native_;
+    }
+
+    static constexpr socklen_t size() noexcept
+    {
+        return sizeof(int);
+    }
+
+private:
+    int native_;
+};
+
+using reuse_address = basic_option<SOL_SOCKET, SO_REUSEADDR, bool>;
+using keep_alive = basic_option<SOL_SOCKET, SO_KEEPALIVE, bool, tcp, inet>;
+/// Linux reports twice the requested value back to account bookkeeping overhead.
+using receive_buffer_size = basic_option<SOL_SOCKET, SO_RCVBUF, int>;
+using send_buffer_size = basic_option<SOL_SOCKET, SO_SNDBUF, int>;
+using no_delay = basic_option<IPPROTO_TCP, TCP_NODELAY, bool, tcp, inet>;
+using v6_only = basic_option<IPPROTO_IPV6, IPV6_V6ONLY, bool, any_type, v6>;
+/// Multicast datagrams sent by socket are delivered to local receivers too.
+using multicast_loop_v4 = basic_option<IPPROTO_IP, IP_MULTICAST_LOOP, bool, udp, v4>;
+using multicast_loop_v6 = basic_option<IPPROTO_IPV6, IPV6_MULTICAST_LOOP, bool, udp, v6>;
+/// Hop limit (TTL) of outgoing multicast datagrams.
+using multicast_hops_v4 = basic_option<IPPROTO_IP, IP_MULTICAST_TTL, int, udp, v4>;
+using multicast_hops_v6 = basic_option<IPPROTO_IPV6, IPV6_MULTICAST_HOPS, int, udp, v6>;
+/// Index of interface outgoing ipv6 multicast datagrams leave from, see multicast_interface_v4.
+using multicast_interface_v6 = basic_option<IPPROTO_IPV6, IPV6_MULTICAST_IF, unsigned, udp, v6>;
+
+#if defined(__linux__)
+/// Not sticky, kernel may return to delayed acks after a while.
+using quick_ack = basic_option<IPPROTO_TCP, TCP_QUICKACK, bool, tcp, inet>;
+/// Microseconds to busy poll device queue on blocking reads.
+using busy_poll = basic_option<SOL_SOCKET, SO_BUSY_POLL, int, any_type, inet>;
+#if defined(SO_PREFER_BUSY_POLL)
+/// Busy polling takes precedence over interrupts (Linux 5.11), see busy_poller.
+using prefer_busy_poll = basic_option<SOL_SOCKET, SO_PREFER_BUSY_POLL, bool, any_type, inet>;
+/// Packets processed per busy poll iteration, raising it above 8 requires CAP_NET_ADMIN.
+using busy_poll_budget = basic_option<SOL_SOCKET, SO_BUSY_POLL_BUDGET, int, any_type, inet>;
+#endif
+/// Bytes of unsent data above which socket isn't reported writable.
+using not_sent_low_watermark = basic_option<IPPROTO_TCP, TCP_NOTSENT_LOWAT, int, tcp, inet>;
+/// Seconds listening socket waits for data before waking accept.
+using defer_accept = basic_option<IPPROTO_TCP, TCP_DEFER_ACCEPT, int, tcp, inet>;
+/// CPU which processed socket's last received packets, read-only for connected sockets.
+using incoming_cpu = basic_option<SOL_SOCKET, SO_INCOMING_CPU, int, any_type, inet>;
+/// Datagrams carry their destination address (and interface) as ancillary data.
+using packet_info_v4 = basic_option<IPPROTO_IP, IP_PKTINFO, bool, udp, v4>;
+using packet_info_v6 = basic_option<IPPROTO_IPV6, IPV6_RECVPKTINFO, bool, udp, v6>;
+
+/// @class max_pacing_rate
+/**
+ * Bytes per second kernel paces socket at: TCP internal pacing or fq qdisc
+ * Kernel accepts the option for any socket but paces other ones only under fq.
+ * Rates above 32 bits are passed as 64-bit value (Linux 4.20), ~0 removes the limit.
+ */
+class max_pacing_rate
+{
+public:
+    typedef std::uint64_t value_type;
+
+    /// @see Constructors
+    constexpr max_pacing_rate(value_type _value = ~value_type()) noexcept
+        : value_(_value)
+        , narrow_(_value > UINT32_MAX ? UINT32_MAX : (std::uint32_t)_value)
+    {
+    }
+
+    /// @see Traits
+    static constexpr int level() noexcept
+    {
+        return SOL_SOCKET;
+    }
+
+    static constexpr int name() noexcept
+    {
+        return SO_MAX_PACING_RATE;
+    }
+
+    static constexpr unsigned types() noexcept
+    {
+        return any_type;
+    }
+
+    static constexpr unsigned families() noexcept
+    {
+        return inet;
+    }
+
+    static constexpr bool applies_to(SocketType _type) noexcept
+    {
+        return (types() & type_mask(_type)) != 0;
+    }
+
+    static constexpr bool applies_to(AddressFamily _family) noexcept
+    {
+        return (families() & family_mask(_family)) != 0;
+    }
+
+    /// @see Value
+    constexpr value_type value() const noexcept
+    {
+        return value_;
+    }
+
+    /// 32-bit value while it fits, so older kernels get it as well.
+    const void* data() const noexcept
+    {
+        return fits() ? (const void*)&narrow_ : (const void*)&value_;
+    }
+
+    socklen_t size() const noexcept
+    {
+        return fits() ? sizeof(narrow_) : sizeof(value_);
+    }
+
+private:
+    constexpr bool fits() const noexcept
+    {
+        return value_ <= UINT32_MAX || value_ == ~value_type();
+    }
+
+    value_type value_;
+    std::uint32_t narrow_;
+};
+#endif
+
+namespace detail {
+
+/// Families mask of protocol known at compile time, any_family otherwise.
+template<class _InternetProtocol>
+struct protocol_families
+{
+    static constexpr unsigned value = any_family;
+};
+
+template<AddressFamily _Family>
+struct protocol_families<network::ip::internet_protocol<_Family>>
+{
+    static constexpr unsigned value = family_mask(_Family);
+};
+
+template<class _Option, class _InternetProtocol>
+struct applies_to_protocol
+{
+    static constexpr bool value = (_Option::families() & protocol_families<_InternetProtocol>::value) != 0;
+};
+
+} // namespace detail
+} // namespace option
+
+
+/// @class socket_profile
+/**
+ * Set of options applied to socket in one call, e.g. per-service latency or throughput tuning
+ * Options which don't apply to the socket type or address family are skipped.
+ */
+template<class... _Options>
+class socket_profile
+{
+public:
+    /// @see Constructors
+    constexpr socket_profile(_Options... _options) noexcept
+        : options_(_options...)
+    {
+    }
+
+    /**
+     * Sets all applicable options
+     * @param _s - socket (base_socket or socket_impl), its type and family are queried
+     * @return false if socket can't be queried or any option failed, remaining options are still applied
+     */
+    template<class _Socket>
+    bool apply(const _Socket& _s) const noexcept
+    {
+        SocketType type;
+        return network::detail::socket_type(_s.socket(), type) && apply(_s, type);
+    }
+
+    /// Sets options applicable to _type, address family is queried from the socket.
+    template<class _Socket>
+    bool apply(const _Socket& _s, SocketType _type) const noexcept
+    {
+        AddressFamily family;
+        return network::detail::socket_family(_s.socket(), family) && apply(_s, _type, family);
+    }
+
+    /// Sets options applicable to _type and _family, e.g. when they are known at compile time.
+    template<class _Socket>
+    bool apply(const _Socket& _s, SocketType _type, AddressFamily _family) const noexcept
+    {
+        return apply(_s, _type, _family, std::index_sequence_for<_Options...>{ });
+    }
+
+    template<class _Socket>
+    bool apply(const _Socket& _s, network::error& _error) const noexcept
+    {
+        return network::detail::set_error(apply(_s), _error);
+    }
+
+    template<class _Socket>
+    bool apply(const _Socket& _s, SocketType _type, network::error& _error) const noexcept
+    {
+        return network::detail::set_error(apply(_s, _type), _error);
+    }
+
+    template<class _Socket>
+    bool apply(const _Socket& _s, SocketType _type, AddressFamily _family, network::error& _error) const noexcept
+    {
+        return network::detail::set_error(apply(_s, _type, _family), _error);
+    }
+
+    /// Accepts connection and applies profile to it, type and family are queried from the accepted socket.
+    template<class _Socket>
+    bool accept(const _Socket& _listener, _Socket& _s) const noexcept
+    {
+        return _listener.accept(_s) && apply(_s);
+    }
+
+private:
+    template<class _Socket, std::size_t... _I>
+    bool apply(const _Socket& _s, SocketType _type, AddressFamily _family, std::index_sequence<_I...>) const noexcept
+    {
+        bool ok = true;
+        const bool results[] { true, (ok &= apply_one(_s, _type, _family, std::get<_I>(options_)))... };
+        (void)results;
+        return ok;
+    }
+
+    template<class _Socket, class _Option>
+    static bool apply_one(const _Socket& _s, SocketType _type, AddressFamily _family, const _Option& _option) noexcept
+    {
+        return !_Option::applies_to(_type) || !_Option::applies_to(_family)
+            || network::detail::set_option(_s.socket(), _option);
+    }
+
+    std::tuple<_Options...> options_;
+};
+
+template<class... _Options>
+constexpr socket_profile<_Options...> make_socket_profile(_Options... _options) noexcept
+{
+    return socket_profile<_Options...>(_options...);
+}
+
+} // namespace network
@@ -0,0 +1,104 @@
+#pragma once
+#include "base_socket.hpp"
+#include "event_loop.hpp"
+#include "mpsc_queue.hpp"
+#include "send_queue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace network {
+
+/// Socket attached to socket_writer, generation tells apart sockets reusing one descriptor.
+struct writer_handle
+{
+    network::detail::socket_t s { network::detail::invalid_socket };
+    std::uint32_t generation { };
+};
+
+/// @class socket_writer
+/**
+ * Writes to sockets of one event loop on behalf of any thread
+ * @param Threadsafe - write and close are threadsafe, the rest must be called from the loop thread
+ * Worker threads hand buffers over (moved, never copied) through lock-free queue, the loop
+ * thread is the only writer of each socket, so no per-socket mutex is needed. Operations of
+ * one worker are applied in order; writer must outlive the loop iterations that apply them.
+ */
+class socket_writer
+{
+public:
+    typedef std::function<void(writer_handle _handle, unsigned _events)> read_handler_t;
+    typedef std::function<void(writer_handle _handle)> close_handler_t;
+
+    /// @see Constructors
+    explicit socket_writer(event_loop& _loop,
+                           std::size_t _high = send_queue::default_high_watermark,
+                           std::size_t _low = send_queue::default_low_watermark);
+    socket_writer(const socket_writer& _other) = delete;
+    socket_writer& operator=(const socket_writer& _other) = delete;
+    ~socket_writer() noexcept;
+
+    /// @see Loop thread
+    writer_handle attach(base_socket&& _s, read_handler_t _on_read, close_handler_t _on_close = nullptr);
+    bool contains(writer_handle _handle) const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t queued(writer_handle _handle) const noexcept;
+
+    /// @see Any thread
+    void write(writer_handle _handle, std::vector<char>&& _data);
+    void close(writer_handle _handle);
+
+private:
+    enum class Op : unsigned char
+    {
+        Write,
+        Close
+    };
+
+    struct operation
+    {
+        writer_handle handle;
+        Op op { Op::Write };
+        std::vector<char> data;
+    };
+
+    struct connection
+    {
+        base_socket s;
+        std::uint32_t generation;
+        send_queue queue;
+        read_handler_t on_read;
+        close_handler_t on_close;
+        unsigned events { event_loop::read };
+        bool closing { false };
+
+        connection(std::size_t _high, std::size_t _low)
+            : queue(_high, _low)
+        {
+        }
+    };
+
+    void submit(operation&& _operation);
+    void drain();
+    void apply(operation& _operation);
+    connection* find(writer_handle _handle) const noexcept;
+    void on_events(connection& _c, unsigned _events);
+    void update(connection& _c);
+    void finish(connection& _c);
+
+    event_loop& loop_;
+    mpsc_queue<operation> operations_;
+    std::atomic<bool> scheduled_ { false };
+    std::unordered_map<network::detail::socket_t, std::unique_ptr<connection>> connections_;
+    std::size_t high_;
+    std::size_t low_;
+    std::uint32_t next_generation_ { 1 };
+};
+
+#include "impl/socket_writer.hpp"
+
+} // namespace network
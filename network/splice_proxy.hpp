@@ -0,0 +1,94 @@
+#pragma once
+#include "base_socket.hpp"
+#include "event_loop.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+
+namespace network {
+
+/// @class splice_proxy
+/**
+ * Bidirectional relay between two connected stream sockets on event loop
+ * @param Threadsafe - no threadsafe, runs on the loop thread
+ * Each direction moves data socket -> pipe -> socket with splice, so payload never enters
+ * user space. EOF of one side is propagated as shutdown(SHUT_WR) to the other one after
+ * buffered data; proxy closes when both directions finished, on error or when idle.
+ * Writing to a socket whose peer is gone fails with EPIPE instead of raising SIGPIPE,
+ * unless the process already ignores SIGPIPE it is blocked for that splice only.
+ */
+class splice_proxy
+{
+public:
+    /// Invoked once proxy closed, it may destroy proxy.
+    typedef std::function<void()> close_handler_t;
+
+    static const std::size_t default_pipe_size = 64 << 10;
+
+    /// @see Constructors
+    splice_proxy(event_loop& _loop, base_socket&& _a, base_socket&& _b,
+                 std::chrono::milliseconds _idle_timeout = std::chrono::milliseconds(0),
+                 std::size_t _pipe_size = default_pipe_size);
+    splice_proxy(const splice_proxy& _other) = delete;
+    splice_proxy& operator=(const splice_proxy& _other) = delete;
+    ~splice_proxy() noexcept;
+
+    /// @see Properties
+    std::uint64_t a_to_b() const noexcept;
+    std::uint64_t b_to_a() const noexcept;
+    bool running() const noexcept;
+    bool timed_out() const noexcept;
+    int error() const noexcept;
+    void on_close(close_handler_t _handler);
+
+    /// @see Running
+    bool start();
+    void close();
+
+private:
+    struct direction
+    {
+        network::detail::socket_t from;
+        network::detail::socket_t to;
+        int pipe[2] { -1, -1 };
+        /// Bytes held in pipe.
+        std::size_t pending { };
+        std::uint64_t forwarded { };
+        bool eof { false };
+        bool shut { false };
+    };
+
+    bool pump(direction& _d);
+    void on_events(network::detail::socket_t _s, unsigned _events);
+    void update();
+    unsigned interest(network::detail::socket_t _s) const noexcept;
+    void arm_idle_timer(std::chrono::milliseconds _delay);
+    void release() noexcept;
+
+    event_loop& loop_;
+    base_socket a_;
+    base_socket b_;
+    direction forward_;
+    direction backward_;
+    std::chrono::milliseconds idle_timeout_;
+    std::size_t pipe_size_;
+    event_loop::clock_t::time_point last_activity_;
+    event_loop::timer_t idle_timer_ { };
+    close_handler_t on_close_;
+    unsigned a_events_ { };
+    unsigned b_events_ { };
+    int error_ { };
+    bool running_ { false };
+    bool timed_out_ { false };
+    /// SIGPIPE isn't ignored by the process, output splice has to block it.
+    bool guard_sigpipe_ { true };
+};
+
+#include "impl/splice_proxy.hpp"
+
+} // namespace network
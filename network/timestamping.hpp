@@ -0,0 +1,79 @@
+#pragma once
+#include "detail/socket.hpp"
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+
+namespace network {
+
+namespace timestamp {
+
+/// SO_TIMESTAMPING flag sets, they may be combined.
+const unsigned software_rx = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+const unsigned hardware_rx = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+/// Tx timestamps are queued to the error queue with send byte offset (TCP) or datagram number as id.
+const unsigned software_tx = SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+                           | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+const unsigned hardware_tx = SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                           | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+/// Packet left qdisc, i.e. time spent in traffic shaping.
+const unsigned scheduled_tx = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+/// All bytes were acknowledged by peer (TCP only).
+const unsigned acked_tx = SOF_TIMESTAMPING_TX_ACK | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+const unsigned software = software_rx | software_tx;
+const unsigned hardware = hardware_rx | hardware_tx;
+
+/// Tx timestamp kinds.
+enum class Type : unsigned
+{
+    Sent = SCM_TSTAMP_SND,
+    Scheduled = SCM_TSTAMP_SCHED,
+    Acked = SCM_TSTAMP_ACK
+};
+
+} // namespace timestamp
+
+/// Kernel timestamps of received data, zero if not reported.
+struct packet_timestamps
+{
+    /// CLOCK_REALTIME when packet reached the stack.
+    std::chrono::nanoseconds software { };
+    /// NIC clock (PTP hardware clock), not comparable with system clocks unless NIC is synchronized.
+    std::chrono::nanoseconds hardware { };
+
+    /// Time packet waited between the stack and the reading thread.
+    std::chrono::nanoseconds age() const noexcept;
+};
+
+/// Tx completion timestamp read from the error queue.
+struct tx_timestamp
+{
+    /// Byte offset of the last byte of the send call (TCP) or datagram number (UDP), counted from enabling.
+    std::uint32_t id { };
+    timestamp::Type type { timestamp::Type::Sent };
+    std::chrono::nanoseconds software { };
+    std::chrono::nanoseconds hardware { };
+};
+
+bool enable_timestamping(network::detail::socket_t _s, unsigned _flags = timestamp::software) noexcept;
+bool enable_timestamping(network::detail::socket_t _s, unsigned _flags, network::error& _error) noexcept;
+bool enable_hardware_timestamping(network::detail::socket_t _s, const char* _interface, bool _tx = true, bool _rx = true) noexcept;
+
+long long read_with_timestamps(network::detail::socket_t _s, char* _buff, std::size_t _length,
+                               packet_timestamps& _timestamps, int _flags = 0) noexcept;
+long long read_tx_timestamps(network::detail::socket_t _s, std::vector<tx_timestamp>& _timestamps);
+
+std::chrono::nanoseconds realtime_now() noexcept;
+void record_age(latency_histogram& _histogram, const packet_timestamps& _timestamps) noexcept;
+
+#include "impl/timestamping.hpp"
+
+} // namespace network
@@ -0,0 +1,244 @@
+/**
+ * Tail latency of balancing_client against round robin under uneven backend load
+ * Build: g++ -std=c++14 -O2 -I. tools/balancer_tail.cpp -o balancer_tail
+ * Usage: balancer_tail [--backends N] [--slow-ms MS] [--rate REQUESTS_PER_SEC] [--duration SEC]
+ *                      [--hedge PERCENTILE]
+ * Starts N framed echo backends on loopback, the first one answers after --slow-ms, and
+ * offers the same open-loop load through round robin over pipeline_clients and through
+ * balancing_client (with hedging if --hedge is given) after half a second of warm-up.
+ * Everything runs on one loop, so absolute numbers include backend work; compare the rows.
+ */
+#include "network/balancing_client.hpp"
+#include "network/event_loop.hpp"
+#include "network/ip/literals.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/socket_impl.hpp"
+#include "network/socket_option.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock clock_t;
+typedef network::framed_codec<false> codec_t;
+typedef std::function<bool(const codec_t::request_type&, network::pipeline_client<codec_t>::handler_t)> issue_t;
+
+struct config
+{
+    std::size_t backends { 4 };
+    unsigned slow_ms { 20 };
+    double rate { 5000 };
+    double duration { 3 };
+    double hedge { 0 };
+};
+
+void usage()
+{
+    std::fprintf(stderr, "usage: balancer_tail [--backends N] [--slow-ms MS] [--rate REQUESTS_PER_SEC]\n"
+                         "                     [--duration SEC] [--hedge PERCENTILE]\n");
+}
+
+bool parse_args(int _argc, char** _argv, config& _config)
+{
+    for( int i = 1; i + 1 < _argc; i += 2 ) {
+        const std::string arg = _argv[i];
+        const char* value = _argv[i + 1];
+        if( arg == "--backends" )
+            _config.backends = (std::size_t)std::strtoull(value, nullptr, 10);
+        else if( arg == "--slow-ms" )
+            _config.slow_ms = (unsigned)std::atoi(value);
+        else if( arg == "--rate" )
+            _config.rate = std::atof(value);
+        else if( arg == "--duration" )
+            _config.duration = std::atof(value);
+        else if( arg == "--hedge" )
+            _config.hedge = std::atof(value);
+        else
+            return false;
+    }
+    return _argc % 2 == 1 && _config.backends > 1 && _config.rate > 0;
+}
+
+/// Echoes length-prefixed frames back, after a delay if it is set.
+class backend
+{
+public:
+    backend(network::event_loop& _loop, unsigned _delay_ms)
+        : loop_(_loop)
+        , delay_(_delay_ms)
+        , listener_(network::SocketType::Tcp)
+    {
+        using namespace network::ip::literals;
+        listener_.open("127.0.0.1:0"_ep4);
+        listener_.non_blocking(true);
+        loop_.add(listener_.socket(), network::event_loop::read, [this](unsigned) { on_accept(); });
+    }
+
+    unsigned short port() const noexcept
+    {
+        network::ip::endpoint_v4 ep;
+        socklen_t size = ep.size();
+        ::getsockname(listener_.socket(), ep, &size);
+        return ep.port();
+    }
+
+private:
+    void on_accept()
+    {
+        for( ;; ) {
+            const network::detail::socket_t s = ::accept(listener_.socket(), nullptr, nullptr);
+            if( s == network::detail::invalid_socket )
+                return;
+            network::base_socket c(s);
+            c.non_blocking(true);
+            c.set_option(network::option::no_delay(true));
+            rx_[s];
+            loop_.add(s, network::event_loop::read, [this, s](unsigned) { on_read(s); });
+            c.exchange();
+        }
+    }
+
+    void on_read(network::detail::socket_t _s)
+    {
+        std::vector<char>& rx = rx_[_s];
+        char buffer[64 * 1024];
+        for( ;; ) {
+            const long long size = ::recv(_s, buffer, sizeof(buffer), 0);
+            if( size == 0 ) {
+                loop_.remove(_s);
+                network::base_socket closed(_s);
+                rx_.erase(_s);
+                return;
+            }
+            if( size < 0 )
+                break;
+            rx.insert(rx.end(), buffer, buffer + size);
+        }
+        std::size_t begin = 0;
+        while( rx.size() - begin >= codec_t::header_len ) {
+            std::uint32_t len = 0;
+            for( std::size_t i = 0; i < 4; ++i )
+                len = (len << 8) | (unsigned char)rx[begin + i];
+            if( rx.size() - begin < codec_t::header_len + len )
+                break;
+            std::vector<char> frame(rx.begin() + begin, rx.begin() + begin + codec_t::header_len + len);
+            begin += frame.size();
+            if( !delay_ ) {
+                ::send(_s, frame.data(), frame.size(), MSG_NOSIGNAL);
+                continue;
+            }
+            loop_.add_timer(std::chrono::milliseconds(delay_), [this, _s, frame] {
+                if( rx_.count(_s) )
+                    ::send(_s, frame.data(), frame.size(), MSG_NOSIGNAL);
+            });
+        }
+        rx.erase(rx.begin(), rx.begin() + begin);
+    }
+
+    network::event_loop& loop_;
+    unsigned delay_;
+    network::socket_impl<network::ip::ipv4> listener_;
+    std::unordered_map<network::detail::socket_t, std::vector<char>> rx_;
+};
+
+/// Offers open-loop load through _issue, latency is measured from scheduled send time.
+void measure(network::event_loop& _loop, const config& _config, double _duration, const char* _name, const issue_t& _issue)
+{
+    network::latency_histogram histogram;
+    std::size_t scheduled = 0;
+    std::size_t completed = 0;
+    std::size_t failed = 0;
+    const codec_t::request_type request(32, 'x');
+    const auto start = clock_t::now();
+    const std::size_t total = (std::size_t)(_config.rate * _duration);
+
+    while( completed + failed < total ) {
+        const auto now = clock_t::now();
+        const std::size_t due = (std::size_t)(std::chrono::duration<double>(now - start).count() * _config.rate);
+        for( ; scheduled < due && scheduled < total; ++scheduled ) {
+            const auto at = start + std::chrono::nanoseconds((long long)(1e9 * (double)scheduled / _config.rate));
+            const bool sent = _issue(request, [&, at](codec_t::response_type&&, network::error _error) {
+                if( _error )
+                    ++failed;
+                else {
+                    histogram.record(clock_t::now() - at);
+                    ++completed;
+                }
+            });
+            if( !sent )
+                ++failed;
+        }
+        _loop.run_once(std::chrono::milliseconds(1));
+    }
+
+    if( !_name )
+        return;
+    auto us = [](network::latency_histogram::duration_t _value) {
+        return (double)_value.count() / 1e3;
+    };
+    std::printf("%-18s p50 %9.1f us  p90 %9.1f us  p99 %9.1f us  p99.9 %9.1f us  failed %zu\n", _name,
+                us(histogram.percentile(50)), us(histogram.percentile(90)), us(histogram.percentile(99)),
+                us(histogram.percentile(99.9)), failed);
+}
+
+} // namespace
+
+int main(int _argc, char** _argv)
+{
+    config cfg;
+    if( !parse_args(_argc, _argv, cfg) ) {
+        usage();
+        return 1;
+    }
+
+    using namespace network;
+    event_loop loop;
+    std::vector<std::unique_ptr<backend>> backends;
+    std::vector<ip::endpoint> eps;
+    for( std::size_t i = 0; i < cfg.backends; ++i ) {
+        backends.emplace_back(new backend(loop, i == 0 ? cfg.slow_ms : 0));
+        eps.push_back(ip::endpoint(ip::to_address("127.0.0.1"), backends.back()->port()));
+    }
+
+    {
+        std::vector<std::unique_ptr<pipeline_client<codec_t>>> clients;
+        for( const auto& ep : eps ) {
+            socket_impl<ip::ipv4> s(SocketType::Tcp);
+            if( !s.connect(ep) ) {
+                std::fprintf(stderr, "can't connect to backend\n");
+                return 1;
+            }
+            s.set_option(option::no_delay(true));
+            clients.emplace_back(new pipeline_client<codec_t>(loop, s.release(), SIZE_MAX));
+        }
+        std::size_t next = 0;
+        measure(loop, cfg, cfg.duration, "round robin", [&](const codec_t::request_type& _request, pipeline_client<codec_t>::handler_t _handler) {
+            return clients[next++ % clients.size()]->request(_request, std::move(_handler));
+        });
+    }
+
+    balancing_client<codec_t> balancer(loop, eps, SIZE_MAX);
+    if( cfg.hedge > 0 )
+        balancer.hedge(cfg.hedge);
+    while( balancer.available() < eps.size() )
+        loop.run_once(std::chrono::milliseconds(10));
+    auto issue = [&](const codec_t::request_type& _request, pipeline_client<codec_t>::handler_t _handler) {
+        return balancer.request(_request, std::move(_handler));
+    };
+    // Latencies of backends and hedge delay are learnt from first responses.
+    measure(loop, cfg, 0.5, nullptr, issue);
+    measure(loop, cfg, cfg.duration, cfg.hedge > 0 ? "p2c + hedging" : "p2c", issue);
+    for( std::size_t i = 0; i < balancer.backends(); ++i )
+        std::printf("  backend %zu: %llu requests, latency %.1f us\n", i, (unsigned long long)balancer.requests(i),
+                    (double)balancer.latency(i).count() / 1e3);
+    if( cfg.hedge > 0 )
+        std::printf("  hedged %llu after %.1f us\n", (unsigned long long)balancer.hedged(),
+                    (double)balancer.hedge_delay().count() / 1e3);
+    return 0;
+}
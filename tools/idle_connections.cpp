@@ -0,0 +1,155 @@
+/**
+ * Idle connection footprint of http::server
+ * Build: g++ -std=c++14 -O2 -I. tools/idle_connections.cpp -o idle_connections
+ * Usage: idle_connections [--connections N] [--port PORT] [--no-reclaim]
+ * Opens N loopback connections, sends one request on each, waits for all responses and
+ * then reports resident memory per idle connection: process RSS growth and the bytes
+ * server accounts for connections. Both ends live in this process, client side only
+ * keeps descriptors. Open files limit is raised to its hard limit, N is capped by it.
+ */
+#include "network/event_loop.hpp"
+#include "network/http/server.hpp"
+#include "network/ip/literals.hpp"
+#include "network/socket_impl.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+struct config
+{
+    std::size_t connections { 10000 };
+    unsigned short port { 18080 };
+    bool reclaim { true };
+};
+
+void usage()
+{
+    std::fprintf(stderr, "usage: idle_connections [--connections N] [--port PORT] [--no-reclaim]\n");
+}
+
+bool parse_args(int _argc, char** _argv, config& _config)
+{
+    for( int i = 1; i < _argc; ++i ) {
+        const std::string arg = _argv[i];
+        if( arg == "--no-reclaim" ) {
+            _config.reclaim = false;
+            continue;
+        }
+        if( i + 1 >= _argc )
+            return false;
+        const char* value = _argv[++i];
+        if( arg == "--connections" )
+            _config.connections = (std::size_t)std::strtoull(value, nullptr, 10);
+        else if( arg == "--port" )
+            _config.port = (unsigned short)std::atoi(value);
+        else
+            return false;
+    }
+    return _config.connections > 0;
+}
+
+/// Resident bytes of the process, freed heap is returned to the system first.
+std::size_t resident() noexcept
+{
+#if defined(__GLIBC__)
+    ::malloc_trim(0);
+#endif
+    long pages = 0;
+    long size = 0;
+    if( FILE* f = std::fopen("/proc/self/statm", "r") ) {
+        if( std::fscanf(f, "%ld %ld", &size, &pages) != 2 )
+            pages = 0;
+        std::fclose(f);
+    }
+    return (std::size_t)pages * (std::size_t)::sysconf(_SC_PAGESIZE);
+}
+
+/// Raises open files limit, returns connections count it allows.
+std::size_t raise_files_limit(std::size_t _connections) noexcept
+{
+    rlimit limit { };
+    if( ::getrlimit(RLIMIT_NOFILE, &limit) != 0 )
+        return _connections;
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    const std::size_t allowed = limit.rlim_cur > 64 ? (std::size_t)(limit.rlim_cur - 64) / 2 : 0;
+    return _connections < allowed ? _connections : allowed;
+}
+
+} // namespace
+
+int main(int _argc, char** _argv)
+{
+    config cfg;
+    if( !parse_args(_argc, _argv, cfg) ) {
+        usage();
+        return 1;
+    }
+    const std::size_t count = raise_files_limit(cfg.connections);
+    if( count < cfg.connections )
+        std::fprintf(stderr, "open files limit allows %zu connections only\n", count);
+
+    using namespace network;
+    using namespace network::ip::literals;
+    event_loop loop;
+    http::server server(loop, [](const http::request&, http::string_ref, http::response_writer& _response) {
+        _response.body_ref("ok");
+    });
+    server.reclaim_idle(cfg.reclaim);
+    socket_impl<ip::ipv4> listener(SocketType::Tcp);
+    ip::endpoint_v4 ep = "127.0.0.1:0"_ep4;
+    ep.port(cfg.port);
+    if( !listener.open(ep) || !server.listen(listener.release()) ) {
+        std::fprintf(stderr, "can't listen on port %u\n", (unsigned)cfg.port);
+        return 1;
+    }
+
+    const std::size_t before = resident();
+    std::vector<socket_impl<ip::ipv4>> clients;
+    clients.reserve(count);
+    const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    // Batches stay below listen backlog, the loop accepts between them.
+    const std::size_t batch = 512;
+    while( clients.size() < count ) {
+        const std::size_t end = clients.size() + batch < count ? clients.size() + batch : count;
+        while( clients.size() < end ) {
+            socket_impl<ip::ipv4> c(SocketType::Tcp);
+            if( !c.connect(ep) ) {
+                std::fprintf(stderr, "connect failed after %zu connections\n", clients.size());
+                return 1;
+            }
+            clients.push_back(std::move(c));
+        }
+        while( server.connections() < clients.size() )
+            loop.run_once(std::chrono::milliseconds(100));
+    }
+    for( auto& c : clients ) {
+        if( !c.write(request) ) {
+            std::fprintf(stderr, "request failed\n");
+            return 1;
+        }
+    }
+    while( server.requests() < clients.size() )
+        loop.run_once(std::chrono::milliseconds(100));
+    // Responses stay in client socket buffers (kernel memory), only server side is measured.
+    loop.run_once(std::chrono::milliseconds(0));
+
+    const std::size_t after = resident();
+    const double n = (double)clients.size();
+    std::printf("connections:            %zu (reclaim_idle %s)\n", clients.size(), cfg.reclaim ? "on" : "off");
+    std::printf("rss growth:             %zu KiB, %.0f bytes per connection\n",
+                (after - before) >> 10, (double)(after - before) / n);
+    std::printf("server accounted:       %zu KiB, %.0f bytes per connection\n",
+                server.memory() >> 10, (double)server.memory() / n);
+    std::printf("pool buffers lent:      %zu, cached %zu\n", server.buffers().lent(), server.buffers().cached());
+    return 0;
+}
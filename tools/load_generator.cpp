@@ -0,0 +1,429 @@
+/**
+ * Open-loop load generator
+ * Build: g++ -std=c++14 -O2 -I. tools/load_generator.cpp -o load_generator -pthread
+ * Usage: load_generator [--target ADDRESS:PORT | --echo PORT] [--connections N] [--rate REQUESTS_PER_SEC]
+ *                       [--duration SEC] [--size BYTES] [--udp] [--timeout MS]
+ * Requests are issued on a fixed schedule no matter how fast responses come back and
+ * latency is measured from the scheduled time, so server stalls show up in the tail
+ * instead of silently lowering offered load (coordinated omission).
+ * Target must echo requests: TCP byte streams or UDP datagrams. --echo starts a bundled
+ * echo server on loopback and targets it.
+ */
+#include "network/event_loop.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/send_queue.hpp"
+#include "network/socket_impl.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock clock_t;
+
+struct config
+{
+    network::ip::endpoint target;
+    unsigned short echo_port { };
+    std::size_t connections { 16 };
+    double rate { 10000 };
+    double duration { 10 };
+    std::size_t size { 64 };
+    std::chrono::milliseconds timeout { 1000 };
+    bool udp { false };
+};
+
+void usage()
+{
+    std::fprintf(stderr,
+                 "usage: load_generator [--target ADDRESS:PORT | --echo PORT] [--connections N]\n"
+                 "                      [--rate REQUESTS_PER_SEC] [--duration SEC] [--size BYTES]\n"
+                 "                      [--udp] [--timeout MS]\n");
+}
+
+bool parse_endpoint(const std::string& _s, network::ip::endpoint& _ep)
+{
+    const std::size_t colon = _s.rfind(':');
+    if( colon == std::string::npos )
+        return false;
+    std::string host = _s.substr(0, colon);
+    if( host.size() > 1 && host.front() == '[' && host.back() == ']' )
+        host = host.substr(1, host.size() - 2);
+    network::error error;
+    const network::ip::address address = network::ip::to_address(host, error);
+    if( error )
+        return false;
+    _ep = network::ip::endpoint(address, (unsigned short)std::atoi(_s.c_str() + colon + 1));
+    return true;
+}
+
+bool parse_args(int _argc, char** _argv, config& _config)
+{
+    bool has_target = false;
+    for( int i = 1; i < _argc; ++i ) {
+        const std::string arg = _argv[i];
+        if( arg == "--udp" ) {
+            _config.udp = true;
+            continue;
+        }
+        if( i + 1 >= _argc )
+            return false;
+        const char* value = _argv[++i];
+        if( arg == "--target" )
+            has_target = parse_endpoint(value, _config.target);
+        else if( arg == "--echo" ) {
+            _config.echo_port = (unsigned short)std::atoi(value);
+            _config.target = network::ip::endpoint(network::ip::address_v4::loopback(), _config.echo_port);
+            has_target = _config.echo_port != 0;
+        }
+        else if( arg == "--connections" )
+            _config.connections = (std::size_t)std::atol(value);
+        else if( arg == "--rate" )
+            _config.rate = std::atof(value);
+        else if( arg == "--duration" )
+            _config.duration = std::atof(value);
+        else if( arg == "--size" )
+            _config.size = (std::size_t)std::atol(value);
+        else if( arg == "--timeout" )
+            _config.timeout = std::chrono::milliseconds(std::atol(value));
+        else
+            return false;
+    }
+    return has_target && _config.connections && _config.rate > 0 && _config.duration > 0
+        && _config.size >= sizeof(std::uint64_t);
+}
+
+/// Echo server running its own loop on a separate thread.
+class echo_server
+{
+public:
+    explicit echo_server(unsigned short _port)
+        : tcp_(AF_INET, SOCK_STREAM)
+        , udp_(AF_INET, SOCK_DGRAM)
+    {
+        const network::ip::endpoint ep(network::ip::address_v4::loopback(), _port);
+        tcp_.set_option(network::option::reuse_address(true));
+        open_ = tcp_.bind(ep) && tcp_.listen() && tcp_.non_blocking(true)
+             && udp_.bind(ep) && udp_.non_blocking(true);
+        if( open_ )
+            thread_ = std::thread([this] { run(); });
+    }
+
+    ~echo_server()
+    {
+        stop_ = true;
+        if( thread_.joinable() )
+            thread_.join();
+    }
+
+    bool is_open() const noexcept
+    {
+        return open_;
+    }
+
+private:
+    void run()
+    {
+        network::event_loop loop;
+        std::unordered_map<network::detail::socket_t, std::unique_ptr<network::base_socket>> clients;
+        std::vector<char> buff(64 * 1024);
+
+        loop.add(tcp_.socket(), network::event_loop::read, [&](unsigned) {
+            network::detail::socket_t s;
+            while( network::detail::accept(tcp_.socket(), s) ) {
+                std::unique_ptr<network::base_socket> client(new network::base_socket(s));
+                client->set_option(network::option::no_delay(true));
+                loop.add(s, network::event_loop::read, [&, s](unsigned) {
+                    for( ;; ) {
+                        long long size = ::recv(s, buff.data(), buff.size(), 0);
+                        if( size > 0 ) {
+                            echo(s, buff.data(), (std::size_t)size);
+                            continue;
+                        }
+                        if( size == 0 || !network::detail::would_block(network::detail::last_error()) ) {
+                            loop.remove(s);
+                            clients.erase(s);
+                        }
+                        return;
+                    }
+                });
+                client->non_blocking(true);
+                clients.emplace(s, std::move(client));
+            }
+        });
+
+        loop.add(udp_.socket(), network::event_loop::read, [&](unsigned) {
+            network::ip::endpoint from;
+            socklen_t length = (socklen_t)from.capacity();
+            long long size;
+            while( (size = ::recvfrom(udp_.socket(), buff.data(), buff.size(), 0, from, &length)) >= 0 ) {
+                ::sendto(udp_.socket(), buff.data(), (std::size_t)size, 0, from, length);
+                length = (socklen_t)from.capacity();
+            }
+        });
+
+        while( !stop_ )
+            loop.run_once(std::chrono::milliseconds(50));
+        for( auto& client : clients )
+            loop.remove(client.first);
+        loop.remove(tcp_.socket());
+        loop.remove(udp_.socket());
+    }
+
+    /// Waiting for room keeps the server simple, loopback rarely fills socket buffers.
+    static void echo(network::detail::socket_t _s, const char* _data, std::size_t _length)
+    {
+        while( _length ) {
+            long long size = network::detail::send_some(_s, _data, _length);
+            if( size == -1 )
+                return;
+            if( size == 0 ) {
+                network::detail::pollfd_t pfd { _s, POLLOUT, 0 };
+                network::detail::poll(&pfd, 1, -1);
+                continue;
+            }
+            _data += size;
+            _length -= (std::size_t)size;
+        }
+    }
+
+    network::base_socket tcp_;
+    network::base_socket udp_;
+    std::thread thread_;
+    std::atomic<bool> stop_ { false };
+    bool open_ { false };
+};
+
+struct request_times
+{
+    clock_t::time_point intended;
+    clock_t::time_point sent;
+};
+
+struct connection
+{
+    network::base_socket s;
+    network::send_queue queue { SIZE_MAX, 0 };
+    /// TCP responses come back in order.
+    std::deque<request_times> fifo;
+    std::size_t received { };
+    /// UDP responses are matched by sequence number in the payload.
+    std::unordered_map<std::uint64_t, request_times> by_seq;
+    bool want_write { false };
+};
+
+struct report
+{
+    std::uint64_t issued { };
+    std::uint64_t completed { };
+    std::uint64_t errors { };
+    std::uint64_t lost { };
+    double elapsed { };
+    network::latency_histogram latency;
+    network::latency_histogram service;
+};
+
+/// Issues requests on schedule and records response latencies.
+class generator
+{
+public:
+    explicit generator(const config& _config)
+        : config_(_config)
+        , payload_(_config.size, 'x')
+    {
+    }
+
+    bool connect()
+    {
+        const int type = config_.udp ? SOCK_DGRAM : SOCK_STREAM;
+        for( std::size_t i = 0; i < config_.connections; ++i ) {
+            std::unique_ptr<connection> c(new connection());
+            c->s = network::base_socket(config_.target.is_v4() ? AF_INET : AF_INET6, type);
+            if( !config_.udp )
+                c->s.set_option(network::option::no_delay(true));
+            if( !c->s.connect(config_.target) || !c->s.non_blocking(true) ) {
+                std::perror("connect");
+                return false;
+            }
+            connection* p = c.get();
+            loop_.add(p->s.socket(), network::event_loop::read, [this, p](unsigned _events) { on_events(*p, _events); });
+            connections_.push_back(std::move(c));
+        }
+        return true;
+    }
+
+    report run()
+    {
+        const auto total = (std::uint64_t)std::llround(config_.rate * config_.duration);
+        const std::chrono::duration<double> interval(1.0 / config_.rate);
+        const auto start = clock_t::now();
+        const auto deadline = start + std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(config_.duration))
+                            + config_.timeout;
+
+        for( ;; ) {
+            const auto now = clock_t::now();
+            while( report_.issued < total ) {
+                const auto intended = start + std::chrono::duration_cast<clock_t::duration>(interval * (double)report_.issued);
+                if( intended > now )
+                    break;
+                issue(*connections_[report_.issued % connections_.size()], intended, now);
+                ++report_.issued;
+            }
+            if( (report_.issued == total && outstanding() == 0) || now >= deadline )
+                break;
+
+            long long wait = 1;
+            if( report_.issued < total ) {
+                const auto next = start + std::chrono::duration_cast<clock_t::duration>(interval * (double)report_.issued);
+                wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+            }
+            loop_.run_once(std::chrono::milliseconds(wait > 0 ? wait : 0));
+        }
+
+        report_.elapsed = std::chrono::duration<double>(clock_t::now() - start).count();
+        report_.lost = outstanding();
+        for( auto& c : connections_ )
+            loop_.remove(c->s.socket());
+        return report_;
+    }
+
+private:
+    void issue(connection& _c, clock_t::time_point _intended, clock_t::time_point _now)
+    {
+        const std::uint64_t seq = report_.issued;
+        memcpy(&payload_[0], &seq, sizeof(seq));
+        if( config_.udp ) {
+            if( ::send(_c.s.socket(), payload_.data(), payload_.size(), 0) == -1 ) {
+                ++report_.errors;
+                return;
+            }
+            _c.by_seq[seq] = { _intended, _now };
+            return;
+        }
+        _c.fifo.push_back({ _intended, _now });
+        _c.queue.push(payload_.data(), payload_.size());
+        flush(_c);
+    }
+
+    void flush(connection& _c)
+    {
+        if( !_c.queue.flush(_c.s) ) {
+            ++report_.errors;
+            _c.queue.clear();
+        }
+        const bool want_write = !_c.queue.empty();
+        if( want_write != _c.want_write ) {
+            _c.want_write = want_write;
+            loop_.modify(_c.s.socket(), network::event_loop::read | (want_write ? network::event_loop::write : 0));
+        }
+    }
+
+    void on_events(connection& _c, unsigned _events)
+    {
+        if( _events & network::event_loop::write )
+            flush(_c);
+        if( !(_events & (network::event_loop::read | network::event_loop::error)) )
+            return;
+        char buff[64 * 1024];
+        for( ;; ) {
+            long long size = ::recv(_c.s.socket(), buff, sizeof(buff), 0);
+            if( size <= 0 ) {
+                if( size == 0 || !network::detail::would_block(network::detail::last_error()) ) {
+                    ++report_.errors;
+                    loop_.remove(_c.s.socket());
+                }
+                return;
+            }
+            const auto now = clock_t::now();
+            if( config_.udp ) {
+                std::uint64_t seq;
+                memcpy(&seq, buff, sizeof(seq));
+                auto it = _c.by_seq.find(seq);
+                if( it != _c.by_seq.end() ) {
+                    complete(it->second, now);
+                    _c.by_seq.erase(it);
+                }
+                continue;
+            }
+            _c.received += (std::size_t)size;
+            while( _c.received >= config_.size && !_c.fifo.empty() ) {
+                _c.received -= config_.size;
+                complete(_c.fifo.front(), now);
+                _c.fifo.pop_front();
+            }
+        }
+    }
+
+    void complete(const request_times& _times, clock_t::time_point _now)
+    {
+        ++report_.completed;
+        report_.latency.record(_now - _times.intended);
+        report_.service.record(_now - _times.sent);
+    }
+
+    std::uint64_t outstanding() const
+    {
+        std::uint64_t count = 0;
+        for( const auto& c : connections_ )
+            count += c->fifo.size() + c->by_seq.size();
+        return count;
+    }
+
+    const config& config_;
+    network::event_loop loop_;
+    std::vector<std::unique_ptr<connection>> connections_;
+    std::vector<char> payload_;
+    report report_;
+};
+
+void print_histogram(const char* _name, const network::latency_histogram& _h)
+{
+    auto us = [](std::chrono::nanoseconds _d) { return (double)_d.count() / 1000.0; };
+    std::printf("%-8s p50 %10.1f  p90 %10.1f  p99 %10.1f  p99.9 %10.1f  max %10.1f  mean %10.1f (us)\n", _name,
+                us(_h.percentile(50)), us(_h.percentile(90)), us(_h.percentile(99)), us(_h.percentile(99.9)),
+                us(_h.max()), us(_h.mean()));
+}
+
+} // namespace
+
+int main(int _argc, char** _argv)
+{
+    config cfg;
+    if( !parse_args(_argc, _argv, cfg) ) {
+        usage();
+        return 2;
+    }
+
+    std::unique_ptr<echo_server> echo;
+    if( cfg.echo_port ) {
+        echo.reset(new echo_server(cfg.echo_port));
+        if( !echo->is_open() ) {
+            std::perror("echo server");
+            return 1;
+        }
+    }
+
+    generator gen(cfg);
+    if( !gen.connect() )
+        return 1;
+    const report r = gen.run();
+
+    std::printf("target %s %s, %zu connections, %.0f req/s offered, %zu byte payload\n",
+                cfg.target.to_string().c_str(), cfg.udp ? "udp" : "tcp", cfg.connections, cfg.rate, cfg.size);
+    std::printf("issued %llu  completed %llu  lost %llu  errors %llu  in %.2f s\n",
+                (unsigned long long)r.issued, (unsigned long long)r.completed, (unsigned long long)r.lost,
+                (unsigned long long)r.errors, r.elapsed);
+    std::printf("throughput %.0f req/s  %.2f MB/s\n", (double)r.completed / r.elapsed,
+                (double)r.completed * (double)cfg.size / r.elapsed / 1e6);
+    print_histogram("latency", r.latency);
+    print_histogram("service", r.service);
+    return r.lost || r.errors ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * Loopback checks of splice_proxy
+ * Build: g++ -std=c++14 -O2 -I. tools/proxy_check.cpp -o proxy_check
+ * Usage: proxy_check
+ * Relays between a client and an upstream connected over loopback, all in this process:
+ * data in both directions, half-close propagation, idle timeout and a client which keeps
+ * sending after upstream closed, which must close the proxy with an error instead of
+ * killing the process by SIGPIPE. Exits with 1 if any check fails.
+ */
+#include "network/event_loop.hpp"
+#include "network/ip/literals.hpp"
+#include "network/socket_impl.hpp"
+#include "network/splice_proxy.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef network::socket_impl<network::ip::ipv4> tcp_socket;
+
+/// Connected loopback pair: _near is the connecting end, _far the accepted one.
+bool connect_pair(tcp_socket& _near, tcp_socket& _far)
+{
+    using namespace network::ip::literals;
+    tcp_socket listener(network::SocketType::Tcp);
+    if( !listener.open("127.0.0.1:0"_ep4) )
+        return false;
+    network::ip::endpoint_v4 ep;
+    socklen_t size = ep.size();
+    ::getsockname(listener.socket(), ep, &size);
+    _near = tcp_socket(network::SocketType::Tcp);
+    return _near.connect(ep) && listener.accept(_far) && _near.non_blocking(true);
+}
+
+/// Runs loop until _done or about _ms milliseconds passed.
+template<class _Done>
+bool run(network::event_loop& _loop, unsigned _ms, const _Done& _done)
+{
+    for( unsigned i = 0; i < _ms && !_done(); ++i )
+        _loop.run_once(std::chrono::milliseconds(1));
+    return _done();
+}
+
+std::string receive(const tcp_socket& _s)
+{
+    std::string data;
+    char buff[4096];
+    long long size;
+    while( (size = ::recv(_s.socket(), buff, sizeof(buff), 0)) > 0 )
+        data.append(buff, (std::size_t)size);
+    return data;
+}
+
+struct fixture
+{
+    network::event_loop loop;
+    tcp_socket client;
+    tcp_socket upstream;
+    std::unique_ptr<network::splice_proxy> proxy;
+    bool closed { false };
+
+    bool start(std::chrono::milliseconds _idle_timeout = std::chrono::milliseconds(0))
+    {
+        tcp_socket a, b;
+        if( !connect_pair(client, a) || !connect_pair(b, upstream) || !upstream.non_blocking(true) )
+            return false;
+        proxy.reset(new network::splice_proxy(loop, a.release(), b.release(), _idle_timeout));
+        proxy->on_close([this] { closed = true; });
+        return proxy->start();
+    }
+};
+
+bool relay()
+{
+    fixture f;
+    if( !f.start() )
+        return false;
+    std::string up, down;
+    ::send(f.client.socket(), "ping", 4, 0);
+    run(f.loop, 1000, [&] { return (up += receive(f.upstream)) == "ping"; });
+    ::send(f.upstream.socket(), "pong!", 5, 0);
+    run(f.loop, 1000, [&] { return (down += receive(f.client)) == "pong!"; });
+    return up == "ping" && down == "pong!" && f.proxy->a_to_b() == 4 && f.proxy->b_to_a() == 5;
+}
+
+bool half_close()
+{
+    fixture f;
+    if( !f.start() )
+        return false;
+    std::string up, down;
+    ::send(f.client.socket(), "last", 4, 0);
+    ::shutdown(f.client.socket(), SHUT_WR);
+    // Upstream gets data and then EOF, it still may answer.
+    bool eof = false;
+    run(f.loop, 1000, [&] {
+        char buff[16];
+        const long long size = ::recv(f.upstream.socket(), buff, sizeof(buff), 0);
+        if( size > 0 )
+            up.append(buff, (std::size_t)size);
+        eof = size == 0;
+        return eof;
+    });
+    ::send(f.upstream.socket(), "reply", 5, 0);
+    ::shutdown(f.upstream.socket(), SHUT_WR);
+    run(f.loop, 1000, [&] { return f.closed; });
+    down = receive(f.client);
+    return eof && up == "last" && down == "reply" && f.closed && f.proxy->error() == 0;
+}
+
+bool idle_timeout()
+{
+    fixture f;
+    if( !f.start(std::chrono::milliseconds(20)) )
+        return false;
+    return run(f.loop, 1000, [&] { return f.closed; }) && f.proxy->timed_out();
+}
+
+bool upstream_gone()
+{
+    // Default disposition: SIGPIPE raised by the proxy would terminate this process.
+    std::signal(SIGPIPE, SIG_DFL);
+    fixture f;
+    if( !f.start() )
+        return false;
+    f.upstream = tcp_socket();
+    const std::vector<char> chunk(16 << 10, 'x');
+    run(f.loop, 2000, [&] {
+        ::send(f.client.socket(), chunk.data(), chunk.size(), MSG_NOSIGNAL);
+        return f.closed;
+    });
+    return f.closed && (f.proxy->error() == EPIPE || f.proxy->error() == ECONNRESET);
+}
+
+} // namespace
+
+int main()
+{
+    struct check
+    {
+        const char* name;
+        bool (*run)();
+    };
+    const check checks[] {
+        { "relay", relay },
+        { "half-close", half_close },
+        { "idle timeout", idle_timeout },
+        { "upstream gone", upstream_gone }
+    };
+    int failed = 0;
+    for( const check& c : checks ) {
+        const bool ok = c.run();
+        std::printf("%-14s %s\n", c.name, ok ? "ok" : "FAILED");
+        failed += ok ? 0 : 1;
+    }
+    return failed ? 1 : 0;
+}